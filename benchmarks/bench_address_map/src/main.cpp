@@ -0,0 +1,178 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcAddressHash.h"
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <unordered_map>
+#include <vector>
+
+// The previous address hash, which only used the first four bytes of the address
+struct LegacyHasher
+{
+    uint32_t operator()(const UdcAddressMux& x) const
+    {
+        uint32_t h;
+        memcpy(&h, x.address.ipv4.octets, sizeof(h));
+        return h;
+    }
+};
+
+struct LegacyCompareEquals
+{
+    bool operator()(const UdcAddressMux& a, const UdcAddressMux& b) const
+    {
+        if (a.family != b.family || a.port != b.port)
+        {
+            return false;
+        }
+
+        return (a.family == UDC_IPV6)
+            ? memcmp(a.address.ipv6.segments, b.address.ipv6.segments, sizeof(a.address.ipv6.segments)) == 0
+            : memcmp(a.address.ipv4.octets, b.address.ipv4.octets, sizeof(a.address.ipv4.octets)) == 0;
+    }
+};
+
+using LegacyMap = std::unordered_map<UdcAddressMux, uint32_t, LegacyHasher, LegacyCompareEquals>;
+
+// Many clients behind one NAT address
+std::vector<UdcAddressMux> manyPortsOneIPv4(uint32_t count)
+{
+    std::vector<UdcAddressMux> result(count);
+
+    for (uint32_t i = 0; i != count; ++i)
+    {
+        result[i] = {};
+        result[i].family = UDC_IPV4;
+        result[i].address.ipv4 = {{203, 0, 113, 7}};
+        result[i].port = static_cast<uint16_t>(1024 + i);
+    }
+
+    return result;
+}
+
+// Many clients in one IPv6 /32 prefix
+std::vector<UdcAddressMux> manyIPv6OnePrefix(uint32_t count)
+{
+    std::vector<UdcAddressMux> result(count);
+
+    for (uint32_t i = 0; i != count; ++i)
+    {
+        result[i] = {};
+        result[i].family = UDC_IPV6;
+        result[i].address.ipv6 = {{0x2001, 0x0DB8, 0, 0, 0, 0, static_cast<uint16_t>(i >> 16), static_cast<uint16_t>(i)}};
+        result[i].port = 27015;
+    }
+
+    return result;
+}
+
+template<class F>
+double nanosecondsPerOp(uint32_t ops, F&& f)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    auto t1 = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / ops;
+}
+
+bool run(const char* name, const std::vector<UdcAddressMux>& addresses, uint32_t rounds)
+{
+    auto count = static_cast<uint32_t>(addresses.size());
+
+    UdcAddressMap<uint32_t> map;
+    LegacyMap legacy;
+
+    double insertNs = nanosecondsPerOp(count, [&]()
+    {
+        for (uint32_t i = 0; i != count; ++i)
+        {
+            map.insert(addresses[i], i);
+        }
+    });
+
+    double legacyInsertNs = nanosecondsPerOp(count, [&]()
+    {
+        for (uint32_t i = 0; i != count; ++i)
+        {
+            legacy[addresses[i]] = i;
+        }
+    });
+
+    uint64_t sum = 0;
+    uint64_t legacySum = 0;
+
+    double findNs = nanosecondsPerOp(count * rounds, [&]()
+    {
+        for (uint32_t r = 0; r != rounds; ++r)
+        {
+            for (uint32_t i = 0; i != count; ++i)
+            {
+                sum += *map.find(addresses[i]);
+            }
+        }
+    });
+
+    double legacyFindNs = nanosecondsPerOp(count * rounds, [&]()
+    {
+        for (uint32_t r = 0; r != rounds; ++r)
+        {
+            for (uint32_t i = 0; i != count; ++i)
+            {
+                legacySum += legacy.find(addresses[i])->second;
+            }
+        }
+    });
+
+    // Erase every other address and check the rest are still found
+    for (uint32_t i = 0; i < count; i += 2)
+    {
+        map.erase(addresses[i]);
+    }
+
+    for (uint32_t i = 0; i != count; ++i)
+    {
+        const uint32_t* value = map.find(addresses[i]);
+
+        if ((i % 2 == 0) != (value == nullptr) || (value != nullptr && *value != i))
+        {
+            std::cout << name << ": lookup after erase failed\n";
+            return false;
+        }
+    }
+
+    if (sum != legacySum)
+    {
+        std::cout << name << ": lookups disagree\n";
+        return false;
+    }
+
+    std::cout
+        << std::left << std::setw(28) << name
+        << std::right << std::fixed << std::setprecision(1)
+        << " insert " << std::setw(10) << insertNs << " ns (legacy " << std::setw(10) << legacyInsertNs << " ns)"
+        << " find " << std::setw(8) << findNs << " ns (legacy " << std::setw(10) << legacyFindNs << " ns)\n";
+
+    return true;
+}
+
+int main()
+{
+    constexpr uint32_t count = 20000;
+    constexpr uint32_t rounds = 10;
+
+    if (!run("many ports, one IPv4", manyPortsOneIPv4(count), rounds))
+    {
+        return -1;
+    }
+
+    if (!run("many IPv6, one /32 prefix", manyIPv6OnePrefix(count), rounds))
+    {
+        return -1;
+    }
+
+    return 0;
+}
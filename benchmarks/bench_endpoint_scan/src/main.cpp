@@ -0,0 +1,215 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcEndPointTable.h"
+#include "UdcClient.h"
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <optional>
+#include <random>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// The table, with a scan of its deadline column
+// the server finds lost connections with its timer wheel, this measures what the column layout
+// costs a full scan compared to the previous layout
+class ScanTable : public UdcEndPointTable
+{
+public:
+
+    // Append the slot index of every connected endpoint whose connection-lost
+    // deadline is at or before time
+    // the deadline column is scanned four endpoints at a time with SSE2 when it is available
+    void findLostConnections(std::chrono::microseconds time, std::vector<uint32_t>& indices) const;
+};
+
+
+// The previous endpoint layout, one object per slot with hot and cold fields interleaved
+struct LegacyClient
+{
+    UdcEndPointId id;
+    int reliableState;
+    UdcRingQueue<UdcPooledMessage*> reliableMessages;
+    bool isConnected;
+    bool isPending;
+    UdcAddressMux outgoingAddress;
+    UdcAddressMux incomingAddress;
+    std::chrono::microseconds pingPeriod;
+    std::chrono::microseconds connectionTimeoutPeriod;
+    std::chrono::microseconds connectionLostPeriod;
+    std::chrono::microseconds connectionAttemptPeriod;
+    std::chrono::microseconds reliableTimeoutPeriod;
+    std::chrono::microseconds ping;
+    std::chrono::microseconds pingLastSetTime;
+    std::chrono::microseconds lastReceivedTime;
+    std::chrono::microseconds reliableSentTime;
+    std::chrono::microseconds firstConnectAttemptTime;
+    std::chrono::microseconds prevConnectAttemptTime;
+};
+
+struct LegacySlot
+{
+    uint32_t generation;
+    uint32_t nextFree;
+    std::optional<LegacyClient> value;
+};
+
+template<class F>
+double nanosecondsPerOp(uint32_t ops, F&& f)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    auto t1 = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / ops;
+}
+
+void ScanTable::findLostConnections(std::chrono::microseconds time, std::vector<uint32_t>& indices) const
+{
+    // Deadlines of free, pending and disconnected slots are NEVER,
+    // so only the deadline column needs to be read
+    auto count = static_cast<uint32_t>(m_connectionLostTime.size());
+    const auto* deadlines = reinterpret_cast<const int64_t*>(m_connectionLostTime.data());
+    int64_t t = time.count();
+
+    uint32_t i = 0;
+
+#if defined(__SSE2__)
+    // deadline <= time when (deadline - time - 1) is negative
+    // NEVER - time - 1 can't overflow, since time is never negative
+    __m128i next = _mm_set1_epi64x(t + 1);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i d0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(deadlines + i));
+        __m128i d1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(deadlines + i + 2));
+
+        int mask =
+            _mm_movemask_pd(_mm_castsi128_pd(_mm_sub_epi64(d0, next))) |
+            (_mm_movemask_pd(_mm_castsi128_pd(_mm_sub_epi64(d1, next))) << 2);
+
+        for (; mask != 0; mask &= mask - 1)
+        {
+            indices.push_back(i + static_cast<uint32_t>(__builtin_ctz(mask)));
+        }
+    }
+#endif
+
+    for (; i != count; ++i)
+    {
+        if (deadlines[i] <= t)
+        {
+            indices.push_back(i);
+        }
+    }
+}
+
+int main()
+{
+    constexpr uint32_t count = 200000;
+    constexpr uint32_t rounds = 50;
+
+    constexpr std::chrono::microseconds timeout = std::chrono::seconds(10);
+    constexpr std::chrono::microseconds ping = std::chrono::seconds(1);
+
+    ScanTable table;
+    std::vector<LegacySlot> legacy(count);
+
+    // Endpoints last heard from at random times over the last timeout period,
+    // every tenth one is still pending
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int64_t> lastReceived(0, timeout.count());
+
+    for (uint32_t i = 0; i != count; ++i)
+    {
+        UdcAddressMux address = {};
+        address.family = UDC_IPV4;
+        address.address.ipv4 = {{198, 51, static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i)}};
+        address.port = 27015;
+
+        UdcEndPointId id;
+        UdcClient client;
+
+        if (!table.emplace(address, ping, timeout, id) || !table.find(id, client))
+        {
+            std::cout << "emplace failed\n";
+            return -1;
+        }
+
+        auto time = std::chrono::microseconds(lastReceived(rng));
+        bool pending = (i % 10 == 0);
+
+        if (!pending)
+        {
+            client.receiveConnectionHandshake(time);
+        }
+
+        legacy[i] = {1, 0, LegacyClient{}};
+        auto& c = *legacy[i].value;
+        c.id = id;
+        c.isConnected = !pending;
+        c.isPending = pending;
+        c.outgoingAddress = address;
+        c.connectionLostPeriod = timeout;
+        c.lastReceivedTime = time;
+    }
+
+    std::vector<uint32_t> expired;
+    std::vector<uint32_t> legacyExpired;
+    expired.reserve(count);
+    legacyExpired.reserve(count);
+
+    // Roughly 1% of endpoints are past their deadline
+    auto now = timeout + std::chrono::microseconds(timeout.count() / 100);
+
+    double scanNs = nanosecondsPerOp(count * rounds, [&]()
+    {
+        for (uint32_t r = 0; r != rounds; ++r)
+        {
+            expired.clear();
+            table.findLostConnections(now, expired);
+        }
+    });
+
+    double legacyScanNs = nanosecondsPerOp(count * rounds, [&]()
+    {
+        for (uint32_t r = 0; r != rounds; ++r)
+        {
+            legacyExpired.clear();
+
+            for (uint32_t i = 0; i != count; ++i)
+            {
+                const auto& slot = legacy[i];
+
+                if (slot.value && slot.value->isConnected && (now - slot.value->lastReceivedTime) >= slot.value->connectionLostPeriod)
+                {
+                    legacyExpired.push_back(i);
+                }
+            }
+        }
+    });
+
+    if (expired != legacyExpired)
+    {
+        std::cout << "scans disagree\n";
+        return -1;
+    }
+
+    std::cout
+        << "endpoints " << count << ", expired " << expired.size() << "\n"
+        << "bytes per endpoint: hot " << UdcEndPointTable::hotBytesPerEndPoint()
+        << ", cold " << UdcEndPointTable::coldBytesPerEndPoint()
+        << ", table " << table.memoryUsage() / count
+        << " (legacy " << sizeof(LegacySlot) << ")\n"
+        << "stride between deadlines: " << sizeof(std::chrono::microseconds)
+        << " (legacy " << sizeof(LegacySlot) << ")\n"
+        << std::fixed << std::setprecision(2)
+        << "scan " << scanNs << " ns per endpoint (legacy " << legacyScanNs << " ns)\n";
+
+    return 0;
+}
@@ -0,0 +1,145 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcSendQueue.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// The usual workaround, every send is copied into a vector behind a mutex
+struct LockedQueue
+{
+    struct Message
+    {
+        UdcEndPointId endPointId;
+        std::vector<uint8_t> data;
+    };
+
+    std::mutex mutex;
+    std::vector<Message> messages;
+    std::vector<Message> draining;
+
+    bool push(UdcEndPointId endPointId, const UdcSegment* segments, uint32_t, UdcMessageType)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        messages.push_back({endPointId, std::vector<uint8_t>(segments[0].data, segments[0].data + segments[0].size)});
+        return true;
+    }
+
+    uint32_t drain()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            draining.swap(messages);
+        }
+
+        auto count = static_cast<uint32_t>(draining.size());
+        draining.clear();
+        return count;
+    }
+};
+
+uint32_t drain(UdcSendQueue& queue)
+{
+    uint32_t count = 0;
+    UdcSendQueue::Submission submission;
+
+    while (queue.front(submission))
+    {
+        queue.pop();
+        ++count;
+    }
+
+    return count;
+}
+
+uint32_t drain(LockedQueue& queue)
+{
+    return queue.drain();
+}
+
+// Every producer pushes messagesPerThread messages while this thread drains
+template<class Queue>
+double nanosecondsPerMessage(Queue& queue, uint32_t threadCount, uint32_t messagesPerThread)
+{
+    std::atomic<bool> start(false);
+    std::vector<std::thread> threads;
+
+    for (uint32_t t = 0; t != threadCount; ++t)
+    {
+        threads.emplace_back([&]()
+        {
+            uint8_t msg[64] = {};
+            UdcSegment segment = {msg, sizeof(msg)};
+
+            while (!start.load())
+            {
+                std::this_thread::yield();
+            }
+
+            for (uint32_t i = 0; i != messagesPerThread; ++i)
+            {
+                while (!queue.push(1, &segment, 1, UDC_UNRELIABLE_MESSAGE))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    start.store(true);
+
+    uint64_t total = static_cast<uint64_t>(threadCount) * messagesPerThread;
+
+    for (uint64_t received = 0; received != total;)
+    {
+        uint32_t count = drain(queue);
+
+        // Let the producers run if they're on the same core
+        if (count == 0)
+        {
+            std::this_thread::yield();
+        }
+
+        received += count;
+    }
+
+    auto t1 = std::chrono::steady_clock::now();
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / total;
+}
+
+int main()
+{
+    constexpr uint32_t messagesPerThread = 500000;
+
+    std::cout << std::fixed << std::setprecision(2);
+
+    for (uint32_t threadCount = 1; threadCount <= 8; threadCount *= 2)
+    {
+        UdcSendQueue queue(4096, 1024);
+        LockedQueue locked;
+
+        double queueNs = nanosecondsPerMessage(queue, threadCount, messagesPerThread);
+        double lockedNs = nanosecondsPerMessage(locked, threadCount, messagesPerThread);
+
+        std::cout
+            << "producers " << threadCount
+            << ": send queue " << queueNs << " ns per message"
+            << " (mutex " << lockedNs << " ns)\n";
+    }
+
+    return 0;
+}
@@ -6,86 +6,332 @@
 
 #include "UdcAddressMux.h"
 
-#include <unordered_map>
+#include <cstdint>
 #include <cstring>
+#include <vector>
+#include <random>
+#include <type_traits>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// UdcAddressMap
+// Flat open-addressing hash map keyed by address family, address and port
+// control bytes are probed 16 at a time (Swiss-table style), with an SSE2
+// path when it is available
 template<class T>
 class UdcAddressMap
 {
-protected:
-    struct Hasher;
-    struct CompareEquals;
-    using Map = std::unordered_map<UdcAddressMux, T, Hasher, CompareEquals>;
 public:
 
+    UdcAddressMap()
+        : m_groupMask(0)
+        , m_size(0)
+        , m_tombstones(0)
+        , m_seed(std::random_device()())
+    {}
+
+    // Insert a value, or replace the value already stored for address
     template<class U>
     void insert(const UdcAddressMux& address, U&& val)
     {
         static_assert(std::is_same<std::decay_t<U>, std::decay_t<T>>::value, "U must be the same as T");
-        m_map[address] = std::forward<U>(val);
+
+        uint64_t hash = hashAddress(address);
+
+        uint32_t index;
+        if (findIndex(address, hash, index))
+        {
+            m_values[index] = std::forward<U>(val);
+            return;
+        }
+
+        if ((m_size + m_tombstones + 1) * 8 > capacity() * 7)
+        {
+            rehash(capacity() == 0 ? GROUP_SIZE : ((m_size + 1) * 8 > capacity() * 4 ? capacity() * 2 : capacity()));
+        }
+
+        index = findInsertIndex(hash);
+
+        if (m_ctrl[index] == CTRL_DELETED)
+        {
+            --m_tombstones;
+        }
+
+        m_ctrl[index] = h2(hash);
+        m_keys[index] = address;
+        m_values[index] = std::forward<U>(val);
+        ++m_size;
+    }
+
+    // Remove the value stored for address
+    // returns false if there was no value
+    bool erase(const UdcAddressMux& address)
+    {
+        uint32_t index;
+        if (!findIndex(address, hashAddress(address), index))
+        {
+            return false;
+        }
+
+        // If the group still has an empty slot, then no probe sequence
+        // continues past this group and the slot can be marked empty
+        if (matchEmpty(&m_ctrl[index & ~(GROUP_SIZE - 1)]) != 0)
+        {
+            m_ctrl[index] = CTRL_EMPTY;
+        }
+        else
+        {
+            m_ctrl[index] = CTRL_DELETED;
+            ++m_tombstones;
+        }
+
+        m_values[index] = T();
+        --m_size;
+
+        return true;
     }
 
-    void erase(const UdcAddressMux& address)
+    // Get the value stored for address, or nullptr if there is none
+    [[nodiscard]]
+    T* find(const UdcAddressMux& address)
     {
-        m_map.erase(address);
+        uint32_t index;
+        return findIndex(address, hashAddress(address), index)
+            ? &m_values[index]
+            : nullptr;
     }
 
-    typename Map::iterator find(const UdcAddressMux& address)
+    // Get the value stored for address, or nullptr if there is none
+    [[nodiscard]]
+    const T* find(const UdcAddressMux& address) const
     {
-        return m_map.find(address);
+        uint32_t index;
+        return findIndex(address, hashAddress(address), index)
+            ? &m_values[index]
+            : nullptr;
     }
 
-    typename Map::const_iterator find(const UdcAddressMux& address) const
+    // Number of values in the map
+    [[nodiscard]]
+    uint32_t size() const
     {
-        return m_map.find(address);
+        return m_size;
     }
 
-    typename Map::iterator end()
+protected:
+
+    static constexpr uint32_t GROUP_SIZE = 16;
+
+    // Control byte values
+    // full slots store the low 7 bits of the hash (0x00 - 0x7F)
+    static constexpr uint8_t CTRL_EMPTY = 0x80;
+    static constexpr uint8_t CTRL_DELETED = 0xFE;
+
+    std::vector<uint8_t> m_ctrl;
+    std::vector<UdcAddressMux> m_keys;
+    std::vector<T> m_values;
+
+    uint32_t m_groupMask;
+    uint32_t m_size;
+    uint32_t m_tombstones;
+    uint64_t m_seed;
+
+    [[nodiscard]]
+    uint32_t capacity() const
     {
-        return m_map.end();
+        return static_cast<uint32_t>(m_ctrl.size());
     }
 
-    typename Map::const_iterator cend() const
+    [[nodiscard]]
+    static uint8_t h2(uint64_t hash)
     {
-        return m_map.cend();
+        return static_cast<uint8_t>(hash & 0x7F);
     }
 
-protected:
+    [[nodiscard]]
+    static uint64_t mix(uint64_t x)
+    {
+        x ^= x >> 32;
+        x *= 0xD6E8FEB86659FD93ull;
+        x ^= x >> 32;
+        x *= 0xD6E8FEB86659FD93ull;
+        x ^= x >> 32;
+        return x;
+    }
 
-    struct Hasher
+    // Hash every byte that identifies an address (family, port and the
+    // full IPv4 or IPv6 address), ignoring the unused bytes of the union
+    [[nodiscard]]
+    uint64_t hashAddress(const UdcAddressMux& address) const
     {
-        uint32_t operator()(const UdcAddressMux& x) const
+        uint64_t h = m_seed ^ (static_cast<uint64_t>(address.family) << 16) ^ address.port;
+
+        if (address.family == UDC_IPV6)
         {
-            return *reinterpret_cast<const uint32_t*>(&x.address.ipv4.octets);
+            uint64_t a[2];
+            memcpy(a, address.address.ipv6.segments, sizeof(a));
+
+            h = mix(h ^ a[0]);
+            return mix(h ^ a[1]);
         }
-    };
 
-    struct CompareEquals
+        uint32_t a;
+        memcpy(&a, address.address.ipv4.octets, sizeof(a));
+
+        return mix(h ^ (static_cast<uint64_t>(a) << 24));
+    }
+
+    [[nodiscard]]
+    static bool equals(const UdcAddressMux& a, const UdcAddressMux& b)
     {
-        bool operator()(const UdcAddressMux& a, const UdcAddressMux& b) const
+        if (a.family != b.family)
+            return false;
+
+        if (a.port != b.port)
+            return false;
+
+        if (a.family == UDC_IPV6)
         {
-            if (a.family != b.family)
-                return false;
+            return memcmp(
+                a.address.ipv6.segments,
+                b.address.ipv6.segments,
+                sizeof(a.address.ipv6.segments)) == 0;
+        }
 
-            if (a.port != b.port)
+        return memcmp(
+            a.address.ipv4.octets,
+            b.address.ipv4.octets,
+            sizeof(a.address.ipv4.octets)) == 0;
+    }
+
+    // Bit i is set when ctrl[i] == value
+    [[nodiscard]]
+    static uint32_t matchByte(const uint8_t* ctrl, uint8_t value)
+    {
+#if defined(__SSE2__)
+        __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(static_cast<char>(value)))));
+#else
+        uint32_t mask = 0;
+        for (uint32_t i = 0; i != GROUP_SIZE; ++i)
+        {
+            mask |= static_cast<uint32_t>(ctrl[i] == value) << i;
+        }
+        return mask;
+#endif
+    }
+
+    [[nodiscard]]
+    static uint32_t matchEmpty(const uint8_t* ctrl)
+    {
+        return matchByte(ctrl, CTRL_EMPTY);
+    }
+
+    // Bit i is set when ctrl[i] is empty or deleted
+    [[nodiscard]]
+    static uint32_t matchFree(const uint8_t* ctrl)
+    {
+#if defined(__SSE2__)
+        // Only free slots have the high bit set
+        __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+        return static_cast<uint32_t>(_mm_movemask_epi8(group));
+#else
+        uint32_t mask = 0;
+        for (uint32_t i = 0; i != GROUP_SIZE; ++i)
+        {
+            mask |= static_cast<uint32_t>(ctrl[i] >> 7) << i;
+        }
+        return mask;
+#endif
+    }
+
+    [[nodiscard]]
+    static uint32_t lowestBit(uint32_t mask)
+    {
+        return static_cast<uint32_t>(__builtin_ctz(mask));
+    }
+
+    [[nodiscard]]
+    bool findIndex(const UdcAddressMux& address, uint64_t hash, uint32_t& index) const
+    {
+        if (m_size == 0)
+        {
+            return false;
+        }
+
+        uint8_t tag = h2(hash);
+        uint32_t group = static_cast<uint32_t>(hash >> 7) & m_groupMask;
+
+        // Triangular probing over groups visits every group once
+        for (uint32_t step = 1;; ++step)
+        {
+            const uint8_t* ctrl = &m_ctrl[group * GROUP_SIZE];
+
+            for (uint32_t mask = matchByte(ctrl, tag); mask != 0; mask &= mask - 1)
+            {
+                uint32_t i = group * GROUP_SIZE + lowestBit(mask);
+
+                if (equals(m_keys[i], address))
+                {
+                    index = i;
+                    return true;
+                }
+            }
+
+            if (matchEmpty(ctrl) != 0 || step > m_groupMask)
+            {
                 return false;
+            }
+
+            group = (group + step) & m_groupMask;
+        }
+    }
+
+    [[nodiscard]]
+    uint32_t findInsertIndex(uint64_t hash) const
+    {
+        uint32_t group = static_cast<uint32_t>(hash >> 7) & m_groupMask;
+
+        for (uint32_t step = 1;; ++step)
+        {
+            uint32_t mask = matchFree(&m_ctrl[group * GROUP_SIZE]);
 
-            if (a.family == UDC_IPV6)
+            if (mask != 0)
             {
-                return memcmp(
-                    a.address.ipv6.segments,
-                    b.address.ipv6.segments,
-                    sizeof(a.address.ipv6.segments)) == 0;
+                return group * GROUP_SIZE + lowestBit(mask);
             }
 
-            return memcmp(
-                a.address.ipv4.octets,
-                b.address.ipv4.octets,
-                sizeof(a.address.ipv4.octets)) == 0;
+            group = (group + step) & m_groupMask;
         }
-    };
+    }
+
+    void rehash(uint32_t newCapacity)
+    {
+        std::vector<uint8_t> ctrl(newCapacity, CTRL_EMPTY);
+        std::vector<UdcAddressMux> keys(newCapacity);
+        std::vector<T> values(newCapacity);
+
+        ctrl.swap(m_ctrl);
+        keys.swap(m_keys);
+        values.swap(m_values);
+
+        m_groupMask = newCapacity / GROUP_SIZE - 1;
+        m_tombstones = 0;
 
-    Map m_map;
+        for (uint32_t i = 0; i != ctrl.size(); ++i)
+        {
+            if ((ctrl[i] & 0x80) == 0)
+            {
+                uint32_t index = findInsertIndex(hashAddress(keys[i]));
+
+                m_ctrl[index] = ctrl[i];
+                m_keys[index] = keys[i];
+                m_values[index] = std::move(values[i]);
+            }
+        }
+    }
 };
 
 #endif
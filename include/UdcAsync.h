@@ -0,0 +1,640 @@
+// udp-connect
+// Kyle J Burgess
+
+#ifndef UDC_ASYNC_H
+#define UDC_ASYNC_H
+
+#include "udp_connect.h"
+
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <unordered_map>
+#include <vector>
+
+// Coroutine layer over the C API, requires C++20
+//
+// a UdcAsyncServer runs coroutines that await connections, messages and acknowledgements
+// on the thread that calls poll() or run(); waiting coroutines are kept in intrusive lists inside
+// their own awaiters, one list per endpoint and kind of wait, so an event only looks at its own endpoint
+// after a coroutine's frame and its endpoint's entry have been allocated nothing else is allocated
+
+class UdcAsyncServer;
+class UdcAsyncEndPoint;
+
+// UdcTask
+// A coroutine that starts running straight away and destroys itself when it returns
+struct UdcTask
+{
+    struct promise_type
+    {
+        UdcTask get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+// UdcAsyncMessage
+// A received message, its payload stays in the server's buffer until the message is destroyed
+// the server must use UDC_RING_MANUAL_RELEASE so that payloads stay valid while they wait
+class UdcAsyncMessage
+{
+public:
+
+    UdcAsyncMessage()
+        : m_server(nullptr)
+        , m_data(nullptr)
+        , m_index(0)
+        , m_size(0)
+    {}
+
+    UdcAsyncMessage(UdcAsyncMessage&& other) noexcept
+        : m_server(other.m_server)
+        , m_data(other.m_data)
+        , m_index(other.m_index)
+        , m_size(other.m_size)
+    {
+        other.m_server = nullptr;
+        other.m_data = nullptr;
+    }
+
+    UdcAsyncMessage& operator=(UdcAsyncMessage&& other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            m_server = other.m_server;
+            m_data = other.m_data;
+            m_index = other.m_index;
+            m_size = other.m_size;
+            other.m_server = nullptr;
+            other.m_data = nullptr;
+        }
+
+        return *this;
+    }
+
+    UdcAsyncMessage(const UdcAsyncMessage&) = delete;
+
+    UdcAsyncMessage& operator=(const UdcAsyncMessage&) = delete;
+
+    ~UdcAsyncMessage()
+    {
+        release();
+    }
+
+    // False if the wait was cancelled
+    explicit operator bool() const
+    {
+        return m_data != nullptr;
+    }
+
+    [[nodiscard]]
+    const uint8_t* data() const
+    {
+        return m_data;
+    }
+
+    [[nodiscard]]
+    uint32_t size() const
+    {
+        return m_size;
+    }
+
+    // Give the payload's slot back to the server
+    void release()
+    {
+        if (m_server != nullptr)
+        {
+            udcReleaseMessage(m_server, m_index);
+            m_server = nullptr;
+            m_data = nullptr;
+        }
+    }
+
+protected:
+
+    friend class UdcAsyncServer;
+
+    UdcServer* m_server;
+    const uint8_t* m_data;
+    uint32_t m_index;
+    uint32_t m_size;
+};
+
+// UdcAsyncServer
+// Runs the coroutines waiting on a server, on the thread that calls poll() or run()
+class UdcAsyncServer
+{
+public:
+
+    // A suspended coroutine and what it waits for
+    struct Waiter
+    {
+        Waiter* next;
+        std::coroutine_handle<> handle;
+        UdcEndPointId endPointId;
+    };
+
+    // Resumes with the connected endpoint, which is empty if the connection failed or timed out
+    class ConnectAwaiter : public Waiter
+    {
+    public:
+
+        ConnectAwaiter(UdcAsyncServer& server, const char* nodeName, const char* serviceName, uint32_t timeout);
+
+        bool await_ready() const noexcept { return !m_initiated; }
+
+        void await_suspend(std::coroutine_handle<> handle);
+
+        UdcAsyncEndPoint await_resume() const;
+
+    protected:
+
+        friend class UdcAsyncServer;
+
+        UdcAsyncServer& m_server;
+        bool m_initiated;
+        bool m_connected;
+    };
+
+    // Resumes with the next message from an endpoint, which is empty if the wait was cancelled
+    class ReceiveAwaiter : public Waiter
+    {
+    public:
+
+        ReceiveAwaiter(UdcAsyncServer& server, UdcEndPointId endPointId);
+
+        bool await_ready();
+
+        void await_suspend(std::coroutine_handle<> handle);
+
+        UdcAsyncMessage await_resume() { return static_cast<UdcAsyncMessage&&>(m_message); }
+
+    protected:
+
+        friend class UdcAsyncServer;
+
+        UdcAsyncServer& m_server;
+        UdcAsyncMessage m_message;
+    };
+
+    // Resumes with true once the endpoint has acknowledged the message,
+    // or false if it couldn't be sent, the endpoint went away or the wait was cancelled
+    class SendReliableAwaiter : public Waiter
+    {
+    public:
+
+        SendReliableAwaiter(UdcAsyncServer& server, UdcEndPointId endPointId, const uint8_t* data, uint32_t size);
+
+        bool await_ready() const noexcept { return m_done; }
+
+        void await_suspend(std::coroutine_handle<> handle);
+
+        bool await_resume() const noexcept { return m_acknowledged; }
+
+    protected:
+
+        friend class UdcAsyncServer;
+
+        UdcAsyncServer& m_server;
+        uint64_t m_target; // the acknowledged count that includes this message
+        bool m_done;
+        bool m_acknowledged;
+    };
+
+    // buffer is the buffer the server was created with
+    UdcAsyncServer(UdcServer* server, const uint8_t* buffer)
+        : m_server(server)
+        , m_buffer(buffer)
+    {}
+
+    UdcAsyncServer(const UdcAsyncServer&) = delete;
+
+    UdcAsyncServer& operator=(const UdcAsyncServer&) = delete;
+
+    // Coroutines that are still waiting are destroyed
+    ~UdcAsyncServer()
+    {
+        for (auto& [endPointId, waiters] : m_endPoints)
+        {
+            for (WaiterList* list : {&waiters.connecting, &waiters.receiving, &waiters.sending})
+            {
+                while (Waiter* waiter = list->pop())
+                {
+                    waiter->handle.destroy();
+                }
+            }
+
+            for (const auto& event : waiters.pending)
+            {
+                udcReleaseMessage(m_server, event.msgIndex);
+            }
+        }
+    }
+
+    [[nodiscard]]
+    UdcServer* server() const
+    {
+        return m_server;
+    }
+
+    // Start connecting, see udcTryConnect()
+    [[nodiscard]]
+    ConnectAwaiter connect(const char* nodeName, const char* serviceName, uint32_t timeout)
+    {
+        return {*this, nodeName, serviceName, timeout};
+    }
+
+    // Process the server's events and resume the coroutines that they complete
+    void poll()
+    {
+        const UdcEvent* event;
+
+        while ((event = udcProcessEvents(m_server)) != nullptr)
+        {
+            handleEvent(*event);
+        }
+
+        resumeAcknowledged();
+    }
+
+    // Block until the server has events, one of its timers is due, or timeout (us) passes
+    // built on udcWaitEvents(), so the server mustn't be running an I/O thread
+    // returns false if the timeout passed without any
+    bool wait(uint32_t timeout)
+    {
+        return udcWaitEvents(m_server, timeout);
+    }
+
+    // Wait for up to timeout (us), and then resume the coroutines that the server's events complete
+    // returns false if the timeout passed without any events
+    bool run(uint32_t timeout)
+    {
+        bool ready = wait(timeout);
+        poll();
+
+        return ready;
+    }
+
+    // Resume every coroutine waiting on an endpoint with an empty result,
+    // and drop the messages from it that nobody has received
+    void cancel(UdcEndPointId endPointId)
+    {
+        auto found = m_endPoints.find(endPointId);
+
+        if (found == m_endPoints.end())
+        {
+            return;
+        }
+
+        // The entry is removed before anything is resumed, since a coroutine may wait on the endpoint again
+        EndPointWaiters waiters = static_cast<EndPointWaiters&&>(found->second);
+        m_endPoints.erase(found);
+
+        for (const auto& event : waiters.pending)
+        {
+            udcReleaseMessage(m_server, event.msgIndex);
+        }
+
+        for (WaiterList* list : {&waiters.connecting, &waiters.receiving, &waiters.sending})
+        {
+            while (Waiter* waiter = list->pop())
+            {
+                waiter->handle.resume();
+            }
+        }
+    }
+
+protected:
+
+    // Waiters of one kind on one endpoint, oldest first
+    struct WaiterList
+    {
+        Waiter* head = nullptr;
+        Waiter* tail = nullptr;
+
+        [[nodiscard]]
+        bool empty() const
+        {
+            return head == nullptr;
+        }
+
+        void push(Waiter* waiter)
+        {
+            waiter->next = nullptr;
+            (tail == nullptr ? head : tail->next) = waiter;
+            tail = waiter;
+        }
+
+        // Unlink the oldest waiter, or return nullptr
+        Waiter* pop()
+        {
+            Waiter* waiter = head;
+
+            if (waiter != nullptr)
+            {
+                head = waiter->next;
+                tail = (head == nullptr) ? nullptr : tail;
+            }
+
+            return waiter;
+        }
+    };
+
+    // Everything waiting on an endpoint
+    // an entry is kept until the endpoint is cancelled or fails to connect, so that waiting again doesn't allocate
+    struct EndPointWaiters
+    {
+        WaiterList connecting;
+        WaiterList receiving;
+        WaiterList sending;
+
+        // Messages that arrived before anything waited for them, oldest first
+        // the vector keeps its capacity, so it stops allocating once it has grown
+        std::vector<UdcEvent> pending;
+    };
+
+    UdcServer* m_server;
+    const uint8_t* m_buffer;
+
+    std::unordered_map<UdcEndPointId, EndPointWaiters> m_endPoints;
+
+    // Endpoints that may have senders waiting, checked by resumeAcknowledged()
+    std::vector<UdcEndPointId> m_sendingEndPoints;
+
+    // Senders to resume once every endpoint has been checked
+    std::vector<Waiter*> m_acknowledged;
+
+    void addSender(Waiter* waiter)
+    {
+        auto& sending = m_endPoints[waiter->endPointId].sending;
+
+        if (sending.empty())
+        {
+            m_sendingEndPoints.push_back(waiter->endPointId);
+        }
+
+        sending.push(waiter);
+    }
+
+    void fillMessage(UdcAsyncMessage& message, const UdcEvent& event) const
+    {
+        message.m_server = m_server;
+        message.m_data = m_buffer + event.msgIndex;
+        message.m_index = event.msgIndex;
+        message.m_size = event.msgSize;
+    }
+
+    // The waiters are unlinked before a coroutine is resumed, and aren't touched afterwards,
+    // since the coroutine can wait again or cancel its endpoint
+    void handleEvent(const UdcEvent& event)
+    {
+        switch (event.eventType)
+        {
+            case UDC_EVENT_CONNECTION_SUCCESS:
+            case UDC_EVENT_CONNECTION_TIMEOUT:
+            {
+                auto found = m_endPoints.find(event.endPointId);
+
+                if (found == m_endPoints.end())
+                {
+                    break;
+                }
+
+                auto* waiter = static_cast<ConnectAwaiter*>(found->second.connecting.pop());
+
+                // An endpoint that didn't connect is never waited on again
+                if (event.eventType == UDC_EVENT_CONNECTION_TIMEOUT && found->second.connecting.empty())
+                {
+                    m_endPoints.erase(found);
+                }
+
+                if (waiter != nullptr)
+                {
+                    waiter->m_connected = (event.eventType == UDC_EVENT_CONNECTION_SUCCESS);
+                    waiter->handle.resume();
+                }
+                break;
+            }
+            case UDC_EVENT_RECEIVE_MESSAGE_IPV4:
+            case UDC_EVENT_RECEIVE_MESSAGE_IPV6:
+            {
+                if (event.endPointId == 0)
+                {
+                    udcReleaseMessage(m_server, event.msgIndex);
+                    break;
+                }
+
+                auto& waiters = m_endPoints[event.endPointId];
+
+                if (auto* waiter = static_cast<ReceiveAwaiter*>(waiters.receiving.pop()))
+                {
+                    fillMessage(waiter->m_message, event);
+                    waiter->handle.resume();
+                }
+                else
+                {
+                    waiters.pending.push_back(event);
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    // Resume every sender whose message has been acknowledged
+    // an endpoint's senders are acknowledged in the order they were queued, so only the oldest is checked
+    void resumeAcknowledged()
+    {
+        size_t kept = 0;
+
+        for (UdcEndPointId endPointId : m_sendingEndPoints)
+        {
+            auto found = m_endPoints.find(endPointId);
+
+            if (found == m_endPoints.end())
+            {
+                continue;
+            }
+
+            auto& sending = found->second.sending;
+
+            while (!sending.empty())
+            {
+                auto& sender = static_cast<SendReliableAwaiter&>(*sending.head);
+
+                uint64_t count;
+                uint32_t queued;
+
+                // A sender whose endpoint has gone is resumed with false
+                if (udcGetReliableProgress(m_server, endPointId, count, queued))
+                {
+                    sender.m_acknowledged = (count >= sender.m_target);
+
+                    if (!sender.m_acknowledged)
+                    {
+                        break;
+                    }
+                }
+
+                m_acknowledged.push_back(sending.pop());
+            }
+
+            if (!sending.empty())
+            {
+                m_sendingEndPoints[kept++] = endPointId;
+            }
+        }
+
+        m_sendingEndPoints.resize(kept);
+
+        // Resumed senders wait again through addSender(), which doesn't touch this list
+        for (size_t i = 0; i != m_acknowledged.size(); ++i)
+        {
+            m_acknowledged[i]->handle.resume();
+        }
+
+        m_acknowledged.clear();
+    }
+};
+
+// UdcAsyncEndPoint
+// A connected endpoint of a UdcAsyncServer
+class UdcAsyncEndPoint
+{
+public:
+
+    UdcAsyncEndPoint()
+        : m_server(nullptr)
+        , m_endPointId(0)
+    {}
+
+    UdcAsyncEndPoint(UdcAsyncServer& server, UdcEndPointId endPointId)
+        : m_server(&server)
+        , m_endPointId(endPointId)
+    {}
+
+    // False if the connection failed
+    explicit operator bool() const
+    {
+        return m_endPointId != 0;
+    }
+
+    [[nodiscard]]
+    UdcEndPointId id() const
+    {
+        return m_endPointId;
+    }
+
+    // Wait for the next message from the endpoint
+    [[nodiscard]]
+    UdcAsyncServer::ReceiveAwaiter receive() const
+    {
+        return {*m_server, m_endPointId};
+    }
+
+    // Send a reliable message and wait for the endpoint to acknowledge it
+    [[nodiscard]]
+    UdcAsyncServer::SendReliableAwaiter sendReliable(const uint8_t* data, uint32_t size) const
+    {
+        return {*m_server, m_endPointId, data, size};
+    }
+
+    // Send an unreliable message, nothing to wait for
+    bool send(const uint8_t* data, uint32_t size) const
+    {
+        return udcSendMessage(m_server->server(), m_endPointId, data, size, UDC_UNRELIABLE_MESSAGE);
+    }
+
+protected:
+
+    UdcAsyncServer* m_server;
+    UdcEndPointId m_endPointId;
+};
+
+inline UdcAsyncServer::ConnectAwaiter::ConnectAwaiter(
+    UdcAsyncServer& server,
+    const char* nodeName,
+    const char* serviceName,
+    uint32_t timeout)
+    : Waiter{nullptr, {}, 0}
+    , m_server(server)
+    , m_initiated(udcTryConnect(server.m_server, nodeName, serviceName, timeout, endPointId))
+    , m_connected(false)
+{}
+
+inline void UdcAsyncServer::ConnectAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    this->handle = handle;
+    m_server.m_endPoints[endPointId].connecting.push(this);
+}
+
+inline UdcAsyncEndPoint UdcAsyncServer::ConnectAwaiter::await_resume() const
+{
+    return m_connected
+        ? UdcAsyncEndPoint(m_server, endPointId)
+        : UdcAsyncEndPoint();
+}
+
+inline UdcAsyncServer::ReceiveAwaiter::ReceiveAwaiter(UdcAsyncServer& server, UdcEndPointId endPointId)
+    : Waiter{nullptr, {}, endPointId}
+    , m_server(server)
+{}
+
+inline bool UdcAsyncServer::ReceiveAwaiter::await_ready()
+{
+    // A message that arrived before this wait
+    auto found = m_server.m_endPoints.find(endPointId);
+
+    if (found == m_server.m_endPoints.end() || found->second.pending.empty())
+    {
+        return false;
+    }
+
+    auto& pending = found->second.pending;
+    m_server.fillMessage(m_message, pending.front());
+    pending.erase(pending.begin());
+
+    return true;
+}
+
+inline void UdcAsyncServer::ReceiveAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    this->handle = handle;
+    m_server.m_endPoints[endPointId].receiving.push(this);
+}
+
+inline UdcAsyncServer::SendReliableAwaiter::SendReliableAwaiter(
+    UdcAsyncServer& server,
+    UdcEndPointId endPointId,
+    const uint8_t* data,
+    uint32_t size)
+    : Waiter{nullptr, {}, endPointId}
+    , m_server(server)
+    , m_target(0)
+    , m_done(true)
+    , m_acknowledged(false)
+{
+    uint64_t acknowledged;
+    uint32_t queued;
+
+    // The message is the last one queued, so it's acknowledged once everything queued is
+    if (udcSendMessage(server.m_server, endPointId, data, size, UDC_RELIABLE_MESSAGE) &&
+        udcGetReliableProgress(server.m_server, endPointId, acknowledged, queued))
+    {
+        m_target = acknowledged + queued;
+        m_done = false;
+    }
+}
+
+inline void UdcAsyncServer::SendReliableAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    this->handle = handle;
+    m_server.addSender(this);
+}
+
+#endif
@@ -5,22 +5,28 @@
 #define UDC_CLIENT_H
 
 #include "udp_connect.h"
-#include "UdcSocketMux.h"
+#include "UdcAddressMux.h"
 #include "UdcMessage.h"
+#include "UdcMessagePool.h"
+#include "UdcRingQueue.h"
+#include "UdcEndPointTable.h"
 
 #include <cstdint>
 #include <vector>
 #include <chrono>
-#include <queue>
 
+// UdcClient
+// Handle to one endpoint's row of a UdcEndPointTable
+// handles are cheap to copy, and stay valid until the endpoint is erased
 class UdcClient
 {
 public:
-    UdcClient(
-        UdcEndPointId endPointId,
-        const UdcAddressMux& outgoingAddress,
-        std::chrono::milliseconds pingPeriod,
-        std::chrono::milliseconds timeoutPeriod);
+    // How long the first connection request to the other family waits for an answer from the first
+    static constexpr std::chrono::microseconds RACE_DELAY = std::chrono::milliseconds(250);
+
+    UdcClient();
+
+    UdcClient(UdcEndPointTable* table, uint32_t index);
 
     // Get client id
     [[nodiscard]]
@@ -34,107 +40,149 @@ public:
     void setReliableState(int state);
 
     // The reliable message queue for this client
+    // messages are owned by the server's message pool
+    [[nodiscard]]
+    UdcRingQueue<UdcPooledMessage*>& reliableMessages();
+
+    // Number of reliable messages that have been acknowledged since connecting
+    [[nodiscard]]
+    uint64_t reliableAcknowledged() const;
+
+    // Count the message at the front of the reliable queue as acknowledged
+    void acknowledgeReliable();
+
+    // Packets sent to and received from this client
     [[nodiscard]]
-    std::queue<std::vector<uint8_t>>& reliableMessages();
+    UdcTrafficStats& stats();
 
     // Returns true if the client is connected
     [[nodiscard]]
     bool connected() const;
 
+    // Returns true until the connection handshake has been received
+    [[nodiscard]]
+    bool pending() const;
+
     // Get client ping
     [[nodiscard]]
-    std::chrono::milliseconds ping() const;
+    std::chrono::microseconds ping() const;
 
     // Get client outgoing address
     [[nodiscard]]
     const UdcAddressMux& outgoingAddress() const;
 
-    // Get client incoming address
+    // The application's context for this client
     [[nodiscard]]
-    const UdcAddressMux& incomingAddress() const;
+    void* context() const;
+
+    void setContext(void* context);
 
-    void startConnecting(std::chrono::milliseconds time);
+    void startConnecting(std::chrono::microseconds time);
 
-    void retryConnecting(std::chrono::milliseconds time);
+    // Returns true while the address is being looked up, nothing is sent until it's known
+    [[nodiscard]]
+    bool resolving() const;
+
+    void startResolving();
+
+    // Set the address that was looked up, connection attempts start at the next timer
+    void finishResolving(const UdcAddressMux& address);
+
+    // The address couldn't be looked up, so the connection times out at the next timer
+    void failResolving(std::chrono::microseconds time);
+
+    // Race connection requests to an address of the other family
+    void setAlternateAddress(const UdcAddressMux& address);
+
+    [[nodiscard]]
+    const UdcAddressMux& alternateAddress() const;
+
+    // Returns true once connection requests are being sent to both addresses
+    [[nodiscard]]
+    bool raceStarted() const;
+
+    void startRace();
+
+    // The first connection request has gone unanswered long enough to try the other family
+    [[nodiscard]]
+    bool needsAlternateAttempt(std::chrono::microseconds time) const;
+
+    // Stop racing, and keep sending to the family that the handshake came back on
+    void finishRace(const UdcAddressMux& fromAddress);
+
+    void retryConnecting(std::chrono::microseconds time);
 
     void setConnectionLost();
 
     [[nodiscard]]
-    bool needsConnectionTimeoutEvent(std::chrono::milliseconds time) const;
+    bool needsConnectionTimeoutEvent(std::chrono::microseconds time) const;
 
     [[nodiscard]]
-    bool needsConnectionAttempt(std::chrono::milliseconds time) const;
+    bool needsConnectionAttempt(std::chrono::microseconds time) const;
 
-    // Set client ping (ms) after receiving PONG message
+    // Set client ping after receiving PONG message
     // refreshes last received timer
     // returns true if connection has been regained
     [[nodiscard]]
-    bool receivePong(std::chrono::milliseconds pingSentTime, std::chrono::milliseconds pongReceivedTime);
+    bool receivePong(std::chrono::microseconds pingSentTime, std::chrono::microseconds pongReceivedTime);
 
     // Receive a handshake
-    void receiveConnectionHandshake(std::chrono::milliseconds receivedTime);
+    void receiveConnectionHandshake(std::chrono::microseconds receivedTime);
 
     // Client needs a ping
     // It has been longer than pingPeriod since the last time
     // this client's ping was set.
     [[nodiscard]]
-    bool needsPing(std::chrono::milliseconds time) const;
+    bool needsPing(std::chrono::microseconds time) const;
 
     // Client should get timed out
     // time since last received is longer than timeoutPeriod
     [[nodiscard]]
-    bool needsConnectionLostEvent(std::chrono::milliseconds time) const;
+    bool needsConnectionLostEvent(std::chrono::microseconds time) const;
 
-    // Set client ping (ms) after receiving a valid reliable handshake
+    // Set client ping after receiving a valid reliable handshake
     // refreshes last received timer
     // returns true if connection has been regained
     [[nodiscard]]
-    bool receiveReliableHandshake(std::chrono::milliseconds reliableSentTime, std::chrono::milliseconds handshakeReceivedTime);
+    bool receiveReliableHandshake(std::chrono::microseconds reliableSentTime, std::chrono::microseconds handshakeReceivedTime);
 
     // start the reliable timeout timer if it's the first attempt
-    void setSendReliable(std::chrono::milliseconds time);
+    void setSendReliable(std::chrono::microseconds time);
 
     // reset the reliable timeout timer
     void resetSendReliable();
 
-    // true if the client needs its reliable state reset after timeout
+    // true if the reliable message at the front of the queue has been sent and not acknowledged
     [[nodiscard]]
-    bool needsReliableReset(std::chrono::milliseconds time) const;
-
-protected:
-    UdcEndPointId m_id;
-
-    // The reliable message id
-    int m_reliableState;
+    bool awaitingReliableHandshake() const;
 
-    // The reliable message queue for this client
-    std::queue<std::vector<uint8_t>> m_reliableMessages;
+    // true if the client needs its reliable state reset after timeout
+    [[nodiscard]]
+    bool needsReliableReset(std::chrono::microseconds time) const;
 
-    // True when first connected,
-    // false if UDC_EVENT_CONNECTION_LOST
-    // and set back to true when UDC_EVENT_CONNECTION_REGAINED
-    bool m_isConnected;
+    // The next time that a connection attempt or a connection timeout is due
+    [[nodiscard]]
+    std::chrono::microseconds nextConnectionAttemptTime() const;
 
-    UdcAddressMux m_outgoingAddress; // The address that this server sends to
-    UdcAddressMux m_incomingAddress; // The address that this server gets back
+    // The next time that a ping is due
+    [[nodiscard]]
+    std::chrono::microseconds nextPingTime() const;
 
-    std::chrono::milliseconds m_pingPeriod; // how often ping is queried
-    std::chrono::milliseconds m_connectionTimeoutPeriod; // how long before a connection times out (while connecting)
-    std::chrono::milliseconds m_connectionLostPeriod; // how long before a connection times out (while connected)
-    std::chrono::milliseconds m_connectionAttemptPeriod; // how long between connection attempts
-    std::chrono::milliseconds m_reliableTimeoutPeriod; // timeout for reliable handshake before resetting client state
+    // The time at which the connection will be lost if nothing else is received
+    [[nodiscard]]
+    std::chrono::microseconds connectionLostTime() const;
 
-    std::chrono::milliseconds m_ping; // the last retrieved ping value
-    std::chrono::milliseconds m_pingLastSetTime; // last time a ping was sent
-    std::chrono::milliseconds m_lastReceivedTime; // time since last message received
+    // How long to wait before resending an unacknowledged reliable message or ping
+    [[nodiscard]]
+    std::chrono::microseconds retransmitPeriod() const;
 
-    // if the server is awaiting a reliable message handshake, then this is
-    // the time at which the reliable message was first sent.
-    // otherwise, this value is {0}.
-    std::chrono::milliseconds m_reliableSentTime;
+protected:
+    UdcEndPointTable* m_table;
+    uint32_t m_index;
 
-    std::chrono::milliseconds m_firstConnectAttemptTime;
-    std::chrono::milliseconds m_prevConnectAttemptTime;
+    // How long to wait after the first connection request before racing the other family
+    [[nodiscard]]
+    std::chrono::microseconds raceDelay() const;
 };
 
 #endif
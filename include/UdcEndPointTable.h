@@ -0,0 +1,158 @@
+// udp-connect
+// Kyle J Burgess
+
+#ifndef UDC_END_POINT_TABLE_H
+#define UDC_END_POINT_TABLE_H
+
+#include "udp_connect.h"
+#include "UdcAddressMux.h"
+#include "UdcMessagePool.h"
+#include "UdcRingQueue.h"
+#include "UdcTrafficStats.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <chrono>
+
+class UdcClient;
+
+// UdcEndPointTable
+// Endpoint state stored as a structure of arrays, indexed by slot
+// hot columns are read and written by timers and received packets,
+// cold columns hold configuration and are only read when connecting or sending,
+// so maintenance touches a few bytes per endpoint instead of a whole client object
+//
+// an id encodes a slot index (low bits) and the generation of the slot (high bits),
+// so lookups are a single array access plus a generation check, and the id of
+// a removed endpoint isn't mistaken for the endpoint that reuses its slot
+// the generation has 12 bits and skips 0, so it wraps after 4095 reuses of a slot,
+// and an id held across that many reuses names whichever endpoint then holds the slot
+class UdcEndPointTable
+{
+public:
+
+    static constexpr uint32_t INDEX_BITS = 20;
+    static constexpr uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1u;
+    static constexpr uint32_t GENERATION_MASK = (1u << (32u - INDEX_BITS)) - 1u;
+
+    // Deadline of a timer that is not armed
+    static constexpr std::chrono::microseconds NEVER = std::chrono::microseconds::max();
+
+    UdcEndPointTable();
+
+    // Get the slot index of an id
+    [[nodiscard]]
+    static uint32_t indexOf(UdcEndPointId id);
+
+    // Add a pending endpoint in a free slot
+    // returns false if every slot is in use
+    [[nodiscard]]
+    bool emplace(
+        const UdcAddressMux& outgoingAddress,
+        std::chrono::microseconds pingPeriod,
+        std::chrono::microseconds timeoutPeriod,
+        UdcEndPointId& id);
+
+    // Add free slots until there are count slots, so that endpoints can be added without allocating
+    // returns false if count is larger than the maximum number of slots
+    [[nodiscard]]
+    bool reserve(uint32_t count);
+
+    // Move every column into new storage allocated and first written by the calling thread
+    // memory is placed on the NUMA node of the thread that first writes it,
+    // so calling this from a pinned thread keeps the table local to that thread
+    void relocate();
+
+    // Remove the endpoint with id
+    // queued reliable messages must already have been released
+    // returns false if the id is stale or was never valid
+    bool erase(UdcEndPointId id);
+
+    // Get the endpoint with id
+    // returns false if the id is stale
+    [[nodiscard]]
+    bool find(UdcEndPointId id, UdcClient& client);
+
+    // Get the endpoint in slot index
+    // returns false if the slot is free
+    [[nodiscard]]
+    bool atIndex(uint32_t index, UdcClient& client);
+
+    // Number of slots (used and free)
+    [[nodiscard]]
+    uint32_t slotCount() const;
+
+    // Number of endpoints
+    [[nodiscard]]
+    uint32_t size() const;
+
+    // Bytes of hot column storage per endpoint
+    [[nodiscard]]
+    static size_t hotBytesPerEndPoint();
+
+    // Bytes of cold column storage per endpoint
+    // not counting the heap storage of each reliable message queue
+    [[nodiscard]]
+    static size_t coldBytesPerEndPoint();
+
+    // Bytes currently reserved by every column
+    // not counting the heap storage of each reliable message queue
+    [[nodiscard]]
+    size_t memoryUsage() const;
+
+protected:
+
+    friend class UdcClient;
+
+    static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+    enum Flags : uint8_t
+    {
+        FLAG_USED = 1,
+        FLAG_PENDING = 2,
+        FLAG_CONNECTED = 4,
+        FLAG_RESOLVING = 8,
+        FLAG_RACING = 16, // connection requests are also sent to m_alternateAddress
+        FLAG_RACE_STARTED = 32,
+    };
+
+    // Hot columns
+
+    std::vector<uint8_t> m_flags;
+    std::vector<int8_t> m_reliableState; // the reliable message id
+    std::vector<std::chrono::microseconds> m_ping; // the last retrieved ping value
+    std::vector<std::chrono::microseconds> m_nextPingTime; // last time ping was set + ping period
+    std::vector<std::chrono::microseconds> m_connectionLostTime; // last time received + timeout period, NEVER while not connected
+
+    // if the server is awaiting a reliable message handshake, then this is
+    // the time at which the reliable message was first sent.
+    // otherwise, this value is {0}.
+    std::vector<std::chrono::microseconds> m_reliableSentTime;
+
+    // Cold columns
+
+    std::vector<uint32_t> m_generation;
+    std::vector<uint32_t> m_nextFree;
+    std::vector<UdcAddressMux> m_outgoingAddress; // the address that this server sends to
+    std::vector<std::chrono::microseconds> m_pingPeriod; // how often ping is queried, and how long between connection attempts
+    std::vector<std::chrono::microseconds> m_timeoutPeriod; // connection timeout, connection lost, and reliable handshake timeout
+    std::vector<std::chrono::microseconds> m_firstConnectAttemptTime;
+    std::vector<std::chrono::microseconds> m_prevConnectAttemptTime;
+    std::vector<UdcAddressMux> m_alternateAddress; // the other family's address while racing to connect
+    std::vector<UdcRingQueue<UdcPooledMessage*>> m_reliableMessages; // messages are owned by the server's message pool
+    std::vector<void*> m_context; // set by the application, passed back with message events
+    std::vector<uint64_t> m_reliableAcknowledged; // number of reliable messages the endpoint has acknowledged
+    std::vector<UdcTrafficStats> m_stats; // written for every packet, but only read by udcGetStats()
+
+    uint32_t m_freeHead;
+    uint32_t m_size;
+
+    // Add a free slot to the end of every column, without linking it into the free list
+    // returns the slot index
+    uint32_t appendSlot();
+
+    void reserveColumns(uint32_t count);
+};
+
+#endif
@@ -0,0 +1,69 @@
+// udp-connect
+// Kyle J Burgess
+
+#ifndef UDC_GROUP_TABLE_H
+#define UDC_GROUP_TABLE_H
+
+#include "udp_connect.h"
+
+#include <cstdint>
+#include <vector>
+
+// UdcGroupTable
+// Groups of endpoints that are sent the same messages
+// ids encode a slot index and generation the same way as endpoint ids,
+// so ids of deleted groups are never mistaken for the group that reuses their slot
+//
+// members are kept by endpoint id and are not removed when an endpoint disconnects,
+// stale members are dropped by the server the next time it sends to the group
+class UdcGroupTable
+{
+public:
+
+    static constexpr uint32_t INDEX_BITS = 20;
+    static constexpr uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1u;
+    static constexpr uint32_t GENERATION_MASK = (1u << (32u - INDEX_BITS)) - 1u;
+
+    UdcGroupTable();
+
+    // Add an empty group in a free slot
+    // returns false if every slot is in use
+    [[nodiscard]]
+    bool create(UdcGroupId& id);
+
+    // Remove a group
+    // returns false if the id is stale or was never valid
+    bool erase(UdcGroupId id);
+
+    // Add an endpoint to a group
+    // returns false if the group doesn't exist or the endpoint is already a member
+    [[nodiscard]]
+    bool add(UdcGroupId id, UdcEndPointId endPointId);
+
+    // Remove an endpoint from a group
+    // returns false if the group doesn't exist or the endpoint isn't a member
+    bool remove(UdcGroupId id, UdcEndPointId endPointId);
+
+    // Get the members of a group, in no particular order
+    // returns nullptr if the id is stale
+    [[nodiscard]]
+    std::vector<UdcEndPointId>* members(UdcGroupId id);
+
+protected:
+
+    static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+    struct Group
+    {
+        uint32_t generation;
+        uint32_t nextFree; // NONE while the group is in use or the last free slot
+        bool used;
+        std::vector<UdcEndPointId> members;
+    };
+
+    std::vector<Group> m_groups;
+
+    uint32_t m_freeHead;
+};
+
+#endif
@@ -0,0 +1,95 @@
+// udp-connect
+// Kyle J Burgess
+
+#ifndef UDC_MESSAGE_POOL_H
+#define UDC_MESSAGE_POOL_H
+
+#include "udp_connect.h"
+
+#include <cstdint>
+#include <vector>
+#include <memory>
+
+// A pooled message payload
+// the payload bytes are stored directly after the header
+// a block can be shared by several queues, and returns to the pool when the last one releases it
+struct UdcPooledMessage
+{
+    // Next block in the free list (only valid while the block is free)
+    UdcPooledMessage* next;
+
+    // Size of the payload in bytes
+    uint32_t size;
+
+    // Number of queues holding the block (only valid while the block is in use)
+    uint32_t refCount;
+
+    // Index of the size class that the block belongs to
+    uint32_t sizeClass;
+
+    [[nodiscard]]
+    uint8_t* data()
+    {
+        return reinterpret_cast<uint8_t*>(this + 1);
+    }
+
+    [[nodiscard]]
+    const uint8_t* data() const
+    {
+        return reinterpret_cast<const uint8_t*>(this + 1);
+    }
+};
+
+// UdcMessagePool
+// Size-classed slab allocator for queued message payloads
+// blocks are never returned to the heap until the pool is destroyed,
+// so after warm-up acquire() and release() don't allocate
+class UdcMessagePool
+{
+public:
+
+    explicit UdcMessagePool(uint32_t maxMessageSize);
+
+    UdcMessagePool(const UdcMessagePool&) = delete;
+
+    UdcMessagePool& operator=(const UdcMessagePool&) = delete;
+
+    // Gather segments into a pooled block, size is the total size of the segments
+    // the block starts with one reference
+    // returns nullptr if size is larger than the max message size
+    [[nodiscard]]
+    UdcPooledMessage* acquire(const UdcSegment* segments, uint32_t segmentCount, uint32_t size);
+
+    // Add references to a block
+    void retain(UdcPooledMessage* msg, uint32_t count);
+
+    // Remove a reference to a block, returning it to its size class when none are left
+    void release(UdcPooledMessage* msg);
+
+    // Number of slabs that have been allocated from the heap
+    [[nodiscard]]
+    uint32_t slabCount() const;
+
+protected:
+
+    // Smallest size class holds 64 byte payloads
+    static constexpr uint32_t MIN_CLASS_SHIFT = 6;
+
+    // Target size of a slab in bytes
+    static constexpr uint32_t SLAB_SIZE = 64 * 1024;
+
+    struct SizeClass
+    {
+        uint32_t capacity;  // max payload size in bytes
+        uint32_t blockSize; // header + payload, rounded up for alignment
+        UdcPooledMessage* freeList;
+    };
+
+    std::vector<SizeClass> m_classes;
+
+    std::vector<std::unique_ptr<uint8_t[]>> m_slabs;
+
+    void allocateSlab(uint32_t sizeClass);
+};
+
+#endif
@@ -24,6 +24,10 @@ public:
 
     void logSent(const UdcAddressIPv6& address, uint16_t port, const uint8_t* data, uint32_t size);
 
+    void logSent(const UdcAddressIPv4& address, uint16_t port, const UdcSegment* segments, uint32_t segmentCount);
+
+    void logSent(const UdcAddressIPv6& address, uint16_t port, const UdcSegment* segments, uint32_t segmentCount);
+
 protected:
 
     std::ofstream m_file;
@@ -0,0 +1,101 @@
+// udp-connect
+// Kyle J Burgess
+
+#ifndef UDC_RELIABLE_STATE_TABLE_H
+#define UDC_RELIABLE_STATE_TABLE_H
+
+#include "UdcAddressMux.h"
+#include "UdcAddressHash.h"
+
+#include <cstdint>
+#include <vector>
+#include <chrono>
+
+// UdcReliableStateTable
+// The reliable message state expected from each remote address
+// the table holds at most capacity addresses; when it's full the least recently
+// used address is evicted, and addresses that send nothing reliable for
+// idleTimeout are expired
+//
+// losing the state of an address only matters if that address is still
+// retransmitting, so the idle timeout must be longer than the remote's reliable timeout
+class UdcReliableStateTable
+{
+public:
+
+    static constexpr uint32_t DEFAULT_CAPACITY = 65536;
+    static constexpr std::chrono::microseconds DEFAULT_IDLE_TIMEOUT = std::chrono::seconds(60);
+
+    UdcReliableStateTable();
+
+    // Set the maximum number of addresses, evicting addresses if there are too many
+    void setCapacity(uint32_t capacity);
+
+    // Set how long an address is kept after its last reliable message
+    void setIdleTimeout(std::chrono::microseconds idleTimeout);
+
+    // Get the state of an address and mark it as recently used
+    // returns nullptr if the address has no state
+    [[nodiscard]]
+    int* find(const UdcAddressMux& address, std::chrono::microseconds time);
+
+    // Add the state of an address that has no state
+    // evicts the least recently used address if the table is full
+    void insert(const UdcAddressMux& address, int state, std::chrono::microseconds time);
+
+    // Remove the state of an address
+    // returns false if the address has no state
+    bool erase(const UdcAddressMux& address);
+
+    // Remove every address that has been idle for longer than the idle timeout
+    void expire(std::chrono::microseconds time);
+
+    // Number of addresses with state
+    [[nodiscard]]
+    uint32_t size() const;
+
+    // Number of addresses removed because the table was full
+    [[nodiscard]]
+    uint64_t evictions() const;
+
+    // Number of addresses removed because they were idle
+    [[nodiscard]]
+    uint64_t expirations() const;
+
+protected:
+
+    static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+    // Entries form a doubly linked list from least to most recently used
+    // free entries are linked through next
+    struct Entry
+    {
+        UdcAddressMux address;
+        std::chrono::microseconds lastUsedTime;
+        uint32_t prev;
+        uint32_t next;
+        int state;
+    };
+
+    UdcAddressMap<uint32_t> m_index;
+    std::vector<Entry> m_entries;
+
+    uint32_t m_oldest;
+    uint32_t m_newest;
+    uint32_t m_freeHead;
+
+    uint32_t m_capacity;
+    std::chrono::microseconds m_idleTimeout;
+
+    uint64_t m_evictions;
+    uint64_t m_expirations;
+
+    void unlink(uint32_t index);
+
+    void linkNewest(uint32_t index);
+
+    // Remove the least recently used address
+    void removeOldest();
+};
+
+#endif
@@ -0,0 +1,139 @@
+// udp-connect
+// Kyle J Burgess
+
+#ifndef UDC_RESOLVER_H
+#define UDC_RESOLVER_H
+
+#include "udp_connect.h"
+#include "UdcAddressMux.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// UdcResolver
+// Resolves node and service names to addresses, remembering the results for a while
+//
+// names are looked up with UdcSocket for both IPv6 and IPv4; successful lookups are cached
+// for the positive TTL and failed ones for the negative TTL, so that a burst of connections
+// to the same name only reaches the name server once
+//
+// asynchronous lookups run on a few resolver threads that are started by the first one,
+// concurrent requests for the same name share a lookup, and results are collected with takeResults()
+class UdcResolver
+{
+public:
+
+    // The addresses a name resolved to, at most one of each family with IPv6 first
+    // count is 0 if the name couldn't be resolved
+    struct Addresses
+    {
+        uint32_t count;
+        UdcAddressMux address[2];
+    };
+
+    // The outcome of an asynchronous lookup
+    struct Result
+    {
+        UdcEndPointId endPointId; // the id the lookup was requested for
+        Addresses addresses;
+    };
+
+    // Called when lookups have finished, on the thread that finished them
+    using ResultCallback = void (*)(void* context);
+
+    static constexpr uint32_t THREAD_COUNT = 2;
+    static constexpr uint32_t DEFAULT_CAPACITY = 1024;
+    static constexpr std::chrono::microseconds DEFAULT_POSITIVE_TTL = std::chrono::seconds(60);
+    static constexpr std::chrono::microseconds DEFAULT_NEGATIVE_TTL = std::chrono::seconds(5);
+
+    UdcResolver();
+
+    // Waits for lookups in progress to finish
+    ~UdcResolver();
+
+    UdcResolver(const UdcResolver&) = delete;
+
+    UdcResolver& operator=(const UdcResolver&) = delete;
+
+    // Set how long results are cached, 0 doesn't cache that kind of result
+    // cached results are forgotten
+    void setTtl(std::chrono::microseconds positiveTtl, std::chrono::microseconds negativeTtl);
+
+    // Look up a name on the calling thread, unless it's cached
+    // returns false if it can't be resolved
+    [[nodiscard]]
+    bool resolve(const char* nodeName, const char* serviceName, Addresses& addresses);
+
+    // Look up a name on a resolver thread, unless it's cached
+    // the result is returned by takeResults() with endPointId
+    void resolveAsync(const char* nodeName, const char* serviceName, UdcEndPointId endPointId);
+
+    // Move every finished lookup into results, which is cleared first
+    void takeResults(std::vector<Result>& results);
+
+    // Returns true if there are finished lookups to take
+    [[nodiscard]]
+    bool hasResults() const;
+
+    // Set a callback for when lookups finish, nullptr for none
+    void setResultCallback(ResultCallback callback, void* context);
+
+    // Number of lookups that reached the name server
+    [[nodiscard]]
+    uint64_t lookups() const;
+
+protected:
+
+    struct Entry
+    {
+        Addresses addresses;
+        std::chrono::steady_clock::time_point expiry;
+    };
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::vector<std::thread> m_threads;
+    bool m_stopping;
+
+    // Cached results by key, see makeKey()
+    std::unordered_map<std::string, Entry> m_cache;
+    std::chrono::microseconds m_positiveTtl;
+    std::chrono::microseconds m_negativeTtl;
+
+    // Keys waiting for a resolver thread
+    std::deque<std::string> m_queue;
+
+    // Endpoints waiting for each key that's queued or being looked up
+    std::unordered_map<std::string, std::vector<UdcEndPointId>> m_waiting;
+
+    // Finished lookups that haven't been taken
+    std::vector<Result> m_results;
+    ResultCallback m_resultCallback;
+    void* m_resultContext;
+
+    uint64_t m_lookups;
+
+    [[nodiscard]]
+    static std::string makeKey(const char* nodeName, const char* serviceName);
+
+    // Look up a key with the name server, without the mutex held
+    static void lookUp(const std::string& key, Addresses& addresses);
+
+    // Get a cached result, must hold the mutex
+    [[nodiscard]]
+    const Entry* findCached(const std::string& key, std::chrono::steady_clock::time_point now);
+
+    // Cache a result, must hold the mutex
+    void cache(const std::string& key, const Addresses& addresses, std::chrono::steady_clock::time_point now);
+
+    void runThread();
+};
+
+#endif
@@ -0,0 +1,95 @@
+// udp-connect
+// Kyle J Burgess
+
+#ifndef UDC_RING_QUEUE_H
+#define UDC_RING_QUEUE_H
+
+#include <cstdint>
+#include <cassert>
+#include <vector>
+
+// UdcRingQueue
+// FIFO queue stored in a contiguous ring buffer
+// the buffer only grows (doubling), so once a queue has reached its
+// steady-state depth, push and pop never allocate
+template<class T>
+class UdcRingQueue
+{
+public:
+
+    UdcRingQueue()
+        : m_head(0)
+        , m_size(0)
+    {}
+
+    [[nodiscard]]
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    [[nodiscard]]
+    uint32_t size() const
+    {
+        return m_size;
+    }
+
+    [[nodiscard]]
+    T& front()
+    {
+        assert(m_size != 0);
+        return m_items[m_head];
+    }
+
+    [[nodiscard]]
+    const T& front() const
+    {
+        assert(m_size != 0);
+        return m_items[m_head];
+    }
+
+    void push(const T& item)
+    {
+        if (m_size == m_items.size())
+        {
+            grow();
+        }
+
+        m_items[(m_head + m_size) & (m_items.size() - 1)] = item;
+        ++m_size;
+    }
+
+    void pop()
+    {
+        assert(m_size != 0);
+        m_head = (m_head + 1) & (m_items.size() - 1);
+        --m_size;
+    }
+
+    void clear()
+    {
+        m_head = 0;
+        m_size = 0;
+    }
+
+protected:
+
+    std::vector<T> m_items; // capacity is always a power of two
+    uint32_t m_head;
+    uint32_t m_size;
+
+    void grow()
+    {
+        std::vector<T> items(m_items.empty() ? 8 : m_items.size() * 2);
+
+        for (uint32_t i = 0; i != m_size; ++i)
+        {
+            items[i] = m_items[(m_head + i) & (m_items.size() - 1)];
+        }
+
+        m_items.swap(items);
+        m_head = 0;
+    }
+};
+
+#endif
@@ -0,0 +1,88 @@
+// udp-connect
+// Kyle J Burgess
+
+#ifndef UDC_SEND_QUEUE_H
+#define UDC_SEND_QUEUE_H
+
+#include "udp_connect.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+// UdcSendQueue
+// Bounded lock-free queue of messages submitted by any number of threads
+// and sent by the one thread that processes the server's events
+//
+// every cell has its own payload storage and a sequence number, a producer claims a cell
+// by advancing the tail, copies its message in, and publishes it by advancing the cell's sequence;
+// producers only contend on the tail, and the consumer never writes to it
+class UdcSendQueue
+{
+public:
+
+    // A message waiting to be sent
+    struct Submission
+    {
+        UdcEndPointId endPointId;
+        UdcMessageType reliability;
+        const uint8_t* data;
+        uint32_t size;
+    };
+
+    static constexpr uint32_t MAX_CAPACITY = 1u << 20;
+
+    // capacity is rounded up to a power of two, and must be at most MAX_CAPACITY
+    UdcSendQueue(uint32_t capacity, uint32_t maxMessageSize);
+
+    UdcSendQueue(const UdcSendQueue&) = delete;
+
+    UdcSendQueue& operator=(const UdcSendQueue&) = delete;
+
+    // Copy a message into the queue, can be called from any thread
+    // returns false if the queue is full or the message is larger than the max message size
+    [[nodiscard]]
+    bool push(UdcEndPointId endPointId, const UdcSegment* segments, uint32_t segmentCount, UdcMessageType reliability);
+
+    // Get the oldest message, only called by the consumer
+    // returns false if there is no message, or the oldest one is still being copied in
+    [[nodiscard]]
+    bool front(Submission& submission) const;
+
+    // Remove the oldest message, freeing its cell for producers
+    void pop();
+
+    [[nodiscard]]
+    uint32_t capacity() const;
+
+    // Number of messages claimed by producers and not yet popped, only called by the consumer
+    [[nodiscard]]
+    uint32_t size() const;
+
+    [[nodiscard]]
+    uint32_t maxMessageSize() const;
+
+protected:
+
+    struct Cell
+    {
+        // pos while free for the producer at pos, pos + 1 once the message at pos is published
+        std::atomic<uint32_t> sequence;
+
+        UdcEndPointId endPointId;
+        UdcMessageType reliability;
+        uint32_t size;
+    };
+
+    std::unique_ptr<Cell[]> m_cells;
+    std::unique_ptr<uint8_t[]> m_payloads;
+
+    uint32_t m_mask;
+    uint32_t m_maxMessageSize;
+
+    // The producers' and consumer's positions are on separate cache lines
+    alignas(64) std::atomic<uint32_t> m_tail;
+    alignas(64) uint32_t m_head;
+};
+
+#endif
@@ -10,11 +10,35 @@
 #include "UdcPacketLogger.h"
 #include "UdcAddressHash.h"
 #include "UdcClient.h"
-#include "UdcEvent.h"
-
+#include "UdcMessagePool.h"
+#include "UdcReliableStateTable.h"
+#include "UdcResolver.h"
+#include "UdcEndPointTable.h"
+#include "UdcGroupTable.h"
+#include "UdcSendQueue.h"
+#include "UdcSpscQueue.h"
+#include "UdcTimerWheel.h"
+#include "UdcTrafficStats.h"
+#include "UdcWorkerPool.h"
+#include "UdcThreadPlacement.h"
+
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <chrono>
 #include <deque>
+#include <thread>
+#include <vector>
+
+// Timers that every endpoint can have scheduled
+enum UdcTimer : uint32_t
+{
+    UDC_TIMER_CONNECT,          // connection attempts and connection timeout (pending clients)
+    UDC_TIMER_PING,             // ping period, and ping retries until a pong arrives
+    UDC_TIMER_RELIABLE,         // reliable message sends, retransmits and reliable timeout
+    UDC_TIMER_CONNECTION_LOST,  // time since the last received message
+    UDC_TIMER_COUNT,
+};
 
 class UdcServerImpl
 {
@@ -24,90 +48,582 @@ public:
 
     UdcServerImpl(UdcSignature signature, uint8_t* buffer, uint32_t bufferSize, const std::string& logFileName);
 
+    ~UdcServerImpl();
+
+    // Read the server's monotonic clock
+    // read once per processing pass, and pass the result to everything in that pass
+    [[nodiscard]]
+    static std::chrono::microseconds currentTime();
+
     [[nodiscard]]
     bool tryBindIPv4(uint16_t port);
 
     [[nodiscard]]
     bool tryBindIPv6(uint16_t port);
 
+    // Exchange packets with servers on the same host through shared memory, see UdcSocketMux
+    // returns false if the I/O thread is running, or on failure
+    [[nodiscard]]
+    bool enableSharedMemory();
+
+    // Get the number of packets sent and received through shared memory
+    void getSharedMemoryCounters(uint64_t& sent, uint64_t& received) const;
+
     [[nodiscard]]
-    UdcEndPointId createUniqueId();
+    bool getEndPointStatus(UdcEndPointId id, std::chrono::microseconds& ping);
 
+    // Create a client and start connecting to it
+    // returns false if there is no room for another endpoint
+    [[nodiscard]]
+    bool addPendingClient(
+        const UdcAddressMux& address,
+        std::chrono::microseconds pingPeriod,
+        std::chrono::microseconds timeoutPeriod,
+        std::chrono::microseconds time,
+        UdcEndPointId& endPointId);
+
+    // Create a client for a resolved name
+    // when it resolved to both families, connection requests race to both addresses
+    // and the family that answers first is kept
+    // returns false if there is no room for another endpoint
+    [[nodiscard]]
+    bool addPendingClient(
+        const UdcResolver::Addresses& addresses,
+        std::chrono::microseconds pingPeriod,
+        std::chrono::microseconds timeoutPeriod,
+        std::chrono::microseconds time,
+        UdcEndPointId& endPointId);
+
+    // Create a client whose address is looked up on a resolver thread
+    // a name that can't be resolved ends with a connection timeout event
+    // returns false if there is no room for another endpoint
     [[nodiscard]]
-    bool getEndPointStatus(UdcEndPointId id, std::chrono::milliseconds& ping);
+    bool addResolvingClient(
+        const char* nodeName,
+        const char* serviceName,
+        std::chrono::microseconds pingPeriod,
+        std::chrono::microseconds timeoutPeriod,
+        std::chrono::microseconds time,
+        UdcEndPointId& endPointId);
+
+    // Look up an address on the calling thread, using the resolver's cache
+    [[nodiscard]]
+    bool resolveAddress(const char* nodeName, const char* serviceName, UdcResolver::Addresses& addresses);
 
-    void addPendingClient(std::shared_ptr<UdcClient> client, std::chrono::milliseconds time);
+    // Set how long resolved and unresolved names are cached
+    void setResolverTtl(std::chrono::microseconds positiveTtl, std::chrono::microseconds negativeTtl);
 
     void disconnectFromClient(UdcEndPointId endPointId);
 
+    // Get the number of reliable messages an endpoint has acknowledged, and the number still queued
+    // returns false if the endpoint doesn't exist
+    [[nodiscard]]
+    bool getReliableProgress(UdcEndPointId endPointId, uint64_t& acknowledged, uint32_t& queued);
+
+    // returns false if the endpoint doesn't exist
+    [[nodiscard]]
+    bool setEndPointContext(UdcEndPointId endPointId, void* context);
+
+    // Deliver connection success and timeout events in the order of addPendingClient() calls
+    // returns false if there are clients pending connection
+    [[nodiscard]]
+    bool setOrderedConnectionEvents(bool ordered);
+
+    // Limit the number of remote addresses that reliable state is kept for
+    // returns false if capacity or idleTimeout is 0
+    [[nodiscard]]
+    bool setReliableStateLimits(uint32_t capacity, std::chrono::microseconds idleTimeout);
+
+    void getReliableStateMetrics(uint32_t& size, uint64_t& evictions, uint64_t& expirations) const;
+
+    // Get the counters of the server, or of an endpoint if endPointId isn't 0
+    // returns false if the endpoint doesn't exist
+    [[nodiscard]]
+    bool getStats(UdcEndPointId endPointId, UdcStats& stats);
+
+    // Send a message made of at most UDC_MAX_MESSAGE_SEGMENTS segments
+    [[nodiscard]]
+    bool sendUnreliableMessage(UdcEndPointId endPointId, const UdcSegment* segments, uint32_t segmentCount);
+
+    // Queue a message made of at most UDC_MAX_MESSAGE_SEGMENTS segments
+    [[nodiscard]]
+    bool sendReliableMessage(UdcEndPointId endPointId, const UdcSegment* segments, uint32_t segmentCount);
+
+    // Divide the buffer into slotCount receive slots
+    // must be called before anything is received
+    // returns false if the slots would be too small
+    [[nodiscard]]
+    bool setEventRing(uint32_t slotCount, bool manualRelease);
+
+    // Number of receive slots
+    [[nodiscard]]
+    uint32_t slotCount() const;
+
+    // Release the slot of a received message with manual release
+    // returns false if the slot isn't held
+    [[nodiscard]]
+    bool releaseMessage(uint32_t msgIndex);
+
+    // Create the queue that any thread can submit messages to
+    // must be called before any thread submits
+    // returns false if there already is a queue, or capacity is 0 or too large
+    [[nodiscard]]
+    bool createSendQueue(uint32_t capacity);
+
+    // Submit a message to the send queue, can be called from any thread
+    // returns false if there is no queue, it's full, or the message is too large
+    [[nodiscard]]
+    bool queueMessage(UdcEndPointId endPointId, const UdcSegment* segments, uint32_t segmentCount, UdcMessageType reliability);
+
+    // Send every message that has been submitted to the send queue
+    // messages to endpoints that don't exist are dropped
+    void flushSendQueue();
+
+    // Handle expired ping and reliable timers on threadCount threads, including the updating thread
+    // 0 or 1 handles them on the updating thread
+    // returns false if threadCount is larger than UdcWorkerPool::MAX_WORKERS
+    [[nodiscard]]
+    bool setMaintenanceThreads(uint32_t threadCount);
+
+    // Pin the threads of a role to a set of processors, an empty mask lets them run on any processor
+    // maintenance workers are restarted, the I/O thread can't be running
+    // returns false if the I/O thread is running or the role is unknown
+    [[nodiscard]]
+    bool setThreadAffinity(UdcThreadRole role, const UdcProcessorSet& processors);
+
+    // Add free endpoint slots until there are count, so that connecting doesn't allocate
+    // returns false if count is larger than the maximum number of endpoints
+    [[nodiscard]]
+    bool reserveEndPoints(uint32_t count);
+
+    [[nodiscard]]
+    bool createGroup(UdcGroupId& groupId);
+
+    bool deleteGroup(UdcGroupId groupId);
+
+    // Add a pending or connected client to a group
+    [[nodiscard]]
+    bool addToGroup(UdcGroupId groupId, UdcEndPointId endPointId);
+
+    bool removeFromGroup(UdcGroupId groupId, UdcEndPointId endPointId);
+
+    // Send a message made of at most UDC_MAX_MESSAGE_SEGMENTS segments to every connected member
+    // unreliable messages are serialized once, reliable messages share one pooled payload
+    [[nodiscard]]
+    bool sendGroupMessage(UdcGroupId groupId, const UdcSegment* segments, uint32_t segmentCount, UdcMessageType reliability);
+
+    // Set the callback for a type of connection event
+    // returns false if eventType isn't a connection event
+    [[nodiscard]]
+    bool setConnectionCallback(UdcEventType eventType, UdcConnectionCallback callback, void* context);
+
+    void setMessageCallback(UdcMessageIPv4Callback callback, void* context);
+
+    void setMessageCallback(UdcMessageIPv6Callback callback, void* context);
+
+    // Pass an event to its callback
+    // returns false if the event's type has no callback
+    [[nodiscard]]
+    bool dispatchEvent(const UdcEvent* event) const;
+
+    // Start a thread that sends, receives and updates timers every period, independently of
+    // the application, and hands events to the application through a queue of eventCapacity events
+    // messages submitted with sendMessage are sent through the send queue, which is created if needed
+    // returns false if the thread is already running, or eventCapacity is 0 or too large
+    [[nodiscard]]
+    bool startIoThread(uint32_t eventCapacity, std::chrono::microseconds period);
+
+    // Stop the I/O thread, events that haven't been taken are discarded
+    void stopIoThread();
+
+    // Make the I/O thread check its sockets for up to spinPeriod after each update, then wait
+    // for a packet for the rest of the period, instead of sleeping for the whole period
+    // a spinPeriod of 0 sleeps for the whole period
+    // returns false if the I/O thread is running
+    [[nodiscard]]
+    bool setIoBusyPoll(std::chrono::microseconds spinPeriod);
+
+    // Get the number of I/O thread waits that received while spinning, that slept,
+    // and that were woken from sleeping by a packet
+    void getIoWaitCounters(uint64_t& spins, uint64_t& sleeps, uint64_t& wakeups) const;
+
+    [[nodiscard]]
+    bool ioThreadRunning() const;
+
+    // A handle that's signalled when there are packets to receive or lookups have finished
+    // returns nullptr while the I/O thread is running, or if it can't be created
+    [[nodiscard]]
+    void* eventHandle();
+
+    // The time until timers need to be updated, 0 if there's work now
+    // or microseconds::max() if nothing is scheduled
+    [[nodiscard]]
+    std::chrono::microseconds nextTimeout(std::chrono::microseconds time) const;
+
+    // Block until the event handle is signalled, or the timeout passes
+    // returns true if the event is signalled
+    [[nodiscard]]
+    bool waitForEvents(std::chrono::microseconds timeout);
+
+    // Lock the server state against the I/O thread
+    // the lock is empty while there is no I/O thread
+    [[nodiscard]]
+    std::unique_lock<std::mutex> lockState();
+
+    // Take the next event from the I/O thread, or nullptr if there are none
+    // events with a callback are passed to it, and the payload of a returned message
+    // is released on the next call unless messages are released manually
     [[nodiscard]]
-    bool sendUnreliableMessage(UdcEndPointId endPointId, const uint8_t* data, uint32_t size);
+    const UdcEvent* popIoEvent();
 
+    // Take at most capacity events from the I/O thread, see popIoEvent()
     [[nodiscard]]
-    bool sendReliableMessage(UdcEndPointId endPointId, const uint8_t* data, uint32_t size);
+    uint32_t popIoEvents(UdcEvent* events, uint32_t capacity);
 
+    // Receive messages until there is an event to return
+    // messages with a callback are passed to it without returning
     [[nodiscard]]
-    const UdcEvent* receiveMessages(std::chrono::milliseconds time);
+    const UdcEvent* receiveMessages(std::chrono::microseconds time);
 
+    // The same, but stop once messageLimit messages have taken a slot, counting those passed to a callback,
+    // and reduce messageLimit by the number that did
     [[nodiscard]]
-    const UdcEvent* updatePendingClients(std::chrono::milliseconds time);
+    const UdcEvent* receiveMessages(std::chrono::microseconds time, uint32_t& messageLimit);
 
+    // Handle every endpoint timer that has expired
+    // only endpoints with expired timers are visited
     [[nodiscard]]
-    const UdcEvent* updateClientConnectionStatus(std::chrono::milliseconds time);
+    const UdcEvent* updateTimers(std::chrono::microseconds time);
 
 protected:
 
     UdcSocketMux m_socket;
 
-    UdcEndPointId m_idCounter;
-
     UdcSignature m_packetSignature;
 
     UdcEvent m_eventBuffer;
 
-    // Maps temporary device ID to clients pending connection
-    std::deque<std::shared_ptr<UdcClient>> m_pendingClients;
+    // A callback and the context passed to it
+    template<typename Callback>
+    struct UdcEventHandler
+    {
+        Callback callback;
+        void* context;
+    };
+
+    // Connection event callbacks, indexed by UdcEventType
+    UdcEventHandler<UdcConnectionCallback> m_connectionHandlers[UDC_EVENT_RECEIVE_MESSAGE_IPV4];
+
+    UdcEventHandler<UdcMessageIPv4Callback> m_messageIPv4Handler;
+    UdcEventHandler<UdcMessageIPv6Callback> m_messageIPv6Handler;
+
+    // Number of clients pending connection
+    uint32_t m_pendingClientCount;
+
+    // True if connection events are delivered in the order of udcTryConnect() calls
+    bool m_orderedConnectionEvents;
 
-    // Maps device ID to connected clients
-    std::unordered_map<UdcEndPointId, std::shared_ptr<UdcClient>> m_clientsById;
+    // A pending client, and its connection result once it has one
+    struct UdcOrderedConnection
+    {
+        UdcEndPointId endPointId;
+        UdcEventType result;
+        bool resolved;
+        UdcAddressMux address; // the address the handshake came from
+    };
 
-    // Maps address to connected clients
-    UdcAddressMap<std::shared_ptr<UdcClient>> m_clientsByAddress;
+    // With ordered connection events, pending clients in the order of udcTryConnect() calls
+    // a client that has received its handshake stays pending here until every earlier client
+    // has a result, so none of its events can come before its connection event
+    std::deque<UdcOrderedConnection> m_connectionOrder;
 
-    // Maps address to client reliable states
-    UdcAddressMap<int> m_reliableStates;
+    // Connection events that are ready to be delivered
+    std::deque<UdcEvent> m_connectionEvents;
 
-    // Message Buffer
+    // Pending and connected clients
+    UdcEndPointTable m_clients;
+
+    // Maps address to connected client IDs
+    UdcAddressMap<UdcEndPointId> m_clientsByAddress;
+
+    // Maps address to the reliable state expected from it
+    UdcReliableStateTable m_reliableStates;
+
+    // Looks up addresses for udcTryConnect() and udcTryConnectAsync()
+    UdcResolver m_resolver;
+
+    // Lookups taken from the resolver, kept to reuse their storage
+    std::vector<UdcResolver::Result> m_resolvedAddresses;
+
+    // The sockets' receive event, nullptr until receiveEvent() has made the resolver signal it
+    UdcSocketEvent* m_receiveEvent;
+
+    // Every packet sent and received, see getStats()
+    UdcTrafficStats m_stats;
+    uint64_t m_signatureMismatches;
+    uint64_t m_malformedDrops;
+
+    static constexpr uint32_t NO_SLOT = 0xFFFFFFFFu;
+    static constexpr uint32_t NO_MESSAGE_LIMIT = 0xFFFFFFFFu;
+
+    // Message Buffer, the receive slot that the next message is received into
+    // nullptr while every slot is held
     uint8_t* m_messageBuffer;
-    uint32_t m_messageBufferSize;
+    uint32_t m_messageBufferSize; // the size of a slot
+
+    // Receive ring, the caller's buffer divided into slots
+    // a received message keeps its slot until the ring comes back around to it,
+    // or with manual release, until it is released
+    uint8_t* m_buffer;
+    uint32_t m_slotCount;
+    uint32_t m_currentSlot;
+    uint32_t m_messageLimit; // the messages that receivePackets() may still take a slot for
+    bool m_manualRelease;
+    std::vector<bool> m_heldSlots;
+    UdcRingQueue<uint32_t> m_freeSlots;
+
+    // Storage for queued reliable message payloads
+    UdcMessagePool m_messagePool;
+
+    // Messages submitted by other threads, nullptr until created
+    std::unique_ptr<UdcSendQueue> m_sendQueue;
+
+    // Groups of clients that are sent the same messages
+    UdcGroupTable m_groups;
+
+    // Addresses of the connected members of a group being sent to
+    std::vector<UdcAddressMux> m_groupAddresses;
+
+    // Endpoint deadlines, timer index = slot index * UDC_TIMER_COUNT + UdcTimer
+    // the wheel ticks in microseconds
+    UdcTimerWheel m_timers;
+
+    // Timers that have expired but haven't been handled yet
+    std::vector<uint32_t> m_expiredTimers;
+    uint32_t m_expiredIndex;
+
+    // Sends and timers produced by one maintenance worker
+    // applied by the updating thread once every worker has finished
+    struct UdcMaintenanceBatch
+    {
+        struct Send
+        {
+            UdcAddressMux address;
+            uint32_t headerOffset; // into headers
+            uint32_t headerSize;
+            const uint8_t* payload; // pooled reliable message, or nullptr
+            uint32_t payloadSize;
+        };
+
+        struct Reschedule
+        {
+            UdcEndPointId endPointId;
+            UdcTimer timer;
+            std::chrono::microseconds time;
+        };
+
+        std::vector<uint8_t> headers;
+        std::vector<Send> sends;
+        std::vector<Reschedule> timers;
+
+        // Workers count the packets of their own clients, and the server's are counted when the batch is sent
+        uint64_t retransmissions = 0;
+    };
+
+    // Expired timers are split into work items of this many timers
+    static constexpr uint32_t MAINTENANCE_ITEM_SIZE = 64;
+
+    // Maintenance workers, nullptr while timers are handled on the updating thread
+    std::unique_ptr<UdcWorkerPool> m_maintenancePool;
+
+    // One batch per worker, the first is also used by the updating thread
+    std::vector<UdcMaintenanceBatch> m_maintenanceBatches;
+
+    // Expired ping and reliable timers being handled by the maintenance workers
+    std::vector<uint32_t> m_maintenanceTimers;
+
+    // Processors that the maintenance workers are pinned to, one each in turn
+    UdcProcessorSet m_maintenanceProcessors;
+
+    // I/O thread, see startIoThread()
+    // m_ioMode is only written by the application while the I/O thread isn't running
+    bool m_ioMode;
+    std::atomic<bool> m_ioRunning;
+    std::chrono::microseconds m_ioPeriod;
+    std::chrono::microseconds m_ioSpinPeriod;
+    UdcProcessorSet m_ioProcessors;
+    std::thread m_ioThread;
+
+    // Signalled by queueMessage() to wake the I/O thread, set before it starts
+    // the socket event when it busy-polls, and m_ioSendEvent when it sleeps for the whole period
+    // nullptr if the socket event couldn't be created, so sends wait for the next pass
+    UdcSocketEvent* m_ioWakeEvent;
+    UdcSocketEvent m_ioSendEvent;
+
+    // Held by the I/O thread while it updates, and by the application while it changes endpoints
+    std::mutex m_stateMutex;
+
+    // I/O thread wait counters, see getIoWaitCounters()
+    std::atomic<uint64_t> m_ioSpins;
+    std::atomic<uint64_t> m_ioSleeps;
+    std::atomic<uint64_t> m_ioWakeups;
+
+    // Events from the I/O thread to the application
+    std::unique_ptr<UdcSpscQueue<UdcEvent>> m_ioEvents;
+
+    // Slots that the application has finished with, from the application to the I/O thread
+    std::unique_ptr<UdcSpscQueue<uint32_t>> m_ioReleasedSlots;
+
+    // Application side, the last event taken and the slots waiting to be passed to the I/O thread,
+    // which are the slots of messages returned in the last call, or released ones
+    UdcEvent m_ioEventBuffer;
+    std::vector<uint32_t> m_ioReturnedSlots;
+
+    // Application side, the slots of messages that the application holds with manual release
+    std::vector<bool> m_ioHeldSlots;
+
+    // Send a packet, counted for the server and for endPointStats unless it's nullptr
+    // the message id is read from the packet's header
+    void sendPacket(const UdcAddressMux& address, const uint8_t* data, uint32_t size, UdcTrafficStats* endPointStats);
+
+    // Send a packet gathered from segments, the first of which is the header
+    void sendPacket(const UdcAddressMux& address, const UdcSegment* segments, uint32_t segmentCount, UdcTrafficStats* endPointStats);
+
+    // Returns true if a received packet is the right size for its message id
+    [[nodiscard]]
+    static bool hasValidSize(UdcMessageId msgId, uint32_t msgSize);
 
     void processConnectionRequest(const UdcAddressMux& fromAddress);
 
     [[nodiscard]]
-    const UdcEvent* processConnectionHandshake(const UdcAddressMux& fromAddress, std::chrono::milliseconds time);
+    const UdcEvent* processConnectionHandshake(const UdcAddressMux& fromAddress, std::chrono::microseconds time);
 
     void processPing(const UdcAddressMux& fromAddress);
 
     [[nodiscard]]
-    const UdcEvent* processPong(const UdcAddressMux& fromAddress, std::chrono::milliseconds time);
+    const UdcEvent* processPong(const UdcAddressMux& fromAddress, std::chrono::microseconds time);
+
+    // Receive messages for receiveMessages(), until there is an event to return or m_messageLimit runs out
+    [[nodiscard]]
+    const UdcEvent* receivePackets(std::chrono::microseconds time);
+
+    // The sockets' receive event, created on first use, or nullptr if it can't be
+    // the resolver is given it once, so that a finished lookup wakes a waiting application
+    [[nodiscard]]
+    UdcSocketEvent* receiveEvent();
+
+    // Move on to the next free slot, or to NO_SLOT if every slot is held
+    void selectFreeSlot();
+
+    // Free a held slot
+    // returns false if the slot isn't held
+    bool freeSlot(uint32_t slot);
+
+    void runIoThread();
+
+    // One pass of the I/O thread
+    // returns false if it stopped receiving because the events or the slots were full
+    [[nodiscard]]
+    bool updateIo(std::chrono::microseconds time);
+
+    // Wait between passes of the I/O thread, see setIoBusyPoll()
+    // a queued message ends the wait
+    void waitForIo(bool receiving);
+
+    // Returns true if the send queue has a message to send, only called by the thread that sends them
+    [[nodiscard]]
+    bool hasQueuedMessage() const;
+
+    // Hand the slots of the messages returned in the last call, and of released messages, back to the I/O thread
+    void returnIoSlots();
+
+    // Record the slot of a message event taken by the application
+    void trackIoMessage(uint32_t slot);
+
+    // Set the event buffer to a received message in the current slot, and move on to the next slot
+    // returns nullptr if the message was passed to a callback
+    // client is the sender, or nullptr if it isn't an endpoint
+    [[nodiscard]]
+    const UdcEvent* deliverMessage(const UdcAddressMux& fromAddress, UdcClient* client, uint32_t headerSize, uint32_t msgSize);
 
     [[nodiscard]]
     const UdcEvent* processUnreliable(const UdcAddressMux& fromAddress, uint32_t msgSize);
 
     [[nodiscard]]
-    const UdcEvent* processReliableMessage(int state, const UdcAddressMux& fromAddress, uint32_t size);
+    const UdcEvent* processReliableMessage(int state, const UdcAddressMux& fromAddress, uint32_t size, std::chrono::microseconds time);
+
+    [[nodiscard]]
+    const UdcEvent* processReliableHandshake(int state, const UdcAddressMux& fromAddress, std::chrono::microseconds time);
+
+    [[nodiscard]]
+    bool tryGetClient(UdcEndPointId clientId, UdcClient& client);
+
+    [[nodiscard]]
+    bool tryGetClient(const UdcAddressMux& address, UdcClient& client);
+
+
+    // Return all of the client's queued reliable messages to the message pool
+    void releaseReliableMessages(UdcClient client);
+
+    // Set the event buffer to a connection event
+    [[nodiscard]]
+    const UdcEvent* connectionEvent(UdcEventType eventType, UdcEndPointId endPointId);
+
+    // Set the connection result of a pending client in the connection order
+    // returns the next ready connection event
+    [[nodiscard]]
+    const UdcEvent* resolveOrderedConnection(
+        UdcEndPointId endPointId,
+        UdcEventType result,
+        const UdcAddressMux& fromAddress,
+        std::chrono::microseconds time);
 
     [[nodiscard]]
-    const UdcEvent* processReliableHandshake(int state, const UdcAddressMux& fromAddress, std::chrono::milliseconds time);
+    const UdcEvent* updateConnectionAttempt(UdcClient client, std::chrono::microseconds time);
+
+    // Give resolving clients the addresses that have been looked up since the last update
+    void applyResolvedAddresses(std::chrono::microseconds time);
 
+    // Pick the address to connect to first, from a family that there's a socket for
+    // returns true and sets alternate if there's one for the other family as well
     [[nodiscard]]
-    bool tryGetClient(UdcEndPointId clientId, UdcClient** client);
+    bool chooseAddresses(const UdcResolver::Addresses& addresses, UdcAddressMux& address, UdcAddressMux& alternate) const;
+
+    // Ping and reliable timers only change their own client, and write their sends to a batch
+    // so that they can be handled on any maintenance worker
+    void updatePing(UdcClient client, std::chrono::microseconds time, UdcMaintenanceBatch& batch) const;
+
+    void updateReliable(UdcClient client, std::chrono::microseconds time, UdcMaintenanceBatch& batch) const;
+
+    // Handle the expired ping and reliable timers on the maintenance workers
+    // and remove them from the expired timers
+    void updateMaintenanceTimers(std::chrono::microseconds time);
+
+    // Send and schedule everything in a batch, and clear it
+    void applyMaintenanceBatch(UdcMaintenanceBatch& batch);
 
     [[nodiscard]]
-    bool tryGetClient(const UdcAddressMux& address, UdcClient** client);
+    const UdcEvent* updateConnectionLost(UdcClient client, std::chrono::microseconds time);
+
+    void scheduleTimer(UdcEndPointId endPointId, UdcTimer timer, std::chrono::microseconds time);
+
+    void cancelTimer(UdcEndPointId endPointId, UdcTimer timer);
+
+    void cancelTimers(UdcEndPointId endPointId);
+
+    // Finish connecting a pending client that has received its handshake
+    void completeConnection(UdcClient client, const UdcAddressMux& fromAddress, std::chrono::microseconds time);
+
+    // Remove a pending client that has timed out
+    void removeTimedOutClient(UdcClient client);
+
+    // Move results from the front of the connection order to the ready events
+    // connections are completed as they are released
+    void releaseOrderedConnections(std::chrono::microseconds time);
 
+    // Get the next ready connection event, or nullptr if there are none
     [[nodiscard]]
-    bool tryGetFirstPendingClient(UdcClient** client);
+    const UdcEvent* popConnectionEvent();
 };
 
 #endif
@@ -0,0 +1,154 @@
+// udp-connect
+// Kyle J Burgess
+
+#ifndef UDC_SHARED_INBOX_H
+#define UDC_SHARED_INBOX_H
+
+#include "udp_connect.h"
+#include "UdcAddressMux.h"
+#include "UdcProcess.h"
+#include "UdcSharedMemory.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// UdcSharedInbox
+// Datagrams sent to a local port through shared memory instead of the UDP stack
+//
+// an inbox is named after the family and port of the socket it stands in for, since an IPv4 socket
+// and an IPv6 socket can be bound to the same port by different servers
+// the inbox of a port holds CHANNEL_COUNT rings, and each port that sends to it claims one,
+// so a ring has one writer and one reader and neither waits on the other
+// each datagram carries the family and port it was sent from, so the reader sees
+// the same source address as if it had come over the loopback interface
+// the inbox names the receiver's process, since senders keep the memory alive after a receiver
+// that crashed, which never marks it closed
+class UdcSharedInbox
+{
+public:
+
+    static constexpr uint32_t CHANNEL_COUNT = 16;
+    static constexpr uint32_t CHANNEL_SIZE = 1u << 18;
+    static constexpr uint32_t MAX_DATAGRAM_SIZE = 65535;
+
+    UdcSharedInbox();
+
+    ~UdcSharedInbox();
+
+    UdcSharedInbox(const UdcSharedInbox&) = delete;
+
+    UdcSharedInbox& operator=(const UdcSharedInbox&) = delete;
+
+    // The name of the event that senders signal when a port's inbox has datagrams, see UdcSocketEvent
+    [[nodiscard]]
+    static std::string eventName(UdcAddressFamily family, uint16_t port);
+
+    // Create the inbox of a local port to receive from
+    // datagrams left in a previous inbox for the port are discarded, and an inbox whose receiver's process
+    // has exited is taken over
+    // returns false if another running server already receives from the inbox
+    [[nodiscard]]
+    bool create(UdcAddressFamily family, uint16_t port);
+
+    // Open the inbox of another local port, and claim a channel for fromPort of the same family to send from
+    // returns false if the port has no inbox for the family, its receiver's process has exited,
+    // or every channel is claimed
+    [[nodiscard]]
+    bool open(UdcAddressFamily family, uint16_t port, uint16_t fromPort);
+
+    // Release the channel, or mark the inbox closed if this created it
+    void close();
+
+    // Sender only
+    // Returns false once the receiver has closed the inbox
+    [[nodiscard]]
+    bool isOpen() const;
+
+    // Sender only
+    // Returns false once the receiver's process has exited, which asks the system,
+    // so it's checked less often than isOpen()
+    [[nodiscard]]
+    bool receiverRunning() const;
+
+    // Sender only
+    // Append a datagram gathered from segments, that the receiver sees as sent from a loopback address
+    // of family with port
+    // returns false if the channel doesn't have room, as if the receiver's socket buffer were full
+    // wake is set if the channel was empty, and the receiver's event needs to be signalled
+    [[nodiscard]]
+    bool push(UdcAddressFamily family, uint16_t port, const UdcSegment* segments, uint32_t segmentCount, bool& wake);
+
+    // Receiver only
+    // Take the next datagram from any channel
+    // returns false when there are none, and skips datagrams larger than size
+    [[nodiscard]]
+    bool pop(UdcAddressFamily& family, uint16_t& port, uint8_t* buffer, uint32_t& size);
+
+    // Receiver only
+    [[nodiscard]]
+    bool empty() const;
+
+    // Receiver only
+    // Number of datagrams that pop() skipped for being too large
+    [[nodiscard]]
+    uint64_t oversizedDrops() const;
+
+protected:
+
+    static constexpr uint32_t MAGIC = 0x55444332; // "UDC2", changed with the layout
+    static constexpr uint32_t WRAP = ~0u;         // the rest of the ring is skipped
+
+    // Every datagram starts with a record, and the next one starts at a multiple of 8 bytes
+    struct Record
+    {
+        uint32_t size;
+        uint16_t port;
+        uint8_t family;
+        uint8_t reserved;
+    };
+
+    // The indices count bytes written and read, and wrap at 2^32
+    struct Channel
+    {
+        alignas(64) std::atomic<uint32_t> owner; // the sender's port + 1, 0 if unclaimed
+        alignas(64) std::atomic<uint32_t> tail;  // written by the sender
+        alignas(64) std::atomic<uint32_t> head;  // written by the receiver
+        alignas(64) uint8_t data[CHANNEL_SIZE];
+    };
+
+    // The magic is stored last when the memory is new, so the receiver is set once it's seen
+    struct Layout
+    {
+        std::atomic<uint32_t> magic;
+        std::atomic<uint32_t> closed;
+        std::atomic<uint32_t> receiverId;        // claimed by the server taking the inbox over
+        std::atomic<uint64_t> receiverStartTime;
+        Channel channels[CHANNEL_COUNT];
+    };
+
+    static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared atomics must not need a lock");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared atomics must not need a lock");
+
+    UdcSharedMemory m_memory;
+    Layout* m_layout;
+
+    // The sender's channel, nullptr for the receiver
+    Channel* m_channel;
+
+    // Sender only, the process that received from the inbox when it was opened
+    UdcProcess m_receiver;
+
+    // The receiver starts each pop() after the channel it last took from, so that no sender is starved
+    uint32_t m_nextChannel;
+
+    uint64_t m_oversizedDrops;
+
+    [[nodiscard]]
+    static std::string memoryName(UdcAddressFamily family, uint16_t port);
+
+    [[nodiscard]]
+    static uint32_t recordSize(uint32_t size);
+};
+
+#endif
@@ -5,14 +5,19 @@
 #define UDC_SOCKET_MUX_H
 
 #include "UdcSocket.h"
+#include "UdcSocketEvent.h"
 #include "UdcAddressMux.h"
 #include "UdcPacketLogger.h"
+#include "UdcSharedInbox.h"
 
+#include <chrono>
 #include <vector>
 #include <memory>
+#include <unordered_map>
 
 // UdcSocketMux
 // Manages sending and receiving UDP packets on IPv4 and IPv6
+// and, once enableSharedMemory() is called, exchanges them with servers on the same host through shared memory
 class UdcSocketMux
 {
 public:
@@ -38,9 +43,23 @@ public:
     // Send a message
     bool send(const UdcAddressIPv6& address, uint16_t port, const uint8_t* data, uint32_t size) const;
 
+    // Send a message gathered from at most UdcSocket::MAX_SEGMENTS segments
+    bool send(const UdcAddressMux& address, const UdcSegment* segments, uint32_t segmentCount) const;
+
+    // Send a message gathered from at most UdcSocket::MAX_SEGMENTS segments
+    bool send(const UdcAddressIPv4& address, uint16_t port, const UdcSegment* segments, uint32_t segmentCount) const;
+
+    // Send a message gathered from at most UdcSocket::MAX_SEGMENTS segments
+    bool send(const UdcAddressIPv6& address, uint16_t port, const UdcSegment* segments, uint32_t segmentCount) const;
+
+    // Send the same message, gathered from at most UdcSocket::MAX_SEGMENTS segments, to every address
+    // returns false if sending to any address failed
+    bool send(const UdcAddressMux* addresses, uint32_t addressCount, const UdcSegment* segments, uint32_t segmentCount) const;
+
     // Receive messages from the connected port and
     // returns false when there are no messages to receive
-    // ignores messages that are larger than maxMessageSize
+    // drops messages that are larger than size, see oversizedDrops()
+    // resets the receive event before the first message after returning false
     [[nodiscard]]
     bool receive(
         UdcAddressMux& address,
@@ -49,7 +68,7 @@ public:
 
     // Receive messages from the connected port and
     // returns false when there are no messages to receive
-    // ignores messages that are larger than maxMessageSize
+    // drops messages that are larger than size
     [[nodiscard]]
     bool receive(
         UdcAddressIPv4& address,
@@ -59,7 +78,7 @@ public:
 
     // Receive messages from the connected port and
     // returns false when there are no messages to receive
-    // ignores messages that are larger than maxMessageSize
+    // drops messages that are larger than size
     [[nodiscard]]
     bool receive(
         UdcAddressIPv6& address,
@@ -67,17 +86,100 @@ public:
         uint8_t* buffer,
         uint32_t& size);
 
-    // Manually closes the socket
+    // Manually closes the socket, and the shared memory inbox
     void disconnect();
 
     // Checks connection status
     [[nodiscard]]
     bool isConnected() const;
 
+    // Checks if there's a socket to send to an address family from
+    [[nodiscard]]
+    bool isBound(UdcAddressFamily family) const;
+
+    // An event that's signalled when a bound socket has a packet to receive
+    // created by the first call, and watches sockets bound afterwards too
+    // returns nullptr if it can't be created
+    [[nodiscard]]
+    UdcSocketEvent* receiveEvent();
+
+    // Send packets to a loopback address through the inbox of the port they're sent to, if it has one,
+    // and receive packets from other ports through an inbox of its own, named after the IPv4 port,
+    // or the IPv6 port if only IPv6 is bound, so packets are only sent through an inbox of their own family
+    // the receiver sees the same source address either way, so the protocol above doesn't change
+    // must be called after binding and before receiveEvent(), which then also signals the inbox
+    // returns false on failure
+    [[nodiscard]]
+    bool enableSharedMemory();
+
+    // Number of packets sent and received through shared memory
+    [[nodiscard]]
+    uint64_t sharedSent() const;
+
+    [[nodiscard]]
+    uint64_t sharedReceived() const;
+
+    // Number of received packets that were dropped for being larger than the receive buffer
+    [[nodiscard]]
+    uint64_t oversizedDrops() const;
+
 protected:
+
+    // The inbox of a local port that packets are sent to
+    struct SharedPeer
+    {
+        std::unique_ptr<UdcSharedInbox> inbox; // nullptr if the port has no inbox
+        std::unique_ptr<UdcSocketEvent> event;
+        std::chrono::steady_clock::time_point retryTime; // when to look for the inbox again
+    };
+
+    static constexpr std::chrono::seconds SHARED_RETRY_PERIOD = std::chrono::seconds(1);
+
     std::vector<UdcSocket> m_socketIPv4;
     std::vector<UdcSocket> m_socketIPv6;
     std::unique_ptr<UdcPacketLogger> m_logger;
+
+    // Every bound socket, for the receive event to watch
+    std::vector<const UdcSocket*> m_receiveSockets;
+
+    // See receiveEvent(), m_receiveEventReset is true from resetting it until the sockets are empty
+    std::unique_ptr<UdcSocketEvent> m_receiveEvent;
+    bool m_receiveEventReset;
+
+    // The ports of the first socket of each family, which packets through shared memory are sent from
+    uint16_t m_portIPv4;
+    uint16_t m_portIPv6;
+
+    // See enableSharedMemory(), the sockets and the inbox take turns to be received from first
+    // peers are keyed by family << 16 | port
+    std::unique_ptr<UdcSharedInbox> m_sharedInbox;
+    mutable std::unordered_map<uint32_t, SharedPeer> m_sharedPeers;
+    mutable uint64_t m_sharedSent;
+    uint64_t m_sharedReceived;
+    bool m_receiveSharedFirst;
+
+    uint64_t m_oversizedDrops;
+
+    // Rebuild m_receiveSockets after binding or disconnecting
+    void updateReceiveSockets();
+
+    // Make receiveEvent watch the sockets and signal it, and use it as m_receiveEvent
+    [[nodiscard]]
+    bool setReceiveEvent(std::unique_ptr<UdcSocketEvent> receiveEvent);
+
+    // Send to a loopback port through its inbox
+    // returns false if it has no inbox and the packet should be sent with UDP, and otherwise sets sent
+    [[nodiscard]]
+    bool trySendShared(UdcAddressFamily family, uint16_t port, const UdcSegment* segments, uint32_t segmentCount, bool& sent) const;
+
+    [[nodiscard]]
+    bool receiveShared(UdcAddressMux& address, uint8_t* buffer, uint32_t& size);
+
+    [[nodiscard]]
+    static bool isLoopback(const UdcAddressIPv4& address);
+
+    [[nodiscard]]
+    static bool isLoopback(const UdcAddressIPv6& address);
 };
 
 #endif
@@ -0,0 +1,101 @@
+// udp-connect
+// Kyle J Burgess
+
+#ifndef UDC_SPSC_QUEUE_H
+#define UDC_SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+// UdcSpscQueue
+// Bounded lock-free FIFO queue between one producer thread and one consumer thread
+// the producer only writes the tail and the consumer only writes the head,
+// so neither side waits on the other
+template<class T>
+class UdcSpscQueue
+{
+public:
+
+    // capacity is rounded up to a power of two
+    explicit UdcSpscQueue(uint32_t capacity)
+        : m_mask(0)
+        , m_head(0)
+        , m_tail(0)
+    {
+        uint32_t size = 1;
+
+        while (size < capacity)
+        {
+            size *= 2;
+        }
+
+        m_items = std::make_unique<T[]>(size);
+        m_mask = size - 1;
+    }
+
+    UdcSpscQueue(const UdcSpscQueue&) = delete;
+
+    UdcSpscQueue& operator=(const UdcSpscQueue&) = delete;
+
+    // Number of queued items, either side can call it but it may be stale
+    [[nodiscard]]
+    uint32_t size() const
+    {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
+    // Producer only
+    [[nodiscard]]
+    bool full() const
+    {
+        return m_tail.load(std::memory_order_relaxed) - m_head.load(std::memory_order_acquire) > m_mask;
+    }
+
+    // Producer only
+    // returns false if the queue is full
+    [[nodiscard]]
+    bool tryPush(const T& item)
+    {
+        uint32_t tail = m_tail.load(std::memory_order_relaxed);
+
+        if (tail - m_head.load(std::memory_order_acquire) > m_mask)
+        {
+            return false;
+        }
+
+        m_items[tail & m_mask] = item;
+        m_tail.store(tail + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    // Consumer only
+    // returns false if the queue is empty
+    [[nodiscard]]
+    bool tryPop(T& item)
+    {
+        uint32_t head = m_head.load(std::memory_order_relaxed);
+
+        if (head == m_tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        item = m_items[head & m_mask];
+        m_head.store(head + 1, std::memory_order_release);
+
+        return true;
+    }
+
+protected:
+
+    std::unique_ptr<T[]> m_items;
+    uint32_t m_mask;
+
+    // The consumer's and producer's positions are on separate cache lines
+    alignas(64) std::atomic<uint32_t> m_head;
+    alignas(64) std::atomic<uint32_t> m_tail;
+};
+
+#endif
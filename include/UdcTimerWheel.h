@@ -0,0 +1,91 @@
+// udp-connect
+// Kyle J Burgess
+
+#ifndef UDC_TIMER_WHEEL_H
+#define UDC_TIMER_WHEEL_H
+
+#include <cstdint>
+#include <vector>
+
+// UdcTimerWheel
+// Hierarchical timer wheel
+// timers are identified by a caller-chosen index and scheduled at an absolute tick,
+// advance() only touches the slots that have expired, so the cost of a pass
+// depends on the number of expired timers rather than the number of timers
+class UdcTimerWheel
+{
+public:
+
+    explicit UdcTimerWheel(uint64_t currentTick);
+
+    // Make room for timer indices [0, timerCount)
+    void resize(uint32_t timerCount);
+
+    // Schedule (or reschedule) a timer
+    // deadlines at or before the current tick expire on the next advance()
+    void schedule(uint32_t timer, uint64_t deadline);
+
+    // Stop a timer if it's scheduled
+    void cancel(uint32_t timer);
+
+    // Returns true if the timer is scheduled
+    [[nodiscard]]
+    bool scheduled(uint32_t timer) const;
+
+    // Move the wheel to tick now and append every expired timer to expired
+    // expired timers are no longer scheduled
+    void advance(uint64_t now, std::vector<uint32_t>& expired);
+
+    // The current tick
+    [[nodiscard]]
+    uint64_t currentTick() const;
+
+    // A tick at or before the earliest deadline, exact when it's in the current block of SLOTS ticks
+    // advancing to it may expire nothing, then the next deadline is nearer and more exact
+    // returns NEVER if no timers are scheduled
+    [[nodiscard]]
+    uint64_t nextDeadline() const;
+
+    static constexpr uint64_t NEVER = ~0ull;
+
+protected:
+
+    static constexpr uint32_t LEVEL_BITS = 6;
+    static constexpr uint32_t SLOTS = 1u << LEVEL_BITS;
+    static constexpr uint32_t LEVELS = 6;
+    static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+    // Slot index of the due list (timers scheduled at or before the current tick)
+    static constexpr uint32_t DUE = LEVELS * SLOTS;
+
+    uint64_t m_currentTick;
+    uint32_t m_count;
+
+    // Per-level bitmask of slots that hold at least one timer
+    uint64_t m_occupied[LEVELS];
+
+    // First timer in each slot (and the due list)
+    uint32_t m_heads[LEVELS * SLOTS + 1];
+
+    // Per-timer state
+    std::vector<uint64_t> m_deadlines;
+    std::vector<uint32_t> m_next;
+    std::vector<uint32_t> m_prev;
+    std::vector<uint32_t> m_slots;
+
+    void link(uint32_t timer);
+
+    void unlink(uint32_t timer);
+
+    // Move every timer in a slot into the list of expired timers
+    void expireSlot(uint32_t slot, std::vector<uint32_t>& expired);
+
+    // Redistribute the timers of the higher level slots that begin at the current tick
+    void cascade();
+
+    // The next tick at which cascade() will move timers, used to skip empty blocks
+    [[nodiscard]]
+    uint64_t nextCascadeTick() const;
+};
+
+#endif
@@ -0,0 +1,78 @@
+// udp-connect
+// Kyle J Burgess
+
+#ifndef UDC_TRAFFIC_STATS_H
+#define UDC_TRAFFIC_STATS_H
+
+#include "udp_connect.h"
+#include "UdcMessage.h"
+
+#include <cstdint>
+
+// UdcTrafficStats
+// Packet counters of a server or an endpoint, see udcGetStats()
+// they're plain integers written only by the thread that owns the server or endpoint,
+// so counting a packet costs a couple of increments
+struct UdcTrafficStats
+{
+    uint64_t packetsSent[UDC_STATS_PACKET_COUNT];
+    uint64_t bytesSent[UDC_STATS_PACKET_COUNT];
+    uint64_t packetsReceived[UDC_STATS_PACKET_COUNT];
+    uint64_t bytesReceived[UDC_STATS_PACKET_COUNT];
+    uint64_t retransmissions;
+    uint64_t duplicatesDropped;
+
+    void countSent(UdcMessageId msgId, uint32_t size)
+    {
+        auto packet = packetOf(msgId);
+        ++packetsSent[packet];
+        bytesSent[packet] += size;
+    }
+
+    void countReceived(UdcMessageId msgId, uint32_t size)
+    {
+        auto packet = packetOf(msgId);
+        ++packetsReceived[packet];
+        bytesReceived[packet] += size;
+    }
+
+    // Copy the counters into the matching fields of stats, leaving the rest
+    void copyTo(UdcStats& stats) const
+    {
+        for (uint32_t i = 0; i != UDC_STATS_PACKET_COUNT; ++i)
+        {
+            stats.packetsSent[i] = packetsSent[i];
+            stats.bytesSent[i] = bytesSent[i];
+            stats.packetsReceived[i] = packetsReceived[i];
+            stats.bytesReceived[i] = bytesReceived[i];
+        }
+
+        stats.retransmissions = retransmissions;
+        stats.duplicatesDropped = duplicatesDropped;
+    }
+
+    // The kind of packet a message id is counted as
+    [[nodiscard]]
+    static UdcStatsPacket packetOf(UdcMessageId msgId)
+    {
+        switch (msgId)
+        {
+            case UDC_MSG_CONNECTION_REQUEST:
+            case UDC_MSG_CONNECTION_HANDSHAKE:
+                return UDC_STATS_CONNECTION;
+            case UDC_MSG_PING:
+            case UDC_MSG_PONG:
+                return UDC_STATS_PING;
+            case UDC_MSG_UNRELIABLE:
+                return UDC_STATS_UNRELIABLE;
+            case UDC_MSG_RELIABLE_RESET:
+            case UDC_MSG_RELIABLE_0:
+            case UDC_MSG_RELIABLE_1:
+                return UDC_STATS_RELIABLE;
+            default:
+                return UDC_STATS_ACK;
+        }
+    }
+};
+
+#endif
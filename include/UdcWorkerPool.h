@@ -0,0 +1,91 @@
+// udp-connect
+// Kyle J Burgess
+
+#ifndef UDC_WORKER_POOL_H
+#define UDC_WORKER_POOL_H
+
+#include "UdcThreadPlacement.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// UdcWorkerPool
+// Threads that process a range of work items together with the calling thread
+//
+// the items are divided evenly between the workers, and a worker that finishes its own items
+// takes the remaining items of the other workers one at a time, so uneven items don't leave
+// workers idle; items are claimed with an atomic increment of the owner's next item
+class UdcWorkerPool
+{
+public:
+
+    static constexpr uint32_t MAX_WORKERS = 64;
+
+    // workerCount includes the calling thread, and must be between 1 and MAX_WORKERS
+    // with a non-empty processor set, each thread is pinned to one of its processors in turn
+    explicit UdcWorkerPool(uint32_t workerCount, UdcProcessorSet processors = {});
+
+    ~UdcWorkerPool();
+
+    UdcWorkerPool(const UdcWorkerPool&) = delete;
+
+    UdcWorkerPool& operator=(const UdcWorkerPool&) = delete;
+
+    [[nodiscard]]
+    uint32_t workerCount() const;
+
+    // Call work(worker, item) once for every item in [0, itemCount)
+    // returns once every item has been processed, the calling thread is worker 0
+    template<typename Work>
+    void run(uint32_t itemCount, Work& work)
+    {
+        run(itemCount, [](void* context, uint32_t worker, uint32_t item)
+        {
+            (*static_cast<Work*>(context))(worker, item);
+        }, &work);
+    }
+
+protected:
+
+    using WorkFunction = void (*)(void* context, uint32_t worker, uint32_t item);
+
+    // The items owned by a worker, on its own cache line
+    struct alignas(64) Range
+    {
+        std::atomic<uint32_t> next;
+        uint32_t end;
+    };
+
+    uint32_t m_workerCount;
+    UdcProcessorSet m_processors;
+    std::unique_ptr<Range[]> m_ranges;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_start;
+    std::condition_variable m_done;
+
+    // Incremented for every run, the threads wait for it to change
+    uint64_t m_generation;
+
+    // Number of threads still processing the current run
+    uint32_t m_busy;
+    bool m_stopping;
+
+    WorkFunction m_function;
+    void* m_context;
+
+    void run(uint32_t itemCount, WorkFunction function, void* context);
+
+    void runThread(uint32_t worker);
+
+    // Process the worker's own items, then steal from the others
+    void processItems(uint32_t worker);
+};
+
+#endif
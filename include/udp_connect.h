@@ -11,18 +11,15 @@ extern "C"
     // A local server
     struct                  UdcServer;
 
-    // An event
-    struct                  UdcEvent;
-
     // Types of events
     enum                    UdcEventType   : uint32_t
     {
         // A connection attempt has succeeded
-        // *these events will happen in the order of udcTryConnect() calls
+        // *these events only happen in the order of udcTryConnect() calls with udcSetOrderedConnectionEvents()
         UDC_EVENT_CONNECTION_SUCCESS   = 0u,
 
         // A connection attempt has timed out (failed)
-        // *these events will happen in the order of udcTryConnect() calls
+        // *these events only happen in the order of udcTryConnect() calls with udcSetOrderedConnectionEvents()
         UDC_EVENT_CONNECTION_TIMEOUT   = 1u,
 
         // A connection was abnormally lost, the endpoint connection will continue trying to connect
@@ -55,9 +52,76 @@ extern "C"
         UDC_RELIABLE_MESSAGE           = 1u,
     };
 
+    // How the slots of a receive ring are reused, see udcCreateServerRing()
+    enum                    UdcRingMode    : uint32_t
+    {
+        // A message keeps its slot until the ring comes back around to it,
+        // so its payload stays valid for the next (slotCount - 1) received messages
+        UDC_RING_RECYCLE               = 0u,
+
+        // A message keeps its slot until udcReleaseMessage() is called
+        // while every slot is held, no messages are received
+        UDC_RING_MANUAL_RELEASE        = 1u,
+    };
+
+    // Threads run by the server, see udcSetThreadAffinity()
+    enum                    UdcThreadRole  : uint32_t
+    {
+        // The thread started by udcStartIoThread()
+        UDC_THREAD_IO                  = 0u,
+
+        // The threads started by udcSetMaintenanceThreads()
+        UDC_THREAD_MAINTENANCE         = 1u,
+    };
+
+    // Kinds of packet counted separately by udcGetStats()
+    enum                    UdcStatsPacket : uint32_t
+    {
+        // Connection requests and handshakes
+        UDC_STATS_CONNECTION           = 0u,
+
+        // Pings and pongs
+        UDC_STATS_PING                 = 1u,
+
+        // Unreliable messages
+        UDC_STATS_UNRELIABLE           = 2u,
+
+        // Reliable messages, including resends and resets of the reliable state
+        UDC_STATS_RELIABLE             = 3u,
+
+        // Acknowledgements of reliable messages
+        UDC_STATS_ACK                  = 4u,
+
+        // The number of kinds
+        UDC_STATS_PACKET_COUNT         = 5u,
+    };
+
     // A locally unique identifier for a node
+    // 0 is never a valid endpoint ID
+    // IDs are reused, but only after 4095 other endpoints have held the same slot
     typedef uint32_t        UdcEndPointId;
 
+    // A locally unique identifier for a group of endpoints
+    // 0 is never a valid group ID
+    typedef uint32_t        UdcGroupId;
+
+    // A segment of a message sent with udcSendMessageV()
+    struct                  UdcSegment
+    {
+        const uint8_t* data;
+        uint32_t size;
+    };
+
+    // Limits of the API
+    enum                    UdcLimits      : uint32_t
+    {
+        // The maximum number of segments in a message sent with udcSendMessageV()
+        UDC_MAX_MESSAGE_SEGMENTS       = 15u,
+
+        // Returned by udcGetNextTimeout() when nothing is scheduled
+        UDC_NO_TIMEOUT                 = 0xFFFFFFFFu,
+    };
+
     // Message signature
     struct                  UdcSignature
     {
@@ -79,6 +143,69 @@ extern "C"
         uint16_t segments[8];
     };
 
+    // An event
+    // the fields can be read directly, or with udcGetEventType() and the udcGetResult... functions
+    struct                  UdcEvent
+    {
+        UdcEventType eventType;
+        UdcEndPointId endPointId;    // The endpoint of a connection event, or the sender of a message event
+                                     // 0 if the sender of a message isn't a connected endpoint
+
+        union
+        {
+            UdcAddressIPv4 addressIPv4;
+            UdcAddressIPv6 addressIPv6;
+        };                           // The sender of a message event
+
+        uint16_t port;               // The port of the sender of a message event
+        uint32_t msgIndex;           // The index of a message event's payload in the server buffer
+        uint32_t msgSize;            // The size of a message event's payload in bytes
+        void* context;               // The context of the sender of a message event, see udcSetEndPointContext()
+    };
+
+    // Counters of a server or one of its endpoints, see udcGetStats()
+    // packets and bytes are indexed by UdcStatsPacket, and bytes include the headers
+    struct                  UdcStats
+    {
+        uint64_t packetsSent[UDC_STATS_PACKET_COUNT];     // Packets handed to the socket
+        uint64_t bytesSent[UDC_STATS_PACKET_COUNT];
+        uint64_t packetsReceived[UDC_STATS_PACKET_COUNT]; // Packets with the server's signature and a valid size
+        uint64_t bytesReceived[UDC_STATS_PACKET_COUNT];
+        uint64_t retransmissions;    // Reliable messages sent again because they weren't acknowledged in time
+        uint64_t duplicatesDropped;  // Reliable messages received again, which are acknowledged and dropped
+        uint64_t signatureMismatches; // Packets with another signature (server only)
+        uint64_t oversizedDrops;     // Packets larger than a message slot (server only)
+        uint64_t malformedDrops;     // Packets of an unknown kind, or the wrong size for their kind (server only)
+        uint32_t reliableQueued;     // Reliable messages waiting to be sent or acknowledged
+        uint32_t sendQueueDepth;     // Messages waiting in the send queue, see udcCreateSendQueue() (server only)
+        uint32_t eventQueueDepth;    // Events from the I/O thread waiting to be processed (server only)
+    };
+
+    // Called for a connection event, see udcSetConnectionCallback()
+    typedef void (__cdecl*  UdcConnectionCallback)(
+        void*                  context,      // The context given with the callback
+        UdcEndPointId          endPointId);  // The endpoint of the event
+
+    // Called for a received message (IPv4), see udcSetMessageIPv4Callback()
+    typedef void (__cdecl*  UdcMessageIPv4Callback)(
+        void*                  context,      // The context given with the callback
+        UdcEndPointId          endPointId,   // The endpoint that sent the message, or 0 if it isn't connected
+        void*                  endPointContext, // The context of the endpoint, see udcSetEndPointContext()
+        const UdcAddressIPv4&  address,      // The IPv4 address of the sender
+        uint16_t               port,         // The port of the sender
+        uint32_t               msgIndex,     // The first byte of the message in the message buffer
+        uint32_t               msgSize);     // The size in bytes of the message in the message buffer
+
+    // Called for a received message (IPv6), see udcSetMessageIPv6Callback()
+    typedef void (__cdecl*  UdcMessageIPv6Callback)(
+        void*                  context,      // The context given with the callback
+        UdcEndPointId          endPointId,   // The endpoint that sent the message, or 0 if it isn't connected
+        void*                  endPointContext, // The context of the endpoint, see udcSetEndPointContext()
+        const UdcAddressIPv6&  address,      // The IPv6 address of the sender
+        uint16_t               port,         // The port of the sender
+        uint32_t               msgIndex,     // The first byte of the message in the message buffer
+        uint32_t               msgSize);     // The size in bytes of the message in the message buffer
+
     // Returns the minimum size of the message buffer (in bytes)
     // that needs to be given to udcCreateServer()
     uint32_t        __cdecl udcGetMinimumBufferSize();
@@ -94,6 +221,25 @@ extern "C"
         uint32_t               size,         // The size of buffer (in bytes)
         const char*            logFileName); // Nullptr for no debugging, or the name of a message log file for debugging
 
+    // Creates a local server that receives messages into a ring of slots, see udcCreateServer
+    // the buffer is divided into slotCount slots of (size / slotCount) bytes,
+    // and each received message has its own slot, so payloads can be handed off without copying
+    // the slot size is the largest message that can be sent or received
+    // returns nullptr if it fails to connect, or if the slots are smaller than udcGetMinimumBufferSize()
+    UdcServer*      __cdecl udcCreateServerRing(
+        UdcSignature           signature,    // A custom signature that recognizes packets as valid
+        uint8_t*               buffer,       // The handle to a buffer that holds the slots
+        uint32_t               size,         // The size of buffer (in bytes)
+        uint32_t               slotCount,    // The number of slots
+        UdcRingMode            mode,         // How slots are reused
+        const char*            logFileName); // Nullptr for no debugging, or the name of a message log file for debugging
+
+    // Release the slot of a received message on a server created with UDC_RING_MANUAL_RELEASE
+    // returns false if the message's slot isn't held
+    bool            __cdecl udcReleaseMessage(
+        UdcServer*             server,       // The local server
+        uint32_t               msgIndex);    // The msgIndex of the message event
+
     // Stops and deletes a server
     void            __cdecl udcDeleteServer(
         UdcServer*             server);      // Delete a server and frees any memory associated with the server
@@ -112,6 +258,26 @@ extern "C"
         UdcServer*             server,       // The server to bind the port on
         uint16_t               port);        // The port to bind
 
+    // Exchange messages with servers on the same host through shared memory instead of UDP
+    // messages sent to a loopback address (127.x.x.x or ::1) go through the shared memory of the port
+    // they're sent to, if the server on it has also enabled this for that family, and connections,
+    // reliable messages and events work as they do over UDP
+    // only the first IPv4 port is received through shared memory, or the first IPv6 port if there's no IPv4
+    // call after binding, and before udcGetEventHandle(), udcWaitEvents() and udcStartIoThread(),
+    // which create the event that the server waits on
+    // if the receiving process exits without deleting its server, senders go back to UDP
+    // and a new server on the port takes its shared memory over
+    // returns false on failure, or if another running server on the host receives that port's shared memory,
+    // and messages keep going through UDP
+    bool            __cdecl udcEnableSharedMemory(
+        UdcServer*             server);      // The server to enable shared memory on
+
+    // Get the number of messages sent and received through shared memory
+    void            __cdecl udcGetSharedMemoryCounters(
+        UdcServer*             server,       // The local server
+        uint64_t&              sent,         // The number of messages sent through shared memory
+        uint64_t&              received);    // The number of messages received through shared memory
+
     // Try to parse a node and service null-terminated string into an IPv4 address and port number
     // returns true on success
     bool            __cdecl udcTryParseAddressIPv4(
@@ -133,6 +299,9 @@ extern "C"
     // Timeout also represents the amount of time that the server can receive no messages (including ping tests)
     // from the client before calling UDC_EVENT_CONNECTION_LOST and trying to reestablish a connection.
     // A connection lost event does not clear the reliable message queue.
+    // When the name resolves to both IPv6 and IPv4 and the server is bound to both, connection requests
+    // go to IPv6 first and to IPv4 shortly after, and the first family to answer is kept with a single
+    // UDC_EVENT_CONNECTION_SUCCESS.
     // Returns false immediately if it fails to connect to port
     bool            __cdecl udcTryConnect(
         UdcServer*             server,       // The local server to connect from
@@ -142,6 +311,27 @@ extern "C"
         UdcEndPointId&         endPointId);  // The returned endpoint ID matched with udcGetResultConnectionEvent
                                              // for monitoring UDC_EVENT_CONNECTION_SUCCESS or UDC_EVENT_CONNECTION_TIMEOUT
 
+    // Try to connect to a client from a server without waiting for the name to be looked up
+    // the name is resolved on a resolver thread, and connection attempts start once it's known
+    // a name that can't be resolved ends with UDC_EVENT_CONNECTION_TIMEOUT after the timeout
+    // See udcTryConnect for details
+    bool            __cdecl udcTryConnectAsync(
+        UdcServer*             server,       // The local server to connect from
+        const char*            nodeName,     // The null-terminated node name or ip address to connect to
+        const char*            serviceName,  // The null-terminated service name or port to connect to
+        uint32_t               timeout,      // The timeout (ms) for the connection, including the lookup
+        UdcEndPointId&         endPointId);  // The returned endpoint ID matched with udcGetResultConnectionEvent
+                                             // for monitoring UDC_EVENT_CONNECTION_SUCCESS or UDC_EVENT_CONNECTION_TIMEOUT
+
+    // Set how long udcTryConnect and udcTryConnectAsync remember looked up names
+    // names that resolved are kept for positiveTtl, and names that didn't for negativeTtl
+    // 0 doesn't cache that kind of result, the defaults are 60000 and 5000
+    // setting these forgets every cached name
+    void            __cdecl udcSetResolverCache(
+        UdcServer*             server,       // The local server
+        uint32_t               positiveTtl,  // How long (ms) a resolved name is cached
+        uint32_t               negativeTtl); // How long (ms) a name that didn't resolve is cached
+
     // Try to connect to a client from a server using an IPv4 address
     // See udcTryConnect for details
     bool            __cdecl udcTryConnectIPv4(
@@ -162,6 +352,15 @@ extern "C"
         UdcEndPointId&         endPointId);  // The returned endpoint ID matched with udcGetResultConnectionEvent
                                              // for monitoring UDC_EVENT_CONNECTION_SUCCESS or UDC_EVENT_CONNECTION_TIMEOUT
 
+    // Deliver connection success and timeout events in the order of udcTryConnect() calls
+    // connections are always attempted in parallel, but when ordered, an endpoint that has
+    // connected is held pending until every endpoint before it has connected or timed out
+    // the default is unordered, where each event happens as soon as its connection resolves
+    // returns false if there are endpoints pending connection
+    bool            __cdecl udcSetOrderedConnectionEvents(
+        UdcServer*             server,       // The local server
+        bool                   ordered);     // Whether connection events are ordered
+
     // Returns true for a connected client and sets the ping,
     // otherwise returns false
     bool            __cdecl udcGetStatus(
@@ -169,11 +368,65 @@ extern "C"
         UdcEndPointId          id,           // The endpoint to check the status of
         uint32_t&              ping);        // The ping time (ms) of the connection, or 0 if not connected
 
+    // Returns true for a connected client and sets the ping in microseconds,
+    // otherwise returns false
+    bool            __cdecl udcGetStatusMicroseconds(
+        UdcServer*             server,       // The local server
+        UdcEndPointId          id,           // The endpoint to check the status of
+        uint32_t&              ping);        // The ping time (us) of the connection, or 0 if not connected
+
     // Manually disconnect from an endpoint and clear the reliable message queue
     void            __cdecl udcDisconnect(
         UdcServer*             server,
         UdcEndPointId          endPointId);
 
+    // Set a context that is passed back with every message received from an endpoint
+    // so that the application doesn't need to look up the sender by its address
+    // returns false if the endpoint doesn't exist
+    bool            __cdecl udcSetEndPointContext(
+        UdcServer*             server,       // The local server
+        UdcEndPointId          endPointId,   // The endpoint
+        void*                  context);     // The context, nullptr when an endpoint is created
+
+    // Get how far an endpoint is through its reliable messages
+    // a reliable message has been acknowledged once acknowledged reaches the sum of both values
+    // read straight after sending it
+    // returns false if the endpoint doesn't exist
+    bool            __cdecl udcGetReliableProgress(
+        UdcServer*             server,       // The local server
+        UdcEndPointId          endPointId,   // The endpoint
+        uint64_t&              acknowledged, // [out] The number of reliable messages acknowledged since connecting
+        uint32_t&              queued);      // [out] The number of reliable messages waiting to be acknowledged
+
+    // Limit the reliable message state that is kept for remote addresses
+    // when capacity addresses have state, the least recently used address is forgotten,
+    // and an address is forgotten after idleTimeout without receiving a reliable message from it
+    // the idle timeout must be longer than the remote's timeout (see udcTryConnect),
+    // otherwise a retransmitted message may be received twice
+    // the defaults are 65536 addresses and 60000 ms
+    // returns false if capacity or idleTimeout is 0
+    bool            __cdecl udcSetReliableStateLimits(
+        UdcServer*             server,       // The local server
+        uint32_t               capacity,     // The maximum number of addresses
+        uint32_t               idleTimeout); // The time (ms) that an idle address is kept
+
+    // Get metrics of the reliable message state kept for remote addresses
+    void            __cdecl udcGetReliableStateMetrics(
+        UdcServer*             server,       // The local server
+        uint32_t&              size,         // The number of addresses with state
+        uint64_t&              evictions,    // The number of addresses forgotten because capacity was reached
+        uint64_t&              expirations); // The number of addresses forgotten because they were idle
+
+    // Get the counters of a server since it was created, or of an endpoint since it was created
+    // the server's counters include packets from addresses that aren't endpoints
+    // the counters are kept without atomics by the thread that updates the server,
+    // so they're read between updates, or under the I/O thread's lock
+    // returns false if endPointId isn't 0 and the endpoint doesn't exist
+    bool            __cdecl udcGetStats(
+        UdcServer*             server,       // The local server
+        UdcEndPointId          endPointId,   // The endpoint, or 0 for the whole server
+        UdcStats&              stats);       // [out] The counters
+
     // Send a message
     // returns false if the provided buffer is too small
     // or if the endPointId doesn't exist
@@ -184,11 +437,229 @@ extern "C"
         uint32_t               size,         // The size of the message in bytes
         UdcMessageType         reliability); // The type of message
 
+    // Send a message made of segments, in order
+    // unreliable messages are sent straight from the segments, and reliable messages
+    // are copied once into the send queue, instead of having to be concatenated first
+    // returns false if the provided buffer is too small for the whole message,
+    // if there are more than UDC_MAX_MESSAGE_SEGMENTS segments,
+    // or if the endPointId doesn't exist
+    bool            __cdecl udcSendMessageV(
+        UdcServer*             server,       // The local server to send from
+        UdcEndPointId          endPointId,   // The endpoint ID of the client (connected)
+        const UdcSegment*      segments,     // The segments of the message
+        uint32_t               segmentCount, // The number of segments
+        UdcMessageType         reliability); // The type of message
+
+    // Handle pings and reliable message (re)sends on threadCount threads, including the thread that
+    // processes events, so that a server with many endpoints can use several cores
+    // the endpoints with expired timers are split between the threads, which steal work from each
+    // other, and each thread's sends are merged and sent by the processing thread
+    // 0 or 1 handles everything on the processing thread (the default)
+    // returns false if threadCount is larger than 64
+    bool            __cdecl udcSetMaintenanceThreads(
+        UdcServer*             server,       // The local server
+        uint32_t               threadCount); // The number of threads, including the processing thread
+
+    // Pin the threads of a role to a set of processors, so that a busy server stays on one NUMA node
+    // - the I/O thread is pinned to the whole set, and moves the endpoint table into memory on its node
+    //   when it starts (see udcReserveEndPoints)
+    // - each maintenance thread is pinned to one processor of the set in turn, skipping the first,
+    //   which is left to the processing thread; running maintenance threads are restarted
+    // a processorMask of 0 lets the threads run on any processor
+    // returns false if the I/O thread is running, or role is unknown
+    bool            __cdecl udcSetThreadAffinity(
+        UdcServer*             server,       // The local server
+        UdcThreadRole          role,         // The threads to pin
+        uint16_t               processorGroup,// The processor group of the processors
+        uint64_t               processorMask);// The processors within the group
+
+    // Make room for count endpoints, so that connecting doesn't allocate
+    // call before udcStartIoThread() so that the whole table is moved to the I/O thread's node
+    // returns false if count is larger than 1048576
+    bool            __cdecl udcReserveEndPoints(
+        UdcServer*             server,       // The local server
+        uint32_t               count);       // The number of endpoints
+
+    // Allocate a buffer for udcCreateServer() or udcCreateServerRing() on the NUMA node
+    // of the first processor in a set, so that the I/O thread receives into local memory
+    // a processorMask of 0 allocates on any node
+    // returns nullptr on failure
+    uint8_t*        __cdecl udcAllocateBuffer(
+        uint32_t               size,         // The size of the buffer in bytes
+        uint16_t               processorGroup,// The processor group of the processors
+        uint64_t               processorMask);// The processors within the group
+
+    // Free a buffer from udcAllocateBuffer(), after the server using it has been deleted
+    void            __cdecl udcFreeBuffer(
+        uint8_t*               buffer);      // The buffer
+
+    // Start a thread owned by the server that sends, receives, acknowledges, pings and retransmits
+    // every period, however often the application processes events
+    // while it runs:
+    // - udcProcessEvents() and udcProcessEventsBatch() take the events that the thread has queued,
+    //   calling callbacks on the calling thread
+    // - a message's payload stays valid until the next call, or until udcReleaseMessage()
+    //   with UDC_RING_MANUAL_RELEASE; the thread can't receive while every slot is held,
+    //   so use udcCreateServerRing() with enough slots for the messages of a frame
+    // - udcSendMessage() and udcSendMessageV() queue the message as if by udcQueueMessage(),
+    //   so they only fail if the send queue is full or the message is too large;
+    //   a queued message wakes the thread, so it's sent without waiting for the period
+    // - while eventCapacity events are waiting to be taken, or every slot is in use, the thread
+    //   stops receiving and sleeps for the period at a time
+    // - the other functions lock the server against the thread
+    // returns false if the thread is already running, or eventCapacity is 0 or larger than 1048576
+    bool            __cdecl udcStartIoThread(
+        UdcServer*             server,       // The local server
+        uint32_t               eventCapacity,// The number of events that can wait to be processed, and the
+                                             // capacity of the send queue if there isn't one (see udcCreateSendQueue)
+        uint32_t               period);      // The time (us) between updates of the thread
+
+    // Stop the I/O thread, events that haven't been processed are discarded
+    // also called by udcDeleteServer()
+    void            __cdecl udcStopIoThread(
+        UdcServer*             server);      // The local server
+
+    // Get a handle that's signalled when udcProcessEvents() has packets to receive, or has finished
+    // looking up a name for udcTryConnectAsync(), so that an application's own event loop can wait on it
+    // together with udcGetNextTimeout() instead of polling
+    // on Windows it's a manual-reset WSAEVENT that can be waited on with WaitForMultipleObjects(),
+    // it's reset by udcProcessEvents() and mustn't be reset by the application
+    // after the handle is signalled, call udcProcessEvents() until it returns nullptr
+    // returns nullptr while the I/O thread is running, or if the handle can't be created
+    void*           __cdecl udcGetEventHandle(
+        UdcServer*             server);      // The local server
+
+    // Get the time (us) until udcProcessEvents() needs to be called to send connection requests,
+    // pings and retransmissions, or 0 if there is work to do now
+    // returns UDC_NO_TIMEOUT if nothing is scheduled, and 0 while the I/O thread is running
+    uint32_t        __cdecl udcGetNextTimeout(
+        UdcServer*             server);      // The local server
+
+    // Block until the handle from udcGetEventHandle() is signalled, or until udcGetNextTimeout()
+    // or timeout passes, for applications without their own event loop
+    // returns true if udcProcessEvents() has work to do, or false if the timeout passed without any
+    bool            __cdecl udcWaitEvents(
+        UdcServer*             server,       // The local server
+        uint32_t               timeout);     // The longest time (us) to wait
+
+    // Make the I/O thread busy-poll its sockets for up to spinPeriod after each update, and then
+    // sleep until a packet arrives, a message is queued or the period passes, rather than sleeping for the whole period
+    // a packet that arrives soon after the last one is received without waking a sleeping thread,
+    // while an idle server only spins for spinPeriod out of every period
+    // a spinPeriod of 0 (the default) sleeps for the whole period, unless a message is queued
+    // returns false if the I/O thread is running
+    bool            __cdecl udcSetIoBusyPoll(
+        UdcServer*             server,       // The local server
+        uint32_t               spinPeriod);  // The time (us) to busy-poll after each update
+
+    // Get counters of how the I/O thread has waited with udcSetIoBusyPoll()
+    void            __cdecl udcGetIoWaitCounters(
+        UdcServer*             server,       // The local server
+        uint64_t&              spins,        // The number of waits that found a packet while spinning
+        uint64_t&              sleeps,       // The number of waits that went to sleep
+        uint64_t&              wakeups);     // The number of sleeps that were ended by a packet or a queued message
+
+    // Create a queue that messages can be submitted to from any thread with udcQueueMessage()
+    // queued messages are sent at the start of udcProcessEvents() and udcProcessEventsBatch(),
+    // by the thread that processes events
+    // must be called before any thread queues a message
+    // returns false if the server already has a send queue, or capacity is 0 or larger than 1048576
+    bool            __cdecl udcCreateSendQueue(
+        UdcServer*             server,       // The local server
+        uint32_t               capacity);    // The number of messages that can wait to be sent (rounded up to a power of two)
+
+    // Queue a message to be sent as if by udcSendMessage(), can be called from any thread
+    // the message is copied, so data can be reused as soon as this returns
+    // messages to endpoints that no longer exist when they are sent are dropped
+    // returns false if there is no send queue, it's full, or the message is too large
+    bool            __cdecl udcQueueMessage(
+        UdcServer*             server,       // The local server to send from
+        UdcEndPointId          endPointId,   // The endpoint to send to
+        const uint8_t*         data,         // The message
+        uint32_t               size,         // The size of the message in bytes
+        UdcMessageType         reliability); // The type of message
+
+    // Create an empty group of endpoints that can be sent the same messages
+    // returns false if no more groups can be created
+    bool            __cdecl udcCreateGroup(
+        UdcServer*             server,       // The local server
+        UdcGroupId&            groupId);     // The returned group ID
+
+    // Delete a group, its endpoints stay connected
+    // returns false if the groupId doesn't exist
+    bool            __cdecl udcDeleteGroup(
+        UdcServer*             server,       // The local server
+        UdcGroupId             groupId);     // The group to delete
+
+    // Add a pending or connected endpoint to a group
+    // a disconnected endpoint is removed from its groups the next time they are sent to
+    // returns false if the groupId or endPointId doesn't exist, or if the endpoint is already in the group
+    bool            __cdecl udcAddToGroup(
+        UdcServer*             server,       // The local server
+        UdcGroupId             groupId,      // The group
+        UdcEndPointId          endPointId);  // The endpoint to add
+
+    // Remove an endpoint from a group
+    // returns false if the groupId doesn't exist or the endpoint isn't in the group
+    bool            __cdecl udcRemoveFromGroup(
+        UdcServer*             server,       // The local server
+        UdcGroupId             groupId,      // The group
+        UdcEndPointId          endPointId);  // The endpoint to remove
+
+    // Send a message to every endpoint in a group, as if by udcSendMessage() to each of them
+    // an unreliable message is serialized once and sent to every connected endpoint,
+    // and a reliable message is copied once and shared by every endpoint's send queue
+    // returns false if the provided buffer is too small or if the groupId doesn't exist
+    bool            __cdecl udcSendMessageGroup(
+        UdcServer*             server,       // The local server to send from
+        UdcGroupId             groupId,      // The group to send to
+        const uint8_t*         data,         // The message
+        uint32_t               size,         // The size of the message in bytes
+        UdcMessageType         reliability); // The type of message
+
+    // Call a function for every connection event of a type, instead of returning the events
+    // the callback is called from inside udcProcessEvents() and udcProcessEventsBatch()
+    // returns false if eventType isn't a connection event
+    bool            __cdecl udcSetConnectionCallback(
+        UdcServer*             server,       // The local server
+        UdcEventType           eventType,    // UDC_EVENT_CONNECTION_SUCCESS, _TIMEOUT, _LOST or _REGAINED
+        UdcConnectionCallback  callback,     // The function to call, or nullptr to return the events again
+        void*                  context);     // Passed to the callback
+
+    // Call a function for every received IPv4 message, instead of returning the events
+    // the callback is called as each message is received, and receiving carries on after it returns
+    // the payload stays valid as it would for a returned event (see udcCreateServerRing)
+    // the callback can send messages, but must not process events
+    void            __cdecl udcSetMessageIPv4Callback(
+        UdcServer*             server,       // The local server
+        UdcMessageIPv4Callback callback,     // The function to call, or nullptr to return the events again
+        void*                  context);     // Passed to the callback
+
+    // Call a function for every received IPv6 message, instead of returning the events
+    // see udcSetMessageIPv4Callback()
+    void            __cdecl udcSetMessageIPv6Callback(
+        UdcServer*             server,       // The local server
+        UdcMessageIPv6Callback callback,     // The function to call, or nullptr to return the events again
+        void*                  context);     // Passed to the callback
+
     // Main update loop
+    // events with a callback are passed to it and not returned
     // every frame, call udcProcessEvents() until nullptr is returned
     const UdcEvent* __cdecl udcProcessEvents(
         UdcServer*             server);      // The local server
 
+    // Main update loop, returning events in batches
+    // timers are updated once, then messages are received, until capacity events have been copied
+    // into events or there are no more events
+    // the payload of every message event in the batch stays valid until the next call,
+    // so a batch holds at most as many messages as the server has slots (see udcCreateServerRing),
+    // counting those passed to a message callback
+    // every frame, call udcProcessEventsBatch() until 0 is returned
+    uint32_t        __cdecl udcProcessEventsBatch(
+        UdcServer*             server,       // The local server
+        UdcEvent*              events,       // The returned events
+        uint32_t               capacity);    // The maximum number of events to return
+
     // Get the type of event that was returned by udcProcessEvents()
     UdcEventType    __cdecl udcGetEventType(
         const UdcEvent*        event);       // The event
@@ -220,6 +691,14 @@ extern "C"
         uint16_t&              port,         // The port of the sender
         uint32_t&              msgIndex,     // The first byte of the message in the message buffer
         uint32_t&              msgSize);     // The size in bytes of the message in the message buffer
+
+    // Get the endpoint that sent a message
+    // UDC_EVENT_RECEIVE_MESSAGE_IPV4
+    // UDC_EVENT_RECEIVE_MESSAGE_IPV6
+    bool            __cdecl udcGetResultMessageEndPoint(
+        const UdcEvent*        event,        // The event
+        UdcEndPointId&         endPointId,   // The endpoint that sent the message, or 0 if it isn't connected
+        void*&                 context);     // The context of the endpoint, see udcSetEndPointContext()
 }
 
 #endif
@@ -0,0 +1,53 @@
+// udp-connect
+// Kyle J Burgess
+
+#ifndef UDC_PROCESS_H
+#define UDC_PROCESS_H
+
+#include <cstdint>
+
+#ifdef OS_WINDOWS
+#include <winsock2.h>
+#endif
+
+// UdcProcess
+// A process on the host, held open to tell whether it's still running
+// a process is named by its id and its start time, since ids are reused once a process exits
+class UdcProcess
+{
+public:
+
+    UdcProcess();
+
+    ~UdcProcess();
+
+    UdcProcess(const UdcProcess&) = delete;
+
+    UdcProcess& operator=(const UdcProcess&) = delete;
+
+    // The id of the calling process
+    [[nodiscard]]
+    static uint32_t currentId();
+
+    // The start time of the calling process, in the platform's units
+    [[nodiscard]]
+    static uint64_t currentStartTime();
+
+    // Open a process
+    // returns false if no process has the id, or the one that has it isn't the one that started at startTime
+    [[nodiscard]]
+    bool open(uint32_t id, uint64_t startTime);
+
+    void close();
+
+    // Returns false once the process has exited, or if none is open
+    [[nodiscard]]
+    bool running() const;
+
+protected:
+#ifdef OS_WINDOWS
+    HANDLE m_process;
+#endif
+};
+
+#endif
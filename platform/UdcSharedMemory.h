@@ -0,0 +1,52 @@
+// udp-connect
+// Kyle J Burgess
+
+#ifndef UDC_SHARED_MEMORY_H
+#define UDC_SHARED_MEMORY_H
+
+#include <cstdint>
+#include <string>
+
+#ifdef OS_WINDOWS
+#include <winsock2.h>
+#endif
+
+// UdcSharedMemory
+// A named block of memory that every process on the host can map
+// a new block is zeroed, and it's freed when the last process closes it
+class UdcSharedMemory
+{
+public:
+
+    UdcSharedMemory();
+
+    ~UdcSharedMemory();
+
+    UdcSharedMemory(const UdcSharedMemory&) = delete;
+
+    UdcSharedMemory& operator=(const UdcSharedMemory&) = delete;
+
+    // Create the block, or map it if another process already created it, which sets existed
+    // returns false on failure
+    [[nodiscard]]
+    bool create(const std::string& name, uint32_t size, bool& existed);
+
+    // Map a block that another process created
+    // returns false if there's no block with the name
+    [[nodiscard]]
+    bool open(const std::string& name, uint32_t size);
+
+    void close();
+
+    // The mapped memory, nullptr if nothing is mapped
+    [[nodiscard]]
+    uint8_t* data() const;
+
+protected:
+#ifdef OS_WINDOWS
+    HANDLE m_mapping;
+#endif
+    uint8_t* m_data;
+};
+
+#endif
@@ -19,6 +19,9 @@ class UdcSocket
 {
 public:
 
+    // Maximum number of segments in a gathered packet, a header and the message segments
+    static constexpr uint32_t MAX_SEGMENTS = UDC_MAX_MESSAGE_SEGMENTS + 1;
+
     // Constructor
     UdcSocket();
 
@@ -70,6 +73,11 @@ public:
     // automatically called by destructor
     void disconnect();
 
+    // The local port of a bound socket, which the platform chose if the socket was bound to port 0
+    // returns 0 if the socket isn't bound
+    [[nodiscard]]
+    uint16_t localPort() const;
+
     // Send a packet over IPv4
     // returns true on success
     [[nodiscard]]
@@ -80,6 +88,16 @@ public:
     [[nodiscard]]
     bool sendIPv6(const UdcAddressIPv6& address, uint16_t port, const uint8_t* data, uint32_t size) const;
 
+    // Send a packet over IPv4, gathered from at most MAX_SEGMENTS segments
+    // returns true on success
+    [[nodiscard]]
+    bool sendIPv4(const UdcAddressIPv4& address, uint16_t port, const UdcSegment* segments, uint32_t segmentCount) const;
+
+    // Send a packet over IPv6, gathered from at most MAX_SEGMENTS segments
+    // returns true on success
+    [[nodiscard]]
+    bool sendIPv6(const UdcAddressIPv6& address, uint16_t port, const UdcSegment* segments, uint32_t segmentCount) const;
+
     // Receive packets on a port bound with localBindIPv4
     // returns 1 on success
     // returns 0 if there are no messages left to receive
@@ -97,6 +115,8 @@ public:
     int32_t receiveIPv6(UdcAddressIPv6& sourceIP, uint16_t& port, uint8_t* buffer, uint32_t& size) const;
 
 protected:
+    friend class UdcSocketEvent;
+
 #ifdef OS_WINDOWS
     SOCKET m_socket;
 #endif
@@ -0,0 +1,64 @@
+// udp-connect
+// Kyle J Burgess
+
+#ifndef UDC_SOCKET_EVENT_H
+#define UDC_SOCKET_EVENT_H
+
+#include "UdcSocket.h"
+
+#include <chrono>
+#include <string>
+
+#ifdef OS_WINDOWS
+#include <winsock2.h>
+#endif
+
+// UdcSocketEvent
+// A handle that an application can wait on, signalled when a watched socket
+// has a packet to receive, or when signal() is called
+// it stays signalled until reset(), which must be done before receiving so that no packet is missed
+class UdcSocketEvent
+{
+public:
+
+    UdcSocketEvent();
+
+    // Create an event that other processes on the host can signal, or open it if one already exists
+    explicit UdcSocketEvent(const std::string& name);
+
+    ~UdcSocketEvent();
+
+    UdcSocketEvent(const UdcSocketEvent&) = delete;
+
+    UdcSocketEvent& operator=(const UdcSocketEvent&) = delete;
+
+    // Returns true if the event was created
+    [[nodiscard]]
+    bool isValid() const;
+
+    // Signal the event whenever a socket has a packet to receive
+    // returns true on success
+    [[nodiscard]]
+    bool watch(const UdcSocket& socket);
+
+    // Signal the event from any thread
+    void signal();
+
+    void reset();
+
+    // Block until the event is signalled, or the timeout passes
+    // returns true if the event is signalled
+    [[nodiscard]]
+    bool wait(std::chrono::microseconds timeout) const;
+
+    // The platform's handle for the event
+    [[nodiscard]]
+    void* handle() const;
+
+protected:
+#ifdef OS_WINDOWS
+    WSAEVENT m_event;
+#endif
+};
+
+#endif
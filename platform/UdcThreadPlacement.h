@@ -0,0 +1,35 @@
+// udp-connect
+// Kyle J Burgess
+
+#ifndef UDC_THREAD_PLACEMENT_H
+#define UDC_THREAD_PLACEMENT_H
+
+#include <cstdint>
+
+// A set of processors within a processor group
+// an empty mask means any processor
+struct UdcProcessorSet
+{
+    uint16_t group;
+    uint64_t mask;
+};
+
+// Platform-specific placement of threads on processors, and of memory on NUMA nodes
+namespace UdcThreadPlacement
+{
+    // Restrict the calling thread to a set of processors
+    // returns false if the set is empty or the platform rejects it,
+    // and the thread keeps running on any processor
+    bool pinCurrentThread(const UdcProcessorSet& processors);
+
+    // Allocate memory backed by the NUMA node of the first processor in the set
+    // or by any node if the set is empty
+    // returns nullptr on failure
+    [[nodiscard]]
+    uint8_t* allocate(uint32_t size, const UdcProcessorSet& processors);
+
+    // Free memory from allocate()
+    void free(uint8_t* memory);
+}
+
+#endif
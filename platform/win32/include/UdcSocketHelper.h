@@ -80,6 +80,21 @@ namespace WinSock
     [[nodiscard]]
     bool sendPacketIPv6(SOCKET s, sockaddr_in6 address, const uint8_t* data, uint32_t size);
 
+    // Send a packet gathered from segments with WSASendTo
+    // returns true on success
+    [[nodiscard]]
+    bool sendPacket(SOCKET s, const sockaddr* address, int addressSize, const UdcSegment* segments, uint32_t segmentCount);
+
+    // Send a packet over IPv4, gathered from segments
+    // returns true on success
+    [[nodiscard]]
+    bool sendPacketIPv4(SOCKET s, sockaddr_in address, const UdcSegment* segments, uint32_t segmentCount);
+
+    // Send a packet over IPv6, gathered from segments
+    // returns true on success
+    [[nodiscard]]
+    bool sendPacketIPv6(SOCKET s, sockaddr_in6 address, const UdcSegment* segments, uint32_t segmentCount);
+
     // Receive a packet on an IPv4 port
     // tmpBuffer is a buffer for holding temporary packet memory with size = max size of received packet
     // returns 1 on success
@@ -0,0 +1,78 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcProcess.h"
+
+namespace
+{
+    // Returns 0 if the times can't be read
+    uint64_t processStartTime(HANDLE process)
+    {
+        FILETIME creation;
+        FILETIME exit;
+        FILETIME kernel;
+        FILETIME user;
+
+        if (!GetProcessTimes(process, &creation, &exit, &kernel, &user))
+        {
+            return 0;
+        }
+
+        return (static_cast<uint64_t>(creation.dwHighDateTime) << 32) | creation.dwLowDateTime;
+    }
+}
+
+UdcProcess::UdcProcess()
+    : m_process(nullptr)
+{}
+
+UdcProcess::~UdcProcess()
+{
+    close();
+}
+
+uint32_t UdcProcess::currentId()
+{
+    return static_cast<uint32_t>(GetCurrentProcessId());
+}
+
+uint64_t UdcProcess::currentStartTime()
+{
+    return processStartTime(GetCurrentProcess());
+}
+
+bool UdcProcess::open(uint32_t id, uint64_t startTime)
+{
+    close();
+
+    // Only enough access to wait on the process and read its times
+    m_process = OpenProcess(SYNCHRONIZE | PROCESS_QUERY_LIMITED_INFORMATION, FALSE, id);
+
+    if (m_process == nullptr)
+    {
+        return false;
+    }
+
+    if (processStartTime(m_process) != startTime)
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void UdcProcess::close()
+{
+    if (m_process != nullptr)
+    {
+        CloseHandle(m_process);
+        m_process = nullptr;
+    }
+}
+
+bool UdcProcess::running() const
+{
+    // The handle is signalled when the process exits
+    return m_process != nullptr && WaitForSingleObject(m_process, 0) == WAIT_TIMEOUT;
+}
@@ -0,0 +1,90 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcSharedMemory.h"
+
+namespace
+{
+    // Names are only shared within the logon session, so no privilege is needed to create them
+    std::string sessionName(const std::string& name)
+    {
+        return "Local\\" + name;
+    }
+}
+
+UdcSharedMemory::UdcSharedMemory()
+    : m_mapping(nullptr)
+    , m_data(nullptr)
+{}
+
+UdcSharedMemory::~UdcSharedMemory()
+{
+    close();
+}
+
+bool UdcSharedMemory::create(const std::string& name, uint32_t size, bool& existed)
+{
+    close();
+
+    // Backed by the paging file, and opened instead if it already exists
+    m_mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, size, sessionName(name).c_str());
+
+    if (m_mapping == nullptr)
+    {
+        return false;
+    }
+
+    existed = GetLastError() == ERROR_ALREADY_EXISTS;
+
+    m_data = static_cast<uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, size));
+
+    if (m_data == nullptr)
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+bool UdcSharedMemory::open(const std::string& name, uint32_t size)
+{
+    close();
+
+    m_mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, sessionName(name).c_str());
+
+    if (m_mapping == nullptr)
+    {
+        return false;
+    }
+
+    m_data = static_cast<uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, size));
+
+    if (m_data == nullptr)
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void UdcSharedMemory::close()
+{
+    if (m_data != nullptr)
+    {
+        UnmapViewOfFile(m_data);
+        m_data = nullptr;
+    }
+
+    if (m_mapping != nullptr)
+    {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+}
+
+uint8_t* UdcSharedMemory::data() const
+{
+    return m_data;
+}
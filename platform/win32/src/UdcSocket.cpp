@@ -250,6 +250,26 @@ bool UdcSocket::sendIPv6(const UdcAddressIPv6& address, uint16_t port, const uin
     return WinSock::sendPacketIPv6(m_socket, WinSock::createAddressIPv6(address, port), data, size);
 }
 
+bool UdcSocket::sendIPv4(const UdcAddressIPv4& address, uint16_t port, const UdcSegment* segments, uint32_t segmentCount) const
+{
+    if (m_socket == INVALID_SOCKET || segmentCount > MAX_SEGMENTS)
+    {
+        return false;
+    }
+
+    return WinSock::sendPacketIPv4(m_socket, WinSock::createAddressIPv4(address, port), segments, segmentCount);
+}
+
+bool UdcSocket::sendIPv6(const UdcAddressIPv6& address, uint16_t port, const UdcSegment* segments, uint32_t segmentCount) const
+{
+    if (m_socket == INVALID_SOCKET || segmentCount > MAX_SEGMENTS)
+    {
+        return false;
+    }
+
+    return WinSock::sendPacketIPv6(m_socket, WinSock::createAddressIPv6(address, port), segments, segmentCount);
+}
+
 int32_t UdcSocket::receiveIPv4(UdcAddressIPv4& sourceIP, uint16_t& port, uint8_t* buffer, uint32_t& size) const
 {
     if (m_socket == INVALID_SOCKET)
@@ -269,3 +289,22 @@ int32_t UdcSocket::receiveIPv6(UdcAddressIPv6& sourceIP, uint16_t& port, uint8_t
 
     return WinSock::receivePacketIPv6(m_socket, sourceIP, port, buffer, size);
 }
+
+uint16_t UdcSocket::localPort() const
+{
+    if (m_socket == INVALID_SOCKET)
+    {
+        return 0;
+    }
+
+    sockaddr_storage address = {};
+    int addressSize = sizeof(address);
+
+    if (getsockname(m_socket, reinterpret_cast<sockaddr*>(&address), &addressSize) == SOCKET_ERROR)
+    {
+        return 0;
+    }
+
+    // The port is in the same place for both families
+    return ntohs(reinterpret_cast<const sockaddr_in*>(&address)->sin_port);
+}
@@ -0,0 +1,61 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcSocketEvent.h"
+
+UdcSocketEvent::UdcSocketEvent()
+    : m_event(WSACreateEvent())
+{}
+
+// Manual reset and initially clear, the same as WSACreateEvent(), which also returns null on failure
+UdcSocketEvent::UdcSocketEvent(const std::string& name)
+    : m_event(CreateEventA(nullptr, TRUE, FALSE, ("Local\\" + name).c_str()))
+{}
+
+UdcSocketEvent::~UdcSocketEvent()
+{
+    if (m_event != WSA_INVALID_EVENT)
+    {
+        WSACloseEvent(m_event);
+    }
+}
+
+bool UdcSocketEvent::isValid() const
+{
+    return m_event != WSA_INVALID_EVENT;
+}
+
+bool UdcSocketEvent::watch(const UdcSocket& socket)
+{
+    if (m_event == WSA_INVALID_EVENT || socket.m_socket == INVALID_SOCKET)
+    {
+        return false;
+    }
+
+    // FD_READ is posted again after each receive while packets remain, so the event
+    // is set whenever there's something to receive, and the socket stays non-blocking
+    return WSAEventSelect(socket.m_socket, m_event, FD_READ) != SOCKET_ERROR;
+}
+
+void UdcSocketEvent::signal()
+{
+    WSASetEvent(m_event);
+}
+
+void UdcSocketEvent::reset()
+{
+    WSAResetEvent(m_event);
+}
+
+bool UdcSocketEvent::wait(std::chrono::microseconds timeout) const
+{
+    // Rounded up, so that the timeout has passed when this returns false
+    auto milliseconds = std::chrono::ceil<std::chrono::milliseconds>(timeout).count();
+
+    return WSAWaitForMultipleEvents(1, &m_event, FALSE, static_cast<DWORD>(milliseconds), FALSE) == WSA_WAIT_EVENT_0;
+}
+
+void* UdcSocketEvent::handle() const
+{
+    return m_event;
+}
@@ -2,6 +2,7 @@
 // Kyle J Burgess
 
 #include "UdcSocketHelper.h"
+#include "UdcSocket.h"
 
 #include <cassert>
 #include <stdexcept>
@@ -146,6 +147,47 @@ namespace WinSock
         return (r != SOCKET_ERROR) && (static_cast<uint32_t>(r) == size);
     }
 
+    bool sendPacket(SOCKET s, const sockaddr* address, int addressSize, const UdcSegment* segments, uint32_t segmentCount)
+    {
+        assert(segmentCount <= UdcSocket::MAX_SEGMENTS);
+
+        WSABUF buffers[UdcSocket::MAX_SEGMENTS];
+        uint32_t size = 0;
+
+        for (uint32_t i = 0; i != segmentCount; ++i)
+        {
+            // WSASendTo doesn't write to the buffers
+            buffers[i].buf = reinterpret_cast<CHAR*>(const_cast<uint8_t*>(segments[i].data));
+            buffers[i].len = segments[i].size;
+            size += segments[i].size;
+        }
+
+        DWORD sent = 0;
+
+        int r = WSASendTo(
+            s,
+            buffers,
+            segmentCount,
+            &sent,
+            0,
+            address,
+            addressSize,
+            nullptr,
+            nullptr);
+
+        return (r != SOCKET_ERROR) && (sent == size);
+    }
+
+    bool sendPacketIPv4(SOCKET s, sockaddr_in address, const UdcSegment* segments, uint32_t segmentCount)
+    {
+        return sendPacket(s, reinterpret_cast<sockaddr*>(&address), sizeof(address), segments, segmentCount);
+    }
+
+    bool sendPacketIPv6(SOCKET s, sockaddr_in6 address, const UdcSegment* segments, uint32_t segmentCount)
+    {
+        return sendPacket(s, reinterpret_cast<sockaddr*>(&address), sizeof(address), segments, segmentCount);
+    }
+
     int32_t receivePacketIPv4(SOCKET s, UdcAddressIPv4& sourceIP, uint16_t& sourcePort, uint8_t* buffer, uint32_t& size)
     {
         sockaddr_in ip;
@@ -0,0 +1,62 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcThreadPlacement.h"
+
+// GetNumaProcessorNodeEx() needs Windows 7
+#ifndef _WIN32_WINNT
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include <windows.h>
+
+namespace UdcThreadPlacement
+{
+    bool pinCurrentThread(const UdcProcessorSet& processors)
+    {
+        if (processors.mask == 0)
+        {
+            return false;
+        }
+
+        GROUP_AFFINITY affinity = {};
+        affinity.Mask = static_cast<KAFFINITY>(processors.mask);
+        affinity.Group = processors.group;
+
+        return SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr) != 0;
+    }
+
+    uint8_t* allocate(uint32_t size, const UdcProcessorSet& processors)
+    {
+        if (processors.mask == 0)
+        {
+            return static_cast<uint8_t*>(VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+        }
+
+        PROCESSOR_NUMBER processor = {};
+        processor.Group = processors.group;
+
+        while ((processors.mask & (uint64_t(1) << processor.Number)) == 0)
+        {
+            ++processor.Number;
+        }
+
+        USHORT node;
+
+        if (!GetNumaProcessorNodeEx(&processor, &node))
+        {
+            return nullptr;
+        }
+
+        return static_cast<uint8_t*>(VirtualAllocExNuma(
+            GetCurrentProcess(), nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, node));
+    }
+
+    void free(uint8_t* memory)
+    {
+        if (memory != nullptr)
+        {
+            VirtualFree(memory, 0, MEM_RELEASE);
+        }
+    }
+}
@@ -3,111 +3,206 @@
 
 #include "UdcClient.h"
 
-UdcClient::UdcClient(
-    UdcEndPointId endPointId,
-    const UdcAddressMux& outgoingAddress,
-    std::chrono::milliseconds pingPeriod,
-    std::chrono::milliseconds timeoutPeriod)
-    : m_id(endPointId)
-    , m_reliableState(0)
-    , m_isConnected(false)
-    , m_outgoingAddress(outgoingAddress)
-    , m_incomingAddress({})
-    , m_pingPeriod(pingPeriod)
-    , m_connectionTimeoutPeriod(timeoutPeriod)
-    , m_connectionLostPeriod(timeoutPeriod)
-    , m_connectionAttemptPeriod(pingPeriod)
-    , m_reliableTimeoutPeriod(timeoutPeriod)
-    , m_ping(0)
-    , m_pingLastSetTime(0)
-    , m_lastReceivedTime(0)
-    , m_reliableSentTime(0)
-    , m_firstConnectAttemptTime(0)
-    , m_prevConnectAttemptTime(0)
+#include <algorithm>
+
+UdcClient::UdcClient()
+    : m_table(nullptr)
+    , m_index(0)
+{}
+
+UdcClient::UdcClient(UdcEndPointTable* table, uint32_t index)
+    : m_table(table)
+    , m_index(index)
 {}
 
 UdcEndPointId UdcClient::id() const
 {
-    return m_id;
+    return (m_table->m_generation[m_index] << UdcEndPointTable::INDEX_BITS) | m_index;
 }
 
 int UdcClient::reliableState() const
 {
-    return m_reliableState;
+    return m_table->m_reliableState[m_index];
 }
 
 void UdcClient::setReliableState(int state)
 {
-    m_reliableState = state;
+    m_table->m_reliableState[m_index] = static_cast<int8_t>(state);
+}
+
+UdcRingQueue<UdcPooledMessage*>& UdcClient::reliableMessages()
+{
+    return m_table->m_reliableMessages[m_index];
+}
+
+uint64_t UdcClient::reliableAcknowledged() const
+{
+    return m_table->m_reliableAcknowledged[m_index];
+}
+
+void UdcClient::acknowledgeReliable()
+{
+    ++m_table->m_reliableAcknowledged[m_index];
 }
 
-std::queue<std::vector<uint8_t>>& UdcClient::reliableMessages()
+UdcTrafficStats& UdcClient::stats()
 {
-    return m_reliableMessages;
+    return m_table->m_stats[m_index];
 }
 
 bool UdcClient::connected() const
 {
-    return m_isConnected;
+    return (m_table->m_flags[m_index] & UdcEndPointTable::FLAG_CONNECTED) != 0;
+}
+
+bool UdcClient::pending() const
+{
+    return (m_table->m_flags[m_index] & UdcEndPointTable::FLAG_PENDING) != 0;
 }
 
-std::chrono::milliseconds UdcClient::ping() const
+std::chrono::microseconds UdcClient::ping() const
 {
-    return m_ping;
+    return m_table->m_ping[m_index];
 }
 
 const UdcAddressMux& UdcClient::outgoingAddress() const
 {
-    return m_outgoingAddress;
+    return m_table->m_outgoingAddress[m_index];
+}
+
+void* UdcClient::context() const
+{
+    return m_table->m_context[m_index];
+}
+
+void UdcClient::setContext(void* context)
+{
+    m_table->m_context[m_index] = context;
+}
+
+void UdcClient::startConnecting(std::chrono::microseconds time)
+{
+    m_table->m_firstConnectAttemptTime[m_index] = time;
+    m_table->m_prevConnectAttemptTime[m_index] = std::chrono::microseconds(0);
+}
+
+bool UdcClient::resolving() const
+{
+    return (m_table->m_flags[m_index] & UdcEndPointTable::FLAG_RESOLVING) != 0;
+}
+
+void UdcClient::startResolving()
+{
+    m_table->m_flags[m_index] |= UdcEndPointTable::FLAG_RESOLVING;
+}
+
+void UdcClient::finishResolving(const UdcAddressMux& address)
+{
+    m_table->m_flags[m_index] &= ~UdcEndPointTable::FLAG_RESOLVING;
+    m_table->m_outgoingAddress[m_index] = address;
+}
+
+void UdcClient::failResolving(std::chrono::microseconds time)
+{
+    m_table->m_flags[m_index] &= ~UdcEndPointTable::FLAG_RESOLVING;
+    m_table->m_firstConnectAttemptTime[m_index] = time - m_table->m_timeoutPeriod[m_index];
+}
+
+void UdcClient::setAlternateAddress(const UdcAddressMux& address)
+{
+    m_table->m_flags[m_index] |= UdcEndPointTable::FLAG_RACING;
+    m_table->m_flags[m_index] &= ~UdcEndPointTable::FLAG_RACE_STARTED;
+    m_table->m_alternateAddress[m_index] = address;
+}
+
+const UdcAddressMux& UdcClient::alternateAddress() const
+{
+    return m_table->m_alternateAddress[m_index];
+}
+
+bool UdcClient::raceStarted() const
+{
+    return (m_table->m_flags[m_index] & UdcEndPointTable::FLAG_RACE_STARTED) != 0;
+}
+
+void UdcClient::startRace()
+{
+    m_table->m_flags[m_index] |= UdcEndPointTable::FLAG_RACE_STARTED;
+}
+
+bool UdcClient::needsAlternateAttempt(std::chrono::microseconds time) const
+{
+    uint8_t flags = m_table->m_flags[m_index];
+
+    if ((flags & UdcEndPointTable::FLAG_RACING) == 0 || (flags & UdcEndPointTable::FLAG_RACE_STARTED) != 0)
+    {
+        return false;
+    }
+
+    auto prevConnectAttemptTime = m_table->m_prevConnectAttemptTime[m_index];
+
+    return prevConnectAttemptTime != std::chrono::microseconds(0) &&
+        (time - prevConnectAttemptTime) >= raceDelay();
 }
 
-const UdcAddressMux& UdcClient::incomingAddress() const
+void UdcClient::finishRace(const UdcAddressMux& fromAddress)
 {
-    return m_incomingAddress;
+    auto& outgoingAddress = m_table->m_outgoingAddress[m_index];
+    const auto& alternateAddress = m_table->m_alternateAddress[m_index];
+
+    if ((m_table->m_flags[m_index] & UdcEndPointTable::FLAG_RACING) != 0 &&
+        fromAddress.family == alternateAddress.family &&
+        fromAddress.family != outgoingAddress.family)
+    {
+        outgoingAddress = alternateAddress;
+    }
+
+    m_table->m_flags[m_index] &= ~(UdcEndPointTable::FLAG_RACING | UdcEndPointTable::FLAG_RACE_STARTED);
 }
 
-void UdcClient::startConnecting(std::chrono::milliseconds time)
+std::chrono::microseconds UdcClient::raceDelay() const
 {
-    m_firstConnectAttemptTime = time;
-    m_prevConnectAttemptTime = std::chrono::milliseconds(0);
+    // Leave the other family time to answer before the connection times out
+    return std::min(RACE_DELAY, m_table->m_timeoutPeriod[m_index] / 2);
 }
 
-void UdcClient::retryConnecting(std::chrono::milliseconds time)
+void UdcClient::retryConnecting(std::chrono::microseconds time)
 {
-    m_prevConnectAttemptTime = time;
+    m_table->m_prevConnectAttemptTime[m_index] = time;
 }
 
 void UdcClient::setConnectionLost()
 {
-    m_isConnected = false;
+    m_table->m_flags[m_index] &= ~UdcEndPointTable::FLAG_CONNECTED;
+    m_table->m_connectionLostTime[m_index] = UdcEndPointTable::NEVER;
 }
 
-bool UdcClient::needsConnectionTimeoutEvent(std::chrono::milliseconds time) const
+bool UdcClient::needsConnectionTimeoutEvent(std::chrono::microseconds time) const
 {
-    return (time - m_firstConnectAttemptTime) >= m_connectionTimeoutPeriod;
+    return (time - m_table->m_firstConnectAttemptTime[m_index]) >= m_table->m_timeoutPeriod[m_index];
 }
 
-bool UdcClient::needsConnectionAttempt(std::chrono::milliseconds time) const
+bool UdcClient::needsConnectionAttempt(std::chrono::microseconds time) const
 {
-    return (time - m_prevConnectAttemptTime) >= m_connectionAttemptPeriod;
+    return (time - m_table->m_prevConnectAttemptTime[m_index]) >= m_table->m_pingPeriod[m_index];
 }
 
-bool UdcClient::receivePong(std::chrono::milliseconds pingSentTime, std::chrono::milliseconds pongReceivedTime)
+bool UdcClient::receivePong(std::chrono::microseconds pingSentTime, std::chrono::microseconds pongReceivedTime)
 {
-    m_ping = pongReceivedTime - pingSentTime;
-    m_pingLastSetTime = pongReceivedTime;
-    m_lastReceivedTime = pongReceivedTime;
+    m_table->m_ping[m_index] = pongReceivedTime - pingSentTime;
+    m_table->m_nextPingTime[m_index] = pongReceivedTime + m_table->m_pingPeriod[m_index];
+    m_table->m_connectionLostTime[m_index] = pongReceivedTime + m_table->m_timeoutPeriod[m_index];
 
-    if (!m_isConnected)
+    if (!connected())
     {
-        m_isConnected = true;
+        m_table->m_flags[m_index] |= UdcEndPointTable::FLAG_CONNECTED;
         return true;
     }
 
     return false;
 }
 
-bool UdcClient::receiveReliableHandshake(std::chrono::milliseconds reliableSentTime, std::chrono::milliseconds handshakeReceivedTime)
+bool UdcClient::receiveReliableHandshake(std::chrono::microseconds reliableSentTime, std::chrono::microseconds handshakeReceivedTime)
 {
     // Allow reliable message handshake timestamp to act like ping/pong
     // there's no reason to send excessive pings if reliable traffic is high
@@ -117,43 +212,88 @@ bool UdcClient::receiveReliableHandshake(std::chrono::milliseconds reliableSentT
 
 void UdcClient::resetSendReliable()
 {
-    m_reliableSentTime = std::chrono::milliseconds(0);
+    m_table->m_reliableSentTime[m_index] = std::chrono::microseconds(0);
 }
 
-void UdcClient::setSendReliable(std::chrono::milliseconds time)
+void UdcClient::setSendReliable(std::chrono::microseconds time)
 {
-    if (m_reliableSentTime == std::chrono::milliseconds(0))
+    if (m_table->m_reliableSentTime[m_index] == std::chrono::microseconds(0))
     {
-        m_reliableSentTime = time;
+        m_table->m_reliableSentTime[m_index] = time;
     }
 }
 
-bool UdcClient::needsReliableReset(std::chrono::milliseconds time) const
+bool UdcClient::awaitingReliableHandshake() const
 {
-    if (m_reliableSentTime == std::chrono::milliseconds(0))
+    return m_table->m_reliableSentTime[m_index] != std::chrono::microseconds(0);
+}
+
+bool UdcClient::needsReliableReset(std::chrono::microseconds time) const
+{
+    auto reliableSentTime = m_table->m_reliableSentTime[m_index];
+
+    if (reliableSentTime == std::chrono::microseconds(0))
     {
         return false;
     }
 
-    return (time - m_reliableSentTime >= m_reliableTimeoutPeriod);
+    return (time - reliableSentTime >= m_table->m_timeoutPeriod[m_index]);
 }
 
-bool UdcClient::needsPing(std::chrono::milliseconds time) const
+std::chrono::microseconds UdcClient::nextConnectionAttemptTime() const
 {
-    return (time - m_pingLastSetTime) >= m_pingPeriod;
+    auto timeoutTime = m_table->m_firstConnectAttemptTime[m_index] + m_table->m_timeoutPeriod[m_index];
+
+    // Nothing is sent until the address is known, so only the timeout is due
+    if (resolving())
+    {
+        return timeoutTime;
+    }
+
+    auto prevConnectAttemptTime = m_table->m_prevConnectAttemptTime[m_index];
+    auto nextTime = std::min(prevConnectAttemptTime + m_table->m_pingPeriod[m_index], timeoutTime);
+
+    if ((m_table->m_flags[m_index] & UdcEndPointTable::FLAG_RACING) != 0 && !raceStarted())
+    {
+        nextTime = std::min(nextTime, prevConnectAttemptTime + raceDelay());
+    }
+
+    return nextTime;
 }
 
-bool UdcClient::needsConnectionLostEvent(std::chrono::milliseconds time) const
+std::chrono::microseconds UdcClient::nextPingTime() const
 {
-    return m_isConnected && ((time - m_lastReceivedTime) >= m_connectionLostPeriod);
+    return m_table->m_nextPingTime[m_index];
 }
 
-void UdcClient::receiveConnectionHandshake(std::chrono::milliseconds receivedTime)
+std::chrono::microseconds UdcClient::connectionLostTime() const
 {
-    if (!m_isConnected)
-    {
-        m_isConnected = true;
-    }
+    return m_table->m_connectionLostTime[m_index];
+}
 
-    m_lastReceivedTime = receivedTime;
+std::chrono::microseconds UdcClient::retransmitPeriod() const
+{
+    // Twice the round trip time, but often enough to retry a few times before timing out
+    // and no more often than once a millisecond on very short round trips
+    return std::max<std::chrono::microseconds>(
+        std::min(m_table->m_ping[m_index] * 2, m_table->m_timeoutPeriod[m_index] / 4),
+        std::chrono::milliseconds(1));
+}
+
+bool UdcClient::needsPing(std::chrono::microseconds time) const
+{
+    return time >= m_table->m_nextPingTime[m_index];
+}
+
+bool UdcClient::needsConnectionLostEvent(std::chrono::microseconds time) const
+{
+    // The deadline is NEVER while not connected
+    return time >= m_table->m_connectionLostTime[m_index];
+}
+
+void UdcClient::receiveConnectionHandshake(std::chrono::microseconds receivedTime)
+{
+    m_table->m_flags[m_index] |= UdcEndPointTable::FLAG_CONNECTED;
+    m_table->m_flags[m_index] &= ~UdcEndPointTable::FLAG_PENDING;
+    m_table->m_connectionLostTime[m_index] = receivedTime + m_table->m_timeoutPeriod[m_index];
 }
@@ -0,0 +1,306 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcEndPointTable.h"
+#include "UdcClient.h"
+
+#include <iterator>
+
+template<class T>
+static size_t columnBytes(const std::vector<T>& column)
+{
+    return column.capacity() * sizeof(T);
+}
+
+// Move a column into storage allocated and written by the calling thread
+template<class T>
+static void relocateColumn(std::vector<T>& column)
+{
+    std::vector<T> relocated;
+    relocated.reserve(column.capacity());
+    relocated.insert(relocated.end(), std::make_move_iterator(column.begin()), std::make_move_iterator(column.end()));
+    column.swap(relocated);
+}
+
+UdcEndPointTable::UdcEndPointTable()
+    : m_freeHead(NONE)
+    , m_size(0)
+{}
+
+uint32_t UdcEndPointTable::indexOf(UdcEndPointId id)
+{
+    return id & INDEX_MASK;
+}
+
+bool UdcEndPointTable::emplace(
+    const UdcAddressMux& outgoingAddress,
+    std::chrono::microseconds pingPeriod,
+    std::chrono::microseconds timeoutPeriod,
+    UdcEndPointId& id)
+{
+    uint32_t index;
+
+    if (m_freeHead != NONE)
+    {
+        index = m_freeHead;
+        m_freeHead = m_nextFree[index];
+    }
+    else
+    {
+        if (m_generation.size() > INDEX_MASK)
+        {
+            return false;
+        }
+
+        index = appendSlot();
+    }
+
+    m_flags[index] = FLAG_USED | FLAG_PENDING;
+    m_reliableState[index] = 0;
+    m_ping[index] = std::chrono::microseconds(0);
+    m_nextPingTime[index] = pingPeriod;
+    m_connectionLostTime[index] = NEVER;
+    m_reliableSentTime[index] = std::chrono::microseconds(0);
+
+    m_nextFree[index] = NONE;
+    m_outgoingAddress[index] = outgoingAddress;
+    m_pingPeriod[index] = pingPeriod;
+    m_timeoutPeriod[index] = timeoutPeriod;
+    m_firstConnectAttemptTime[index] = std::chrono::microseconds(0);
+    m_prevConnectAttemptTime[index] = std::chrono::microseconds(0);
+    m_alternateAddress[index] = {};
+    m_reliableMessages[index].clear();
+    m_context[index] = nullptr;
+    m_reliableAcknowledged[index] = 0;
+    m_stats[index] = {};
+
+    id = (m_generation[index] << INDEX_BITS) | index;
+    ++m_size;
+
+    return true;
+}
+
+bool UdcEndPointTable::erase(UdcEndPointId id)
+{
+    UdcClient client;
+
+    if (!find(id, client))
+    {
+        return false;
+    }
+
+    uint32_t index = indexOf(id);
+
+    m_flags[index] = 0;
+    m_connectionLostTime[index] = NEVER;
+
+    // The queue keeps its buffer, so a reused slot doesn't allocate
+    m_reliableMessages[index].clear();
+
+    // Generation 0 is skipped so that a valid id is never 0
+    m_generation[index] = (m_generation[index] + 1) & GENERATION_MASK;
+    if (m_generation[index] == 0)
+    {
+        m_generation[index] = 1;
+    }
+
+    m_nextFree[index] = m_freeHead;
+    m_freeHead = index;
+    --m_size;
+
+    return true;
+}
+
+bool UdcEndPointTable::reserve(uint32_t count)
+{
+    if (count > INDEX_MASK + 1)
+    {
+        return false;
+    }
+
+    auto first = static_cast<uint32_t>(m_generation.size());
+
+    if (count <= first)
+    {
+        return true;
+    }
+
+    reserveColumns(count);
+
+    for (uint32_t i = first; i != count; ++i)
+    {
+        appendSlot();
+    }
+
+    // Linked in reverse so that the lowest new slot is used first
+    for (uint32_t i = count; i-- != first;)
+    {
+        m_nextFree[i] = m_freeHead;
+        m_freeHead = i;
+    }
+
+    return true;
+}
+
+void UdcEndPointTable::relocate()
+{
+    relocateColumn(m_flags);
+    relocateColumn(m_reliableState);
+    relocateColumn(m_ping);
+    relocateColumn(m_nextPingTime);
+    relocateColumn(m_connectionLostTime);
+    relocateColumn(m_reliableSentTime);
+
+    relocateColumn(m_generation);
+    relocateColumn(m_nextFree);
+    relocateColumn(m_outgoingAddress);
+    relocateColumn(m_pingPeriod);
+    relocateColumn(m_timeoutPeriod);
+    relocateColumn(m_firstConnectAttemptTime);
+    relocateColumn(m_prevConnectAttemptTime);
+    relocateColumn(m_alternateAddress);
+    relocateColumn(m_reliableMessages);
+    relocateColumn(m_context);
+    relocateColumn(m_reliableAcknowledged);
+    relocateColumn(m_stats);
+}
+
+bool UdcEndPointTable::find(UdcEndPointId id, UdcClient& client)
+{
+    uint32_t index = indexOf(id);
+
+    if (index >= m_generation.size())
+    {
+        return false;
+    }
+
+    if (m_generation[index] != (id >> INDEX_BITS) || (m_flags[index] & FLAG_USED) == 0)
+    {
+        return false;
+    }
+
+    client = UdcClient(this, index);
+    return true;
+}
+
+bool UdcEndPointTable::atIndex(uint32_t index, UdcClient& client)
+{
+    if ((m_flags[index] & FLAG_USED) == 0)
+    {
+        return false;
+    }
+
+    client = UdcClient(this, index);
+    return true;
+}
+
+uint32_t UdcEndPointTable::slotCount() const
+{
+    return static_cast<uint32_t>(m_generation.size());
+}
+
+uint32_t UdcEndPointTable::size() const
+{
+    return m_size;
+}
+
+size_t UdcEndPointTable::hotBytesPerEndPoint()
+{
+    return
+        sizeof(decltype(m_flags)::value_type) +
+        sizeof(decltype(m_reliableState)::value_type) +
+        sizeof(decltype(m_ping)::value_type) +
+        sizeof(decltype(m_nextPingTime)::value_type) +
+        sizeof(decltype(m_connectionLostTime)::value_type) +
+        sizeof(decltype(m_reliableSentTime)::value_type);
+}
+
+size_t UdcEndPointTable::coldBytesPerEndPoint()
+{
+    return
+        sizeof(decltype(m_generation)::value_type) +
+        sizeof(decltype(m_nextFree)::value_type) +
+        sizeof(decltype(m_outgoingAddress)::value_type) +
+        sizeof(decltype(m_pingPeriod)::value_type) +
+        sizeof(decltype(m_timeoutPeriod)::value_type) +
+        sizeof(decltype(m_firstConnectAttemptTime)::value_type) +
+        sizeof(decltype(m_prevConnectAttemptTime)::value_type) +
+        sizeof(decltype(m_alternateAddress)::value_type) +
+        sizeof(decltype(m_reliableMessages)::value_type) +
+        sizeof(decltype(m_context)::value_type) +
+        sizeof(decltype(m_reliableAcknowledged)::value_type) +
+        sizeof(decltype(m_stats)::value_type);
+}
+
+size_t UdcEndPointTable::memoryUsage() const
+{
+    return
+        columnBytes(m_flags) +
+        columnBytes(m_reliableState) +
+        columnBytes(m_ping) +
+        columnBytes(m_nextPingTime) +
+        columnBytes(m_connectionLostTime) +
+        columnBytes(m_reliableSentTime) +
+        columnBytes(m_generation) +
+        columnBytes(m_nextFree) +
+        columnBytes(m_outgoingAddress) +
+        columnBytes(m_pingPeriod) +
+        columnBytes(m_timeoutPeriod) +
+        columnBytes(m_firstConnectAttemptTime) +
+        columnBytes(m_prevConnectAttemptTime) +
+        columnBytes(m_alternateAddress) +
+        columnBytes(m_reliableMessages) +
+        columnBytes(m_context) +
+        columnBytes(m_reliableAcknowledged) +
+        columnBytes(m_stats);
+}
+
+uint32_t UdcEndPointTable::appendSlot()
+{
+    auto index = static_cast<uint32_t>(m_generation.size());
+
+    m_flags.push_back(0);
+    m_reliableState.push_back(0);
+    m_ping.push_back({});
+    m_nextPingTime.push_back({});
+    m_connectionLostTime.push_back(NEVER);
+    m_reliableSentTime.push_back({});
+
+    m_generation.push_back(1);
+    m_nextFree.push_back(NONE);
+    m_outgoingAddress.push_back({});
+    m_pingPeriod.push_back({});
+    m_timeoutPeriod.push_back({});
+    m_firstConnectAttemptTime.push_back({});
+    m_prevConnectAttemptTime.push_back({});
+    m_alternateAddress.push_back({});
+    m_reliableMessages.emplace_back();
+    m_context.push_back(nullptr);
+    m_reliableAcknowledged.push_back(0);
+    m_stats.push_back({});
+
+    return index;
+}
+
+void UdcEndPointTable::reserveColumns(uint32_t count)
+{
+    m_flags.reserve(count);
+    m_reliableState.reserve(count);
+    m_ping.reserve(count);
+    m_nextPingTime.reserve(count);
+    m_connectionLostTime.reserve(count);
+    m_reliableSentTime.reserve(count);
+
+    m_generation.reserve(count);
+    m_nextFree.reserve(count);
+    m_outgoingAddress.reserve(count);
+    m_pingPeriod.reserve(count);
+    m_timeoutPeriod.reserve(count);
+    m_firstConnectAttemptTime.reserve(count);
+    m_prevConnectAttemptTime.reserve(count);
+    m_alternateAddress.reserve(count);
+    m_reliableMessages.reserve(count);
+    m_context.reserve(count);
+    m_reliableAcknowledged.reserve(count);
+    m_stats.reserve(count);
+}
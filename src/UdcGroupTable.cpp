@@ -0,0 +1,124 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcGroupTable.h"
+
+#include <algorithm>
+
+UdcGroupTable::UdcGroupTable()
+    : m_freeHead(NONE)
+{}
+
+bool UdcGroupTable::create(UdcGroupId& id)
+{
+    uint32_t index;
+
+    if (m_freeHead != NONE)
+    {
+        index = m_freeHead;
+        m_freeHead = m_groups[index].nextFree;
+    }
+    else
+    {
+        if (m_groups.size() > INDEX_MASK)
+        {
+            return false;
+        }
+
+        index = static_cast<uint32_t>(m_groups.size());
+        m_groups.push_back({1, NONE, false, {}});
+    }
+
+    auto& group = m_groups[index];
+
+    group.nextFree = NONE;
+    group.used = true;
+    group.members.clear();
+
+    id = (group.generation << INDEX_BITS) | index;
+
+    return true;
+}
+
+bool UdcGroupTable::erase(UdcGroupId id)
+{
+    if (members(id) == nullptr)
+    {
+        return false;
+    }
+
+    uint32_t index = id & INDEX_MASK;
+    auto& group = m_groups[index];
+
+    // The member list keeps its buffer, so a reused slot doesn't allocate
+    group.used = false;
+    group.members.clear();
+
+    // Generation 0 is skipped so that a valid id is never 0
+    group.generation = (group.generation + 1) & GENERATION_MASK;
+    if (group.generation == 0)
+    {
+        group.generation = 1;
+    }
+
+    group.nextFree = m_freeHead;
+    m_freeHead = index;
+
+    return true;
+}
+
+bool UdcGroupTable::add(UdcGroupId id, UdcEndPointId endPointId)
+{
+    auto* groupMembers = members(id);
+
+    if (groupMembers == nullptr ||
+        std::find(groupMembers->begin(), groupMembers->end(), endPointId) != groupMembers->end())
+    {
+        return false;
+    }
+
+    groupMembers->push_back(endPointId);
+    return true;
+}
+
+bool UdcGroupTable::remove(UdcGroupId id, UdcEndPointId endPointId)
+{
+    auto* groupMembers = members(id);
+
+    if (groupMembers == nullptr)
+    {
+        return false;
+    }
+
+    auto it = std::find(groupMembers->begin(), groupMembers->end(), endPointId);
+
+    if (it == groupMembers->end())
+    {
+        return false;
+    }
+
+    // Order doesn't matter, so swap with the last member
+    *it = groupMembers->back();
+    groupMembers->pop_back();
+
+    return true;
+}
+
+std::vector<UdcEndPointId>* UdcGroupTable::members(UdcGroupId id)
+{
+    uint32_t index = id & INDEX_MASK;
+
+    if (index >= m_groups.size())
+    {
+        return nullptr;
+    }
+
+    auto& group = m_groups[index];
+
+    if (!group.used || group.generation != (id >> INDEX_BITS))
+    {
+        return nullptr;
+    }
+
+    return &group.members;
+}
@@ -0,0 +1,116 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcMessagePool.h"
+
+#include <cstring>
+#include <cassert>
+
+UdcMessagePool::UdcMessagePool(uint32_t maxMessageSize)
+{
+    // Add power of two size classes until the largest message fits
+    uint32_t capacity = 1u << MIN_CLASS_SHIFT;
+
+    while (true)
+    {
+        constexpr uint32_t align = alignof(UdcPooledMessage);
+        uint32_t blockSize = (sizeof(UdcPooledMessage) + capacity + align - 1) & ~(align - 1);
+
+        m_classes.push_back({capacity, blockSize, nullptr});
+
+        if (capacity >= maxMessageSize)
+        {
+            break;
+        }
+
+        capacity *= 2;
+    }
+}
+
+UdcPooledMessage* UdcMessagePool::acquire(const UdcSegment* segments, uint32_t segmentCount, uint32_t size)
+{
+    // Find the smallest size class that fits
+    uint32_t sizeClass = 0;
+
+    while (m_classes[sizeClass].capacity < size)
+    {
+        if (++sizeClass == m_classes.size())
+        {
+            return nullptr;
+        }
+    }
+
+    auto& c = m_classes[sizeClass];
+
+    if (c.freeList == nullptr)
+    {
+        allocateSlab(sizeClass);
+    }
+
+    UdcPooledMessage* msg = c.freeList;
+    c.freeList = msg->next;
+
+    msg->next = nullptr;
+    msg->size = size;
+    msg->refCount = 1;
+
+    uint8_t* dst = msg->data();
+
+    for (uint32_t i = 0; i != segmentCount; ++i)
+    {
+        memcpy(dst, segments[i].data, segments[i].size);
+        dst += segments[i].size;
+    }
+
+    assert(dst == msg->data() + size);
+
+    return msg;
+}
+
+void UdcMessagePool::retain(UdcPooledMessage* msg, uint32_t count)
+{
+    msg->refCount += count;
+}
+
+void UdcMessagePool::release(UdcPooledMessage* msg)
+{
+    assert(msg->sizeClass < m_classes.size());
+    assert(msg->refCount != 0);
+
+    if (--msg->refCount != 0)
+    {
+        return;
+    }
+
+    auto& c = m_classes[msg->sizeClass];
+
+    msg->next = c.freeList;
+    c.freeList = msg;
+}
+
+uint32_t UdcMessagePool::slabCount() const
+{
+    return static_cast<uint32_t>(m_slabs.size());
+}
+
+void UdcMessagePool::allocateSlab(uint32_t sizeClass)
+{
+    auto& c = m_classes[sizeClass];
+
+    uint32_t blockCount = (c.blockSize < SLAB_SIZE)
+        ? SLAB_SIZE / c.blockSize
+        : 1;
+
+    m_slabs.emplace_back(new uint8_t[static_cast<size_t>(blockCount) * c.blockSize]);
+    uint8_t* slab = m_slabs.back().get();
+
+    // Thread every block of the slab onto the free list
+    for (uint32_t i = 0; i != blockCount; ++i)
+    {
+        auto* msg = reinterpret_cast<UdcPooledMessage*>(slab + static_cast<size_t>(i) * c.blockSize);
+        msg->next = c.freeList;
+        msg->size = 0;
+        msg->sizeClass = sizeClass;
+        c.freeList = msg;
+    }
+}
@@ -70,6 +70,12 @@ void UdcPacketLogger::logReceived(const UdcAddressIPv6& address, uint16_t port,
 }
 
 void UdcPacketLogger::logSent(const UdcAddressIPv4& address, uint16_t port, const uint8_t* data, uint32_t size)
+{
+    UdcSegment segment = {data, size};
+    logSent(address, port, &segment, 1);
+}
+
+void UdcPacketLogger::logSent(const UdcAddressIPv4& address, uint16_t port, const UdcSegment* segments, uint32_t segmentCount)
 {
     m_file << "SEND IPV4 ";
 
@@ -83,18 +89,27 @@ void UdcPacketLogger::logSent(const UdcAddressIPv4& address, uint16_t port, cons
 
     m_file << ':' << std::dec << port << ' ';
 
-    for (uint32_t i = 0; i != size; ++i)
+    for (uint32_t s = 0; s != segmentCount; ++s)
     {
-        m_file
-            << std::hex << std::uppercase << std::setfill('0') << std::setw(2) << std::right
-            << static_cast<uint32_t>(data[i])
-            << ' ';
+        for (uint32_t i = 0; i != segments[s].size; ++i)
+        {
+            m_file
+                << std::hex << std::uppercase << std::setfill('0') << std::setw(2) << std::right
+                << static_cast<uint32_t>(segments[s].data[i])
+                << ' ';
+        }
     }
 
     m_file << '\n';
 }
 
 void UdcPacketLogger::logSent(const UdcAddressIPv6& address, uint16_t port, const uint8_t* data, uint32_t size)
+{
+    UdcSegment segment = {data, size};
+    logSent(address, port, &segment, 1);
+}
+
+void UdcPacketLogger::logSent(const UdcAddressIPv6& address, uint16_t port, const UdcSegment* segments, uint32_t segmentCount)
 {
     m_file << "SEND IPV6 ";
 
@@ -108,12 +123,15 @@ void UdcPacketLogger::logSent(const UdcAddressIPv6& address, uint16_t port, cons
 
     m_file << ':' << std::dec << port << ' ';
 
-    for (uint32_t i = 0; i != size; ++i)
+    for (uint32_t s = 0; s != segmentCount; ++s)
     {
-        m_file
-            << std::hex << std::uppercase << std::setfill('0') << std::setw(2) << std::right
-            << static_cast<uint32_t>(data[i])
-            << ' ';
+        for (uint32_t i = 0; i != segments[s].size; ++i)
+        {
+            m_file
+                << std::hex << std::uppercase << std::setfill('0') << std::setw(2) << std::right
+                << static_cast<uint32_t>(segments[s].data[i])
+                << ' ';
+        }
     }
 
     m_file << '\n';
@@ -0,0 +1,181 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcReliableStateTable.h"
+
+UdcReliableStateTable::UdcReliableStateTable()
+    : m_oldest(NONE)
+    , m_newest(NONE)
+    , m_freeHead(NONE)
+    , m_capacity(DEFAULT_CAPACITY)
+    , m_idleTimeout(DEFAULT_IDLE_TIMEOUT)
+    , m_evictions(0)
+    , m_expirations(0)
+{}
+
+void UdcReliableStateTable::setCapacity(uint32_t capacity)
+{
+    m_capacity = capacity;
+
+    while (m_index.size() > m_capacity)
+    {
+        removeOldest();
+        ++m_evictions;
+    }
+}
+
+void UdcReliableStateTable::setIdleTimeout(std::chrono::microseconds idleTimeout)
+{
+    m_idleTimeout = idleTimeout;
+}
+
+int* UdcReliableStateTable::find(const UdcAddressMux& address, std::chrono::microseconds time)
+{
+    auto* index = m_index.find(address);
+
+    if (index == nullptr)
+    {
+        return nullptr;
+    }
+
+    auto& entry = m_entries[*index];
+
+    entry.lastUsedTime = time;
+
+    if (*index != m_newest)
+    {
+        unlink(*index);
+        linkNewest(*index);
+    }
+
+    return &entry.state;
+}
+
+void UdcReliableStateTable::insert(const UdcAddressMux& address, int state, std::chrono::microseconds time)
+{
+    if (m_capacity == 0)
+    {
+        return;
+    }
+
+    if (m_index.size() >= m_capacity)
+    {
+        removeOldest();
+        ++m_evictions;
+    }
+
+    uint32_t index;
+
+    if (m_freeHead != NONE)
+    {
+        index = m_freeHead;
+        m_freeHead = m_entries[index].next;
+    }
+    else
+    {
+        index = static_cast<uint32_t>(m_entries.size());
+        m_entries.push_back({});
+    }
+
+    auto& entry = m_entries[index];
+
+    entry.address = address;
+    entry.lastUsedTime = time;
+    entry.state = state;
+
+    linkNewest(index);
+    m_index.insert(address, index);
+}
+
+bool UdcReliableStateTable::erase(const UdcAddressMux& address)
+{
+    auto* found = m_index.find(address);
+
+    if (found == nullptr)
+    {
+        return false;
+    }
+
+    uint32_t index = *found;
+
+    m_index.erase(address);
+    unlink(index);
+
+    m_entries[index].next = m_freeHead;
+    m_freeHead = index;
+
+    return true;
+}
+
+void UdcReliableStateTable::expire(std::chrono::microseconds time)
+{
+    // The list is ordered by last use, so only expired entries are visited
+    while (m_oldest != NONE && (time - m_entries[m_oldest].lastUsedTime) >= m_idleTimeout)
+    {
+        removeOldest();
+        ++m_expirations;
+    }
+}
+
+uint32_t UdcReliableStateTable::size() const
+{
+    return m_index.size();
+}
+
+uint64_t UdcReliableStateTable::evictions() const
+{
+    return m_evictions;
+}
+
+uint64_t UdcReliableStateTable::expirations() const
+{
+    return m_expirations;
+}
+
+void UdcReliableStateTable::unlink(uint32_t index)
+{
+    auto& entry = m_entries[index];
+
+    if (entry.prev != NONE)
+    {
+        m_entries[entry.prev].next = entry.next;
+    }
+    else
+    {
+        m_oldest = entry.next;
+    }
+
+    if (entry.next != NONE)
+    {
+        m_entries[entry.next].prev = entry.prev;
+    }
+    else
+    {
+        m_newest = entry.prev;
+    }
+}
+
+void UdcReliableStateTable::linkNewest(uint32_t index)
+{
+    auto& entry = m_entries[index];
+
+    entry.prev = m_newest;
+    entry.next = NONE;
+
+    if (m_newest != NONE)
+    {
+        m_entries[m_newest].next = index;
+    }
+    else
+    {
+        m_oldest = index;
+    }
+
+    m_newest = index;
+}
+
+void UdcReliableStateTable::removeOldest()
+{
+    // erase() re-links the entry into the free list
+    erase(m_entries[m_oldest].address);
+}
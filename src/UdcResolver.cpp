@@ -0,0 +1,255 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcResolver.h"
+#include "UdcSocket.h"
+
+#include <cstring>
+
+UdcResolver::UdcResolver()
+    : m_stopping(false)
+    , m_positiveTtl(DEFAULT_POSITIVE_TTL)
+    , m_negativeTtl(DEFAULT_NEGATIVE_TTL)
+    , m_resultCallback(nullptr)
+    , m_resultContext(nullptr)
+    , m_lookups(0)
+{}
+
+UdcResolver::~UdcResolver()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+
+    m_wake.notify_all();
+
+    for (auto& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+void UdcResolver::setTtl(std::chrono::microseconds positiveTtl, std::chrono::microseconds negativeTtl)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_positiveTtl = positiveTtl;
+    m_negativeTtl = negativeTtl;
+    m_cache.clear();
+}
+
+bool UdcResolver::resolve(const char* nodeName, const char* serviceName, Addresses& addresses)
+{
+    auto key = makeKey(nodeName, serviceName);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (auto* entry = findCached(key, std::chrono::steady_clock::now()))
+        {
+            addresses = entry->addresses;
+            return addresses.count != 0;
+        }
+
+        ++m_lookups;
+    }
+
+    lookUp(key, addresses);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    cache(key, addresses, std::chrono::steady_clock::now());
+
+    return addresses.count != 0;
+}
+
+void UdcResolver::resolveAsync(const char* nodeName, const char* serviceName, UdcEndPointId endPointId)
+{
+    auto key = makeKey(nodeName, serviceName);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (auto* entry = findCached(key, std::chrono::steady_clock::now()))
+    {
+        m_results.push_back({endPointId, entry->addresses});
+
+        if (m_resultCallback != nullptr)
+        {
+            m_resultCallback(m_resultContext);
+        }
+
+        return;
+    }
+
+    // Another endpoint is already waiting for this name
+    auto waiting = m_waiting.find(key);
+
+    if (waiting != m_waiting.end())
+    {
+        waiting->second.push_back(endPointId);
+        return;
+    }
+
+    m_waiting[key].push_back(endPointId);
+    m_queue.push_back(std::move(key));
+
+    if (m_threads.empty())
+    {
+        for (uint32_t i = 0; i != THREAD_COUNT; ++i)
+        {
+            m_threads.emplace_back(&UdcResolver::runThread, this);
+        }
+    }
+
+    m_wake.notify_one();
+}
+
+void UdcResolver::takeResults(std::vector<Result>& results)
+{
+    results.clear();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    results.swap(m_results);
+}
+
+bool UdcResolver::hasResults() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return !m_results.empty();
+}
+
+void UdcResolver::setResultCallback(ResultCallback callback, void* context)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_resultCallback = callback;
+    m_resultContext = context;
+}
+
+uint64_t UdcResolver::lookups() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lookups;
+}
+
+std::string UdcResolver::makeKey(const char* nodeName, const char* serviceName)
+{
+    // Node names can't contain a null, so it separates the two names
+    std::string key(nodeName);
+    key.push_back('\0');
+    key.append(serviceName);
+
+    return key;
+}
+
+void UdcResolver::lookUp(const std::string& key, Addresses& addresses)
+{
+    const char* nodeName = key.c_str();
+    const char* serviceName = nodeName + strlen(nodeName) + 1;
+
+    addresses = {};
+
+    // Both families are looked up, so that a connection can race them
+    auto& ipv6 = addresses.address[addresses.count];
+
+    if (UdcSocket::stringToIPv6(nodeName, serviceName, ipv6.address.ipv6, ipv6.port))
+    {
+        ipv6.family = UDC_IPV6;
+        ++addresses.count;
+    }
+
+    auto& ipv4 = addresses.address[addresses.count];
+
+    if (UdcSocket::stringToIPv4(nodeName, serviceName, ipv4.address.ipv4, ipv4.port))
+    {
+        ipv4.family = UDC_IPV4;
+        ++addresses.count;
+    }
+}
+
+const UdcResolver::Entry* UdcResolver::findCached(const std::string& key, std::chrono::steady_clock::time_point now)
+{
+    auto found = m_cache.find(key);
+
+    if (found == m_cache.end())
+    {
+        return nullptr;
+    }
+
+    if (now >= found->second.expiry)
+    {
+        m_cache.erase(found);
+        return nullptr;
+    }
+
+    return &found->second;
+}
+
+void UdcResolver::cache(const std::string& key, const Addresses& addresses, std::chrono::steady_clock::time_point now)
+{
+    auto ttl = (addresses.count != 0) ? m_positiveTtl : m_negativeTtl;
+
+    if (ttl.count() == 0)
+    {
+        return;
+    }
+
+    // Make room by forgetting expired results, or any result if none have expired
+    if (m_cache.size() >= DEFAULT_CAPACITY && m_cache.find(key) == m_cache.end())
+    {
+        for (auto i = m_cache.begin(); i != m_cache.end();)
+        {
+            i = (now >= i->second.expiry) ? m_cache.erase(i) : std::next(i);
+        }
+
+        if (m_cache.size() >= DEFAULT_CAPACITY)
+        {
+            m_cache.erase(m_cache.begin());
+        }
+    }
+
+    m_cache[key] = {addresses, now + ttl};
+}
+
+void UdcResolver::runThread()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true)
+    {
+        m_wake.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+
+        if (m_stopping)
+        {
+            return;
+        }
+
+        std::string key = std::move(m_queue.front());
+        m_queue.pop_front();
+        ++m_lookups;
+
+        // The name server can take seconds, so nothing is held while waiting for it
+        lock.unlock();
+
+        Addresses addresses;
+        lookUp(key, addresses);
+
+        lock.lock();
+
+        cache(key, addresses, std::chrono::steady_clock::now());
+
+        auto waiting = m_waiting.find(key);
+
+        for (UdcEndPointId endPointId : waiting->second)
+        {
+            m_results.push_back({endPointId, addresses});
+        }
+
+        m_waiting.erase(waiting);
+
+        if (m_resultCallback != nullptr)
+        {
+            m_resultCallback(m_resultContext);
+        }
+    }
+}
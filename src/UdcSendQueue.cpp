@@ -0,0 +1,129 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcSendQueue.h"
+
+#include <cstring>
+
+UdcSendQueue::UdcSendQueue(uint32_t capacity, uint32_t maxMessageSize)
+    : m_mask(0)
+    , m_maxMessageSize(maxMessageSize)
+    , m_tail(0)
+    , m_head(0)
+{
+    uint32_t size = 1;
+
+    while (size < capacity)
+    {
+        size *= 2;
+    }
+
+    m_cells = std::make_unique<Cell[]>(size);
+    m_payloads = std::make_unique<uint8_t[]>(static_cast<size_t>(size) * maxMessageSize);
+    m_mask = size - 1;
+
+    for (uint32_t i = 0; i != size; ++i)
+    {
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool UdcSendQueue::push(UdcEndPointId endPointId, const UdcSegment* segments, uint32_t segmentCount, UdcMessageType reliability)
+{
+    uint64_t size = 0;
+
+    for (uint32_t i = 0; i != segmentCount; ++i)
+    {
+        size += segments[i].size;
+    }
+
+    if (size > m_maxMessageSize)
+    {
+        return false;
+    }
+
+    // Claim a cell
+    uint32_t pos = m_tail.load(std::memory_order_relaxed);
+    Cell* cell;
+
+    for (;;)
+    {
+        cell = &m_cells[pos & m_mask];
+
+        auto diff = static_cast<int32_t>(cell->sequence.load(std::memory_order_acquire) - pos);
+
+        if (diff == 0)
+        {
+            // On failure pos is reloaded with the current tail
+            if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            // The consumer hasn't popped the message a lap ago
+            return false;
+        }
+        else
+        {
+            // Another producer claimed the cell
+            pos = m_tail.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Copy the message in and publish it
+    uint8_t* payload = m_payloads.get() + static_cast<size_t>(pos & m_mask) * m_maxMessageSize;
+
+    for (uint32_t i = 0; i != segmentCount; ++i)
+    {
+        memcpy(payload, segments[i].data, segments[i].size);
+        payload += segments[i].size;
+    }
+
+    cell->endPointId = endPointId;
+    cell->reliability = reliability;
+    cell->size = static_cast<uint32_t>(size);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+
+    return true;
+}
+
+bool UdcSendQueue::front(Submission& submission) const
+{
+    const Cell& cell = m_cells[m_head & m_mask];
+
+    if (cell.sequence.load(std::memory_order_acquire) != m_head + 1)
+    {
+        return false;
+    }
+
+    submission.endPointId = cell.endPointId;
+    submission.reliability = cell.reliability;
+    submission.data = m_payloads.get() + static_cast<size_t>(m_head & m_mask) * m_maxMessageSize;
+    submission.size = cell.size;
+
+    return true;
+}
+
+void UdcSendQueue::pop()
+{
+    // The cell is free for the producer one lap ahead
+    m_cells[m_head & m_mask].sequence.store(m_head + m_mask + 1, std::memory_order_release);
+    ++m_head;
+}
+
+uint32_t UdcSendQueue::capacity() const
+{
+    return m_mask + 1;
+}
+
+uint32_t UdcSendQueue::size() const
+{
+    return m_tail.load(std::memory_order_acquire) - m_head;
+}
+
+uint32_t UdcSendQueue::maxMessageSize() const
+{
+    return m_maxMessageSize;
+}
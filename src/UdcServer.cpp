@@ -6,13 +6,91 @@
 
 #include <stdexcept>
 #include <cassert>
+#include <algorithm>
+#include <thread>
+
+// Time elapsed since a timestamp that was sent and echoed back by the remote
+// only the low 32 bits of a time are sent, so the difference is taken modulo 2^32
+// returns false if the timestamp is from the future
+static bool tryGetElapsedTime(std::chrono::microseconds time, uint32_t timeStamp, std::chrono::microseconds& elapsed)
+{
+    uint32_t difference = static_cast<uint32_t>(time.count()) - timeStamp;
+
+    if (difference > 0x7FFFFFFFu)
+    {
+        return false;
+    }
+
+    elapsed = std::chrono::microseconds(difference);
+    return true;
+}
+
+// Total size of a message made of segments
+// returns false if there are too many segments or the size overflows
+static bool tryGetMessageSize(const UdcSegment* segments, uint32_t segmentCount, uint32_t& size)
+{
+    if (segmentCount > UDC_MAX_MESSAGE_SEGMENTS)
+    {
+        return false;
+    }
+
+    uint64_t total = 0;
+
+    for (uint32_t i = 0; i != segmentCount; ++i)
+    {
+        total += segments[i].size;
+    }
+
+    if (total > 0xFFFFFFFFu)
+    {
+        return false;
+    }
+
+    size = static_cast<uint32_t>(total);
+    return true;
+}
+
+std::chrono::microseconds UdcServerImpl::currentTime()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch());
+}
 
 UdcServerImpl::UdcServerImpl(UdcSignature signature, uint8_t* buffer, uint32_t bufferSize)
-    : m_idCounter(0)
-    , m_packetSignature(signature)
+    : m_packetSignature(signature)
     , m_eventBuffer({})
+    , m_connectionHandlers{}
+    , m_messageIPv4Handler{}
+    , m_messageIPv6Handler{}
+    , m_pendingClientCount(0)
+    , m_orderedConnectionEvents(false)
+    , m_receiveEvent(nullptr)
+    , m_stats{}
+    , m_signatureMismatches(0)
+    , m_malformedDrops(0)
     , m_messageBuffer(buffer)
     , m_messageBufferSize(bufferSize)
+    , m_buffer(buffer)
+    , m_slotCount(1)
+    , m_currentSlot(0)
+    , m_messageLimit(NO_MESSAGE_LIMIT)
+    , m_manualRelease(false)
+    , m_heldSlots(1, false)
+    , m_messagePool(bufferSize)
+    , m_timers(static_cast<uint64_t>(currentTime().count()))
+    , m_expiredIndex(0)
+    , m_maintenanceBatches(1)
+    , m_maintenanceProcessors{}
+    , m_ioMode(false)
+    , m_ioRunning(false)
+    , m_ioPeriod(0)
+    , m_ioSpinPeriod(0)
+    , m_ioProcessors{}
+    , m_ioWakeEvent(nullptr)
+    , m_ioSpins(0)
+    , m_ioSleeps(0)
+    , m_ioWakeups(0)
+    , m_ioEventBuffer({})
 {
     // Write message signature into buffer
     // this is needed by send/recv in every message
@@ -23,11 +101,40 @@ UdcServerImpl::UdcServerImpl(UdcSignature signature, uint8_t* buffer, uint32_t b
 
 UdcServerImpl::UdcServerImpl(UdcSignature signature, uint8_t* buffer, uint32_t bufferSize, const std::string& logFileName)
     : m_socket(logFileName)
-    , m_idCounter(0)
     , m_packetSignature(signature)
     , m_eventBuffer({})
+    , m_connectionHandlers{}
+    , m_messageIPv4Handler{}
+    , m_messageIPv6Handler{}
+    , m_pendingClientCount(0)
+    , m_orderedConnectionEvents(false)
+    , m_receiveEvent(nullptr)
+    , m_stats{}
+    , m_signatureMismatches(0)
+    , m_malformedDrops(0)
     , m_messageBuffer(buffer)
     , m_messageBufferSize(bufferSize)
+    , m_buffer(buffer)
+    , m_slotCount(1)
+    , m_currentSlot(0)
+    , m_messageLimit(NO_MESSAGE_LIMIT)
+    , m_manualRelease(false)
+    , m_heldSlots(1, false)
+    , m_messagePool(bufferSize)
+    , m_timers(static_cast<uint64_t>(currentTime().count()))
+    , m_expiredIndex(0)
+    , m_maintenanceBatches(1)
+    , m_maintenanceProcessors{}
+    , m_ioMode(false)
+    , m_ioRunning(false)
+    , m_ioPeriod(0)
+    , m_ioSpinPeriod(0)
+    , m_ioProcessors{}
+    , m_ioWakeEvent(nullptr)
+    , m_ioSpins(0)
+    , m_ioSleeps(0)
+    , m_ioWakeups(0)
+    , m_ioEventBuffer({})
 {
     // Write message signature into buffer
     // this is needed by send/recv in every message
@@ -36,6 +143,259 @@ UdcServerImpl::UdcServerImpl(UdcSignature signature, uint8_t* buffer, uint32_t b
     serial::msgHeader::serializeMsgSignature(m_messageBuffer, m_packetSignature);
 }
 
+UdcServerImpl::~UdcServerImpl()
+{
+    stopIoThread();
+}
+
+bool UdcServerImpl::setEventRing(uint32_t slotCount, bool manualRelease)
+{
+    if (slotCount == 0 || m_messageBufferSize / slotCount < serial::msgReliable::SIZE)
+    {
+        return false;
+    }
+
+    m_messageBufferSize /= slotCount;
+    m_slotCount = slotCount;
+    m_manualRelease = manualRelease;
+    m_heldSlots.assign(slotCount, false);
+
+    // Every slot starts with the signature, like the whole buffer did
+    m_freeSlots.clear();
+
+    for (uint32_t slot = 0; slot != slotCount; ++slot)
+    {
+        serial::msgHeader::serializeMsgSignature(m_buffer + slot * m_messageBufferSize, m_packetSignature);
+        m_freeSlots.push(slot);
+    }
+
+    selectFreeSlot();
+
+    return true;
+}
+
+uint32_t UdcServerImpl::slotCount() const
+{
+    return m_slotCount;
+}
+
+bool UdcServerImpl::releaseMessage(uint32_t msgIndex)
+{
+    uint32_t slot = msgIndex / m_messageBufferSize;
+
+    if (!m_manualRelease || slot >= m_slotCount)
+    {
+        return false;
+    }
+
+    // The I/O thread owns the slots, so only the application's own record of them is checked here
+    if (m_ioMode)
+    {
+        if (!m_ioHeldSlots[slot])
+        {
+            return false;
+        }
+
+        m_ioHeldSlots[slot] = false;
+        m_ioReturnedSlots.push_back(slot);
+        returnIoSlots();
+
+        return true;
+    }
+
+    return freeSlot(slot);
+}
+
+bool UdcServerImpl::freeSlot(uint32_t slot)
+{
+    if (!m_heldSlots[slot])
+    {
+        return false;
+    }
+
+    m_heldSlots[slot] = false;
+    m_freeSlots.push(slot);
+
+    // Receiving stopped when every slot was held
+    if (m_currentSlot == NO_SLOT)
+    {
+        selectFreeSlot();
+    }
+
+    return true;
+}
+
+UdcSocketEvent* UdcServerImpl::receiveEvent()
+{
+    if (m_receiveEvent != nullptr)
+    {
+        return m_receiveEvent;
+    }
+
+    m_receiveEvent = m_socket.receiveEvent();
+
+    // A finished lookup needs an update to start connecting
+    if (m_receiveEvent != nullptr)
+    {
+        m_resolver.setResultCallback(
+            [](void* context) { static_cast<UdcSocketEvent*>(context)->signal(); },
+            m_receiveEvent);
+    }
+
+    return m_receiveEvent;
+}
+
+void UdcServerImpl::selectFreeSlot()
+{
+    if (m_freeSlots.empty())
+    {
+        m_currentSlot = NO_SLOT;
+        m_messageBuffer = nullptr;
+        return;
+    }
+
+    m_currentSlot = m_freeSlots.front();
+    m_freeSlots.pop();
+
+    m_messageBuffer = m_buffer + m_currentSlot * m_messageBufferSize;
+}
+
+const UdcEvent* UdcServerImpl::deliverMessage(
+    const UdcAddressMux& fromAddress,
+    UdcClient* client,
+    uint32_t headerSize,
+    uint32_t msgSize)
+{
+    uint32_t msgIndex = m_currentSlot * m_messageBufferSize + headerSize;
+
+    // The sender is looked up once by the caller, so the application doesn't need to
+    UdcEndPointId endPointId = 0;
+    void* context = nullptr;
+
+    if (client != nullptr)
+    {
+        endPointId = client->id();
+        context = client->context();
+    }
+
+    // The payload keeps its slot, the next message is received into another one
+    // with an I/O thread, the slot is held until the application hands it back
+    if (m_manualRelease || m_ioMode)
+    {
+        m_heldSlots[m_currentSlot] = true;
+    }
+    else
+    {
+        m_freeSlots.push(m_currentSlot);
+    }
+
+    selectFreeSlot();
+    --m_messageLimit;
+
+    // The callback is called after the slot is taken, so that it can release the message
+    // with an I/O thread, callbacks are called by the application when it takes the event,
+    // and this thread doesn't read them
+    if (fromAddress.family == UDC_IPV4)
+    {
+        if (!m_ioMode && m_messageIPv4Handler.callback != nullptr)
+        {
+            m_messageIPv4Handler.callback(
+                m_messageIPv4Handler.context, endPointId, context,
+                fromAddress.address.ipv4, fromAddress.port, msgIndex, msgSize - headerSize);
+            return nullptr;
+        }
+
+        m_eventBuffer.eventType = UDC_EVENT_RECEIVE_MESSAGE_IPV4;
+        m_eventBuffer.addressIPv4 = fromAddress.address.ipv4;
+    }
+    else
+    {
+        if (!m_ioMode && m_messageIPv6Handler.callback != nullptr)
+        {
+            m_messageIPv6Handler.callback(
+                m_messageIPv6Handler.context, endPointId, context,
+                fromAddress.address.ipv6, fromAddress.port, msgIndex, msgSize - headerSize);
+            return nullptr;
+        }
+
+        m_eventBuffer.eventType = UDC_EVENT_RECEIVE_MESSAGE_IPV6;
+        m_eventBuffer.addressIPv6 = fromAddress.address.ipv6;
+    }
+
+    m_eventBuffer.endPointId = endPointId;
+    m_eventBuffer.port = fromAddress.port;
+    m_eventBuffer.msgIndex = msgIndex;
+    m_eventBuffer.msgSize = msgSize - headerSize;
+    m_eventBuffer.context = context;
+
+    return &m_eventBuffer;
+}
+
+bool UdcServerImpl::setConnectionCallback(UdcEventType eventType, UdcConnectionCallback callback, void* context)
+{
+    if (eventType >= UDC_EVENT_RECEIVE_MESSAGE_IPV4)
+    {
+        return false;
+    }
+
+    m_connectionHandlers[eventType] = {callback, context};
+
+    return true;
+}
+
+void UdcServerImpl::setMessageCallback(UdcMessageIPv4Callback callback, void* context)
+{
+    m_messageIPv4Handler = {callback, context};
+}
+
+void UdcServerImpl::setMessageCallback(UdcMessageIPv6Callback callback, void* context)
+{
+    m_messageIPv6Handler = {callback, context};
+}
+
+bool UdcServerImpl::dispatchEvent(const UdcEvent* event) const
+{
+    // Without an I/O thread, message events with a callback never get here, see deliverMessage()
+    if (event->eventType == UDC_EVENT_RECEIVE_MESSAGE_IPV4)
+    {
+        if (m_messageIPv4Handler.callback == nullptr)
+        {
+            return false;
+        }
+
+        m_messageIPv4Handler.callback(
+            m_messageIPv4Handler.context, event->endPointId, event->context,
+            event->addressIPv4, event->port, event->msgIndex, event->msgSize);
+
+        return true;
+    }
+
+    if (event->eventType == UDC_EVENT_RECEIVE_MESSAGE_IPV6)
+    {
+        if (m_messageIPv6Handler.callback == nullptr)
+        {
+            return false;
+        }
+
+        m_messageIPv6Handler.callback(
+            m_messageIPv6Handler.context, event->endPointId, event->context,
+            event->addressIPv6, event->port, event->msgIndex, event->msgSize);
+
+        return true;
+    }
+
+    const auto& handler = m_connectionHandlers[event->eventType];
+
+    if (handler.callback == nullptr)
+    {
+        return false;
+    }
+
+    handler.callback(handler.context, event->endPointId);
+
+    return true;
+}
+
 bool UdcServerImpl::tryBindIPv4(uint16_t port)
 {
     return m_socket.tryBindIPv4(port);
@@ -46,367 +406,1623 @@ bool UdcServerImpl::tryBindIPv6(uint16_t port)
     return m_socket.tryBindIPv6(port);
 }
 
-bool UdcServerImpl::getEndPointStatus(UdcEndPointId id, std::chrono::milliseconds& ping)
+bool UdcServerImpl::enableSharedMemory()
+{
+    // The I/O thread waits on the sockets without holding the state
+    if (m_ioMode)
+    {
+        return false;
+    }
+
+    return m_socket.enableSharedMemory();
+}
+
+void UdcServerImpl::getSharedMemoryCounters(uint64_t& sent, uint64_t& received) const
+{
+    sent = m_socket.sharedSent();
+    received = m_socket.sharedReceived();
+}
+
+bool UdcServerImpl::getEndPointStatus(UdcEndPointId id, std::chrono::microseconds& ping)
 {
-    UdcClient* client;
+    UdcClient client;
 
-    if (tryGetClient(id, &client) && client->connected())
+    if (tryGetClient(id, client) && client.connected())
     {
-        ping = client->ping();
+        ping = client.ping();
         return true;
     }
 
     return false;
 }
 
-UdcEndPointId UdcServerImpl::createUniqueId()
+bool UdcServerImpl::addPendingClient(
+    const UdcAddressMux& address,
+    std::chrono::microseconds pingPeriod,
+    std::chrono::microseconds timeoutPeriod,
+    std::chrono::microseconds time,
+    UdcEndPointId& endPointId)
 {
-    ++m_idCounter;
-    return m_idCounter;
+    UdcClient client;
+
+    if (!m_clients.emplace(address, pingPeriod, timeoutPeriod, endPointId) || !m_clients.find(endPointId, client))
+    {
+        return false;
+    }
+
+    // Every timer can expire at once, so reserve room for all of them up front
+    m_timers.resize(m_clients.slotCount() * UDC_TIMER_COUNT);
+    m_expiredTimers.reserve(m_clients.slotCount() * UDC_TIMER_COUNT);
+
+    client.startConnecting(time);
+    ++m_pendingClientCount;
+
+    if (m_orderedConnectionEvents)
+    {
+        // The address is replaced by the one the handshake comes from once the connection resolves
+        m_connectionOrder.push_back({endPointId, UDC_EVENT_CONNECTION_TIMEOUT, false, address});
+    }
+
+    // Every pending client tries to connect at the same time
+    scheduleTimer(endPointId, UDC_TIMER_CONNECT, time);
+
+    return true;
 }
 
-void UdcServerImpl::addPendingClient(std::shared_ptr<UdcClient> client, std::chrono::milliseconds time)
+bool UdcServerImpl::addPendingClient(
+    const UdcResolver::Addresses& addresses,
+    std::chrono::microseconds pingPeriod,
+    std::chrono::microseconds timeoutPeriod,
+    std::chrono::microseconds time,
+    UdcEndPointId& endPointId)
 {
-    client->startConnecting(time);
-    m_pendingClients.push_back(std::move(client));
+    UdcAddressMux address;
+    UdcAddressMux alternate;
+    bool race = chooseAddresses(addresses, address, alternate);
+
+    UdcClient client;
+
+    if (!addPendingClient(address, pingPeriod, timeoutPeriod, time, endPointId) || !m_clients.find(endPointId, client))
+    {
+        return false;
+    }
+
+    if (race)
+    {
+        client.setAlternateAddress(alternate);
+    }
+
+    return true;
 }
 
-void UdcServerImpl::disconnectFromClient(UdcEndPointId endPointId)
+bool UdcServerImpl::addResolvingClient(
+    const char* nodeName,
+    const char* serviceName,
+    std::chrono::microseconds pingPeriod,
+    std::chrono::microseconds timeoutPeriod,
+    std::chrono::microseconds time,
+    UdcEndPointId& endPointId)
 {
-    // First try to remove from client id and address hash maps
-    // if they aren't there, then it could still be in the pending queue
+    // The address is filled in by applyResolvedAddresses()
+    UdcClient client;
+
+    if (!addPendingClient(UdcAddressMux{}, pingPeriod, timeoutPeriod, time, endPointId) || !m_clients.find(endPointId, client))
     {
-        auto it = m_clientsById.find(endPointId);
+        return false;
+    }
 
-        if (it != m_clientsById.end())
-        {
-            auto* client = it->second.get();
+    client.startResolving();
 
-            // Remove client from clients by address
-            m_clientsByAddress.erase(client->outgoingAddress());
+    m_resolver.resolveAsync(nodeName, serviceName, endPointId);
 
-            // Remove client from clients by id
-            m_clientsById.erase(it);
+    return true;
+}
 
-            return;
-        }
+bool UdcServerImpl::resolveAddress(const char* nodeName, const char* serviceName, UdcResolver::Addresses& addresses)
+{
+    return m_resolver.resolve(nodeName, serviceName, addresses);
+}
+
+void UdcServerImpl::setResolverTtl(std::chrono::microseconds positiveTtl, std::chrono::microseconds negativeTtl)
+{
+    m_resolver.setTtl(positiveTtl, negativeTtl);
+}
+
+void UdcServerImpl::disconnectFromClient(UdcEndPointId endPointId)
+{
+    UdcClient client;
+
+    if (!m_clients.find(endPointId, client))
+    {
+        return;
     }
 
-    // Try to remove client from pending
-    for (auto it = m_pendingClients.begin(); it != m_pendingClients.end();)
+    cancelTimers(endPointId);
+
+    if (client.pending())
     {
-        auto& client = *it;
+        --m_pendingClientCount;
 
-        if (client->id() == endPointId)
+        // Remove client from the connection order, there won't be an event for it
+        for (auto it = m_connectionOrder.begin(); it != m_connectionOrder.end(); ++it)
         {
-            it = m_pendingClients.erase(it);
-        }
-        else
-        {
-            ++it;
+            if (it->endPointId == endPointId)
+            {
+                m_connectionOrder.erase(it);
+                break;
+            }
         }
+
+        // Later clients may have been waiting on this one
+        releaseOrderedConnections(currentTime());
+    }
+    else
+    {
+        releaseReliableMessages(client);
+
+        // Remove client from clients by address
+        m_clientsByAddress.erase(client.outgoingAddress());
+
+        // Forget the reliable state of messages received from the client
+        m_reliableStates.erase(client.outgoingAddress());
     }
+
+    // Remove client from clients by id
+    m_clients.erase(endPointId);
 }
 
-bool UdcServerImpl::sendUnreliableMessage(UdcEndPointId endPointId, const uint8_t* data, uint32_t size)
+bool UdcServerImpl::createSendQueue(uint32_t capacity)
 {
-    if (size + serial::msgUnreliable::SIZE > m_messageBufferSize)
+    if (m_sendQueue != nullptr || capacity == 0 || capacity > UdcSendQueue::MAX_CAPACITY)
     {
         return false;
     }
 
-    UdcClient* client;
-    if (!tryGetClient(endPointId, &client))
+    m_sendQueue = std::make_unique<UdcSendQueue>(capacity, m_messageBufferSize - serial::msgReliable::SIZE);
+
+    return true;
+}
+
+bool UdcServerImpl::queueMessage(UdcEndPointId endPointId, const UdcSegment* segments, uint32_t segmentCount, UdcMessageType reliability)
+{
+    if (m_sendQueue == nullptr)
     {
         return false;
     }
 
-    if (!client->connected())
+    if (!m_sendQueue->push(endPointId, segments, segmentCount, reliability))
     {
-        return true;
+        return false;
     }
 
-    serial::msgHeader::serializeMsgId(m_messageBuffer, UDC_MSG_UNRELIABLE);
-    serial::msgUnreliable::serializeData(m_messageBuffer, data, size);
+    // The event is read after the thread is started, and stays valid once it has been
+    if (m_ioRunning.load(std::memory_order_acquire) && m_ioWakeEvent != nullptr)
+    {
+        m_ioWakeEvent->signal();
+    }
 
-    m_socket.send(client->outgoingAddress(), m_messageBuffer, serial::msgHeader::SIZE + size);
     return true;
 }
 
-bool UdcServerImpl::sendReliableMessage(UdcEndPointId endPointId, const uint8_t* data, uint32_t size)
+void UdcServerImpl::flushSendQueue()
+{
+    if (m_sendQueue == nullptr)
+    {
+        return;
+    }
+
+    UdcSendQueue::Submission submission;
+
+    while (m_sendQueue->front(submission))
+    {
+        UdcSegment segment = {submission.data, submission.size};
+
+        // The submitting thread can't be told about a failure, so it's dropped like a lost packet
+        bool sent = (submission.reliability == UDC_UNRELIABLE_MESSAGE)
+            ? sendUnreliableMessage(submission.endPointId, &segment, 1)
+            : sendReliableMessage(submission.endPointId, &segment, 1);
+
+        static_cast<void>(sent);
+
+        m_sendQueue->pop();
+    }
+}
+
+bool UdcServerImpl::startIoThread(uint32_t eventCapacity, std::chrono::microseconds period)
+{
+    if (m_ioMode || eventCapacity == 0 || eventCapacity > UdcSendQueue::MAX_CAPACITY)
+    {
+        return false;
+    }
+
+    // Sends from the application go through the send queue
+    if (m_sendQueue == nullptr)
+    {
+        m_sendQueue = std::make_unique<UdcSendQueue>(eventCapacity, m_messageBufferSize - serial::msgReliable::SIZE);
+    }
+
+    // A slot is only ever released once while it's held, so every slot fits
+    m_ioEvents = std::make_unique<UdcSpscQueue<UdcEvent>>(eventCapacity);
+    m_ioReleasedSlots = std::make_unique<UdcSpscQueue<uint32_t>>(m_slotCount);
+    m_ioReturnedSlots.clear();
+
+    // Messages taken before the thread started are still held by the application
+    m_ioHeldSlots = m_heldSlots;
+
+    // A busy-polling thread sleeps on its sockets, so a queued message signals the same event
+    m_ioWakeEvent = (m_ioSpinPeriod.count() != 0) ? receiveEvent() : &m_ioSendEvent;
+    m_ioSendEvent.reset();
+    m_ioPeriod = period;
+
+    m_ioMode = true;
+    m_ioRunning.store(true, std::memory_order_release);
+    m_ioThread = std::thread(&UdcServerImpl::runIoThread, this);
+
+    return true;
+}
+
+void UdcServerImpl::stopIoThread()
+{
+    if (!m_ioMode)
+    {
+        return;
+    }
+
+    m_ioRunning.store(false, std::memory_order_release);
+    m_ioThread.join();
+    m_ioMode = false;
+
+    // This is the only thread now, so the slots of discarded and returned messages are freed directly
+    uint32_t slot;
+
+    while (m_ioReleasedSlots->tryPop(slot))
+    {
+        freeSlot(slot);
+    }
+
+    for (uint32_t returnedSlot : m_ioReturnedSlots)
+    {
+        freeSlot(returnedSlot);
+    }
+
+    m_ioReturnedSlots.clear();
+    m_ioHeldSlots.clear();
+
+    UdcEvent event;
+
+    while (m_ioEvents->tryPop(event))
+    {
+        if (event.eventType == UDC_EVENT_RECEIVE_MESSAGE_IPV4 || event.eventType == UDC_EVENT_RECEIVE_MESSAGE_IPV6)
+        {
+            freeSlot(event.msgIndex / m_messageBufferSize);
+        }
+    }
+}
+
+bool UdcServerImpl::setIoBusyPoll(std::chrono::microseconds spinPeriod)
+{
+    if (m_ioMode)
+    {
+        return false;
+    }
+
+    m_ioSpinPeriod = spinPeriod;
+    return true;
+}
+
+void UdcServerImpl::getIoWaitCounters(uint64_t& spins, uint64_t& sleeps, uint64_t& wakeups) const
+{
+    spins = m_ioSpins.load(std::memory_order_relaxed);
+    sleeps = m_ioSleeps.load(std::memory_order_relaxed);
+    wakeups = m_ioWakeups.load(std::memory_order_relaxed);
+}
+
+bool UdcServerImpl::ioThreadRunning() const
+{
+    return m_ioMode;
+}
+
+void* UdcServerImpl::eventHandle()
+{
+    if (m_ioMode)
+    {
+        return nullptr;
+    }
+
+    auto* event = receiveEvent();
+
+    return (event != nullptr) ? event->handle() : nullptr;
+}
+
+std::chrono::microseconds UdcServerImpl::nextTimeout(std::chrono::microseconds time) const
+{
+    bool ready =
+        m_ioMode ||
+        !m_connectionEvents.empty() ||
+        m_expiredIndex != m_expiredTimers.size() ||
+        m_resolver.hasResults() ||
+        hasQueuedMessage();
+
+    if (ready)
+    {
+        return std::chrono::microseconds(0);
+    }
+
+    uint64_t deadline = m_timers.nextDeadline();
+
+    if (deadline == UdcTimerWheel::NEVER)
+    {
+        return std::chrono::microseconds::max();
+    }
+
+    return std::chrono::microseconds(std::max<int64_t>(0, static_cast<int64_t>(deadline) - time.count()));
+}
+
+bool UdcServerImpl::waitForEvents(std::chrono::microseconds timeout)
+{
+    auto* event = m_ioMode ? nullptr : receiveEvent();
+
+    if (event == nullptr)
+    {
+        std::this_thread::sleep_for(timeout);
+        return false;
+    }
+
+    return event->wait(timeout);
+}
+
+std::unique_lock<std::mutex> UdcServerImpl::lockState()
+{
+    if (!m_ioMode)
+    {
+        return std::unique_lock<std::mutex>();
+    }
+
+    return std::unique_lock<std::mutex>(m_stateMutex);
+}
+
+void UdcServerImpl::runIoThread()
+{
+    // Endpoints are moved into memory written by this thread, which places it on the thread's NUMA node
+    if (m_ioProcessors.mask != 0 && UdcThreadPlacement::pinCurrentThread(m_ioProcessors))
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        m_clients.relocate();
+    }
+
+    while (m_ioRunning.load(std::memory_order_acquire))
+    {
+        bool receiving;
+
+        {
+            std::lock_guard<std::mutex> lock(m_stateMutex);
+            receiving = updateIo(currentTime());
+        }
+
+        waitForIo(receiving);
+    }
+}
+
+void UdcServerImpl::waitForIo(bool receiving)
+{
+    // A message queued after the last pass flushed the queue is sent without waiting
+    if (hasQueuedMessage())
+    {
+        return;
+    }
+
+    // The sockets aren't received from while the application is behind, so their event stays set
+    // and the thread would spin on it instead of waiting for the application
+    if (!receiving)
+    {
+        std::this_thread::sleep_for(m_ioPeriod);
+        return;
+    }
+
+    if (m_ioSpinPeriod.count() == 0)
+    {
+        // Reset after waking, any message queued before then is sent by the next pass
+        if (m_ioWakeEvent != nullptr)
+        {
+            static_cast<void>(m_ioWakeEvent->wait(m_ioPeriod));
+            m_ioWakeEvent->reset();
+        }
+        else
+        {
+            std::this_thread::sleep_for(m_ioPeriod);
+        }
+
+        return;
+    }
+
+    // Spinning answers a packet that arrives soon after the last one as quickly as possible
+    // only the event is polled, since the application can bind sockets while this thread runs,
+    // and the list of sockets is only read under the state lock
+    auto spinEnd = std::chrono::steady_clock::now() + m_ioSpinPeriod;
+
+    do
+    {
+        if ((m_ioWakeEvent != nullptr && m_ioWakeEvent->wait(std::chrono::microseconds(0))) || hasQueuedMessage())
+        {
+            m_ioSpins.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    while (std::chrono::steady_clock::now() < spinEnd && m_ioRunning.load(std::memory_order_relaxed));
+
+    // Then the thread sleeps until a packet arrives, a message is queued, or it's time to update timers
+    // the sockets reset the event when they're received from, so it isn't reset here
+    m_ioSleeps.fetch_add(1, std::memory_order_relaxed);
+
+    // Without an event the thread can only sleep for the period
+    if (m_ioWakeEvent == nullptr)
+    {
+        std::this_thread::sleep_for(m_ioPeriod);
+    }
+    else if (m_ioWakeEvent->wait(m_ioPeriod))
+    {
+        m_ioWakeups.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool UdcServerImpl::hasQueuedMessage() const
+{
+    UdcSendQueue::Submission submission;
+    return m_sendQueue != nullptr && m_sendQueue->front(submission);
+}
+
+bool UdcServerImpl::updateIo(std::chrono::microseconds time)
+{
+    uint32_t slot;
+
+    while (m_ioReleasedSlots->tryPop(slot))
+    {
+        freeSlot(slot);
+    }
+
+    flushSendQueue();
+
+    // An event is only taken once there is room for it, so none are lost
+    // while the application is behind, timers and messages wait for the next pass
+    const UdcEvent* event;
+
+    while (!m_ioEvents->full() && (event = updateTimers(time)) != nullptr)
+    {
+        static_cast<void>(m_ioEvents->tryPush(*event));
+    }
+
+    while (!m_ioEvents->full() && (event = receiveMessages(time)) != nullptr)
+    {
+        static_cast<void>(m_ioEvents->tryPush(*event));
+    }
+
+    return !m_ioEvents->full() && m_currentSlot != NO_SLOT;
+}
+
+void UdcServerImpl::returnIoSlots()
+{
+    // Each slot is returned once per message, so the queue has room for all of them,
+    // but any that don't fit are kept for the next call rather than lost
+    size_t returned = 0;
+
+    while (returned != m_ioReturnedSlots.size() && m_ioReleasedSlots->tryPush(m_ioReturnedSlots[returned]))
+    {
+        ++returned;
+    }
+
+    m_ioReturnedSlots.erase(m_ioReturnedSlots.begin(), m_ioReturnedSlots.begin() + returned);
+}
+
+void UdcServerImpl::trackIoMessage(uint32_t slot)
+{
+    // Without manual release, the message is finished with by the next call
+    if (m_manualRelease)
+    {
+        m_ioHeldSlots[slot] = true;
+    }
+    else
+    {
+        m_ioReturnedSlots.push_back(slot);
+    }
+}
+
+const UdcEvent* UdcServerImpl::popIoEvent()
+{
+    returnIoSlots();
+
+    while (m_ioEvents->tryPop(m_ioEventBuffer))
+    {
+        bool message =
+            m_ioEventBuffer.eventType == UDC_EVENT_RECEIVE_MESSAGE_IPV4 ||
+            m_ioEventBuffer.eventType == UDC_EVENT_RECEIVE_MESSAGE_IPV6;
+
+        if (message)
+        {
+            trackIoMessage(m_ioEventBuffer.msgIndex / m_messageBufferSize);
+        }
+
+        if (!dispatchEvent(&m_ioEventBuffer))
+        {
+            return &m_ioEventBuffer;
+        }
+
+        // A message passed to its callback is finished with as soon as it returns
+        returnIoSlots();
+    }
+
+    return nullptr;
+}
+
+uint32_t UdcServerImpl::popIoEvents(UdcEvent* events, uint32_t capacity)
+{
+    returnIoSlots();
+
+    uint32_t count = 0;
+
+    while (count != capacity && m_ioEvents->tryPop(events[count]))
+    {
+        const UdcEvent& event = events[count];
+
+        bool message =
+            event.eventType == UDC_EVENT_RECEIVE_MESSAGE_IPV4 ||
+            event.eventType == UDC_EVENT_RECEIVE_MESSAGE_IPV6;
+
+        if (message)
+        {
+            trackIoMessage(event.msgIndex / m_messageBufferSize);
+        }
+
+        if (!dispatchEvent(&event))
+        {
+            ++count;
+        }
+    }
+
+    return count;
+}
+
+bool UdcServerImpl::getReliableProgress(UdcEndPointId endPointId, uint64_t& acknowledged, uint32_t& queued)
+{
+    UdcClient client;
+
+    if (!tryGetClient(endPointId, client))
+    {
+        return false;
+    }
+
+    acknowledged = client.reliableAcknowledged();
+    queued = client.reliableMessages().size();
+
+    return true;
+}
+
+bool UdcServerImpl::setEndPointContext(UdcEndPointId endPointId, void* context)
+{
+    UdcClient client;
+
+    if (!m_clients.find(endPointId, client))
+    {
+        return false;
+    }
+
+    client.setContext(context);
+
+    return true;
+}
+
+bool UdcServerImpl::setOrderedConnectionEvents(bool ordered)
+{
+    if (m_pendingClientCount != 0)
+    {
+        return false;
+    }
+
+    m_orderedConnectionEvents = ordered;
+    return true;
+}
+
+bool UdcServerImpl::setReliableStateLimits(uint32_t capacity, std::chrono::microseconds idleTimeout)
+{
+    if (capacity == 0 || idleTimeout <= std::chrono::microseconds(0))
+    {
+        return false;
+    }
+
+    m_reliableStates.setCapacity(capacity);
+    m_reliableStates.setIdleTimeout(idleTimeout);
+
+    return true;
+}
+
+void UdcServerImpl::getReliableStateMetrics(uint32_t& size, uint64_t& evictions, uint64_t& expirations) const
+{
+    size = m_reliableStates.size();
+    evictions = m_reliableStates.evictions();
+    expirations = m_reliableStates.expirations();
+}
+
+bool UdcServerImpl::getStats(UdcEndPointId endPointId, UdcStats& stats)
+{
+    stats = {};
+
+    if (endPointId != 0)
+    {
+        UdcClient client;
+
+        if (!m_clients.find(endPointId, client))
+        {
+            return false;
+        }
+
+        client.stats().copyTo(stats);
+        stats.reliableQueued = client.reliableMessages().size();
+
+        return true;
+    }
+
+    m_stats.copyTo(stats);
+    stats.signatureMismatches = m_signatureMismatches;
+    stats.oversizedDrops = m_socket.oversizedDrops();
+    stats.malformedDrops = m_malformedDrops;
+
+    // Only read here, so the queues are summed rather than kept up to date
+    for (uint32_t index = 0; index != m_clients.slotCount(); ++index)
+    {
+        UdcClient client;
+
+        if (m_clients.atIndex(index, client))
+        {
+            stats.reliableQueued += client.reliableMessages().size();
+        }
+    }
+
+    stats.sendQueueDepth = (m_sendQueue != nullptr) ? m_sendQueue->size() : 0;
+    stats.eventQueueDepth = m_ioMode ? m_ioEvents->size() : 0;
+
+    return true;
+}
+
+bool UdcServerImpl::sendUnreliableMessage(UdcEndPointId endPointId, const UdcSegment* segments, uint32_t segmentCount)
+{
+    uint32_t size;
+    if (!tryGetMessageSize(segments, segmentCount, size) || size > m_messageBufferSize - serial::msgUnreliable::SIZE)
+    {
+        return false;
+    }
+
+    UdcClient client;
+    if (!tryGetClient(endPointId, client))
+    {
+        return false;
+    }
+
+    if (!client.connected())
+    {
+        return true;
+    }
+
+    // Only the header is written here, the segments are sent from where they are
+    uint8_t header[serial::msgUnreliable::SIZE];
+    serial::msgHeader::serializeMsgSignature(header, m_packetSignature);
+    serial::msgHeader::serializeMsgId(header, UDC_MSG_UNRELIABLE);
+
+    UdcSegment message[UdcSocket::MAX_SEGMENTS];
+    message[0] = {header, sizeof(header)};
+    std::copy(segments, segments + segmentCount, message + 1);
+
+    sendPacket(client.outgoingAddress(), message, segmentCount + 1, &client.stats());
+    return true;
+}
+
+bool UdcServerImpl::sendReliableMessage(UdcEndPointId endPointId, const UdcSegment* segments, uint32_t segmentCount)
+{
+    uint32_t size;
+    if (!tryGetMessageSize(segments, segmentCount, size) || size > m_messageBufferSize - serial::msgReliable::SIZE)
+    {
+        return false;
+    }
+
+    UdcClient client;
+    if (!tryGetClient(endPointId, client))
+    {
+        return false;
+    }
+
+    auto* msg = m_messagePool.acquire(segments, segmentCount, size);
+
+    if (msg == nullptr)
+    {
+        return false;
+    }
+
+    client.reliableMessages().push(msg);
+
+    // Send right away if nothing else is waiting for a handshake
+    if (client.reliableMessages().size() == 1)
+    {
+        scheduleTimer(endPointId, UDC_TIMER_RELIABLE, std::chrono::microseconds(0));
+    }
+
+    return true;
+}
+
+bool UdcServerImpl::createGroup(UdcGroupId& groupId)
+{
+    return m_groups.create(groupId);
+}
+
+bool UdcServerImpl::deleteGroup(UdcGroupId groupId)
+{
+    return m_groups.erase(groupId);
+}
+
+bool UdcServerImpl::addToGroup(UdcGroupId groupId, UdcEndPointId endPointId)
+{
+    UdcClient client;
+    if (!m_clients.find(endPointId, client))
+    {
+        return false;
+    }
+
+    return m_groups.add(groupId, endPointId);
+}
+
+bool UdcServerImpl::removeFromGroup(UdcGroupId groupId, UdcEndPointId endPointId)
+{
+    return m_groups.remove(groupId, endPointId);
+}
+
+bool UdcServerImpl::sendGroupMessage(UdcGroupId groupId, const UdcSegment* segments, uint32_t segmentCount, UdcMessageType reliability)
+{
+    auto* members = m_groups.members(groupId);
+
+    if (members == nullptr)
+    {
+        return false;
+    }
+
+    uint32_t headerSize = (reliability == UDC_UNRELIABLE_MESSAGE)
+        ? serial::msgUnreliable::SIZE
+        : serial::msgReliable::SIZE;
+
+    uint32_t size;
+    if (!tryGetMessageSize(segments, segmentCount, size) || size > m_messageBufferSize - headerSize)
+    {
+        return false;
+    }
+
+    // Gather connected members, and drop members that have been disconnected
+    m_groupAddresses.clear();
+
+    UdcPooledMessage* msg = nullptr;
+    uint32_t queued = 0;
+
+    for (uint32_t i = 0; i < members->size();)
+    {
+        UdcEndPointId endPointId = (*members)[i];
+
+        UdcClient client;
+        if (!m_clients.find(endPointId, client))
+        {
+            (*members)[i] = members->back();
+            members->pop_back();
+            continue;
+        }
+
+        ++i;
+
+        if (reliability == UDC_UNRELIABLE_MESSAGE)
+        {
+            if (client.connected())
+            {
+                m_groupAddresses.push_back(client.outgoingAddress());
+                client.stats().countSent(UDC_MSG_UNRELIABLE, serial::msgUnreliable::SIZE + size);
+            }
+
+            continue;
+        }
+
+        if (client.pending())
+        {
+            continue;
+        }
+
+        // Every member's queue shares the same payload
+        if (msg == nullptr)
+        {
+            msg = m_messagePool.acquire(segments, segmentCount, size);
+
+            if (msg == nullptr)
+            {
+                return false;
+            }
+        }
+
+        client.reliableMessages().push(msg);
+        ++queued;
+
+        // Send right away if nothing else is waiting for a handshake
+        if (client.reliableMessages().size() == 1)
+        {
+            scheduleTimer(endPointId, UDC_TIMER_RELIABLE, std::chrono::microseconds(0));
+        }
+    }
+
+    if (msg != nullptr)
+    {
+        // The block was acquired with the first member's reference
+        m_messagePool.retain(msg, queued - 1);
+    }
+
+    if (m_groupAddresses.empty())
+    {
+        return true;
+    }
+
+    // The datagram is the same for every member, so the header is only written once
+    uint8_t header[serial::msgUnreliable::SIZE];
+    serial::msgHeader::serializeMsgSignature(header, m_packetSignature);
+    serial::msgHeader::serializeMsgId(header, UDC_MSG_UNRELIABLE);
+
+    UdcSegment message[UdcSocket::MAX_SEGMENTS];
+    message[0] = {header, sizeof(header)};
+    std::copy(segments, segments + segmentCount, message + 1);
+
+    m_socket.send(m_groupAddresses.data(), static_cast<uint32_t>(m_groupAddresses.size()), message, segmentCount + 1);
+
+    for (size_t i = 0; i != m_groupAddresses.size(); ++i)
+    {
+        m_stats.countSent(UDC_MSG_UNRELIABLE, serial::msgUnreliable::SIZE + size);
+    }
+
+    return true;
+}
+
+const UdcEvent* UdcServerImpl::receiveMessages(std::chrono::microseconds time)
+{
+    m_messageLimit = NO_MESSAGE_LIMIT;
+    return receivePackets(time);
+}
+
+const UdcEvent* UdcServerImpl::receiveMessages(std::chrono::microseconds time, uint32_t& messageLimit)
+{
+    m_messageLimit = messageLimit;
+    auto* event = receivePackets(time);
+    messageLimit = m_messageLimit;
+
+    return event;
+}
+
+const UdcEvent* UdcServerImpl::receivePackets(std::chrono::microseconds time)
+{
+    UdcSignature signature;
+    UdcMessageId msgId;
+    UdcAddressMux address;
+
+    // Every slot holds a message that hasn't been released
+    if (m_currentSlot == NO_SLOT || m_messageLimit == 0)
+    {
+        return nullptr;
+    }
+
+    uint32_t msgSize;
+
+    // The size is reset for every message, otherwise a short message limits the next one
+    // and receiving stops if a message callback has taken the last free slot, or the limit
+    for (msgSize = m_messageBufferSize;
+        m_currentSlot != NO_SLOT && m_messageLimit != 0 && m_socket.receive(address, m_messageBuffer, msgSize);
+        msgSize = m_messageBufferSize)
+    {
+        // Read message header
+        if (msgSize < serial::msgHeader::SIZE)
+        {
+            ++m_malformedDrops;
+            continue;
+        }
+
+        serial::msgHeader::deserializeMsgSignature(m_messageBuffer, signature);
+
+        if (memcmp(m_packetSignature.bytes, signature.bytes, sizeof(signature.bytes)) != 0)
+        {
+            // Write message correct signature back into buffer
+            serial::msgHeader::serializeMsgSignature(m_messageBuffer, m_packetSignature);
+            ++m_signatureMismatches;
+            continue;
+        }
+
+        serial::msgHeader::deserializeMsgId(m_messageBuffer, msgId);
+
+        if (!hasValidSize(msgId, msgSize))
+        {
+            ++m_malformedDrops;
+            continue;
+        }
+
+        m_stats.countReceived(msgId, msgSize);
+
+        switch (msgId)
+        {
+            case UDC_MSG_CONNECTION_REQUEST:
+                processConnectionRequest(address);
+                break;
+            case UDC_MSG_CONNECTION_HANDSHAKE:
+                {
+                    auto event = processConnectionHandshake(address, time);
+
+                    if (event != nullptr)
+                    {
+                        return event;
+                    }
+                }
+                break;
+            case UDC_MSG_PING:
+                processPing(address);
+                break;
+            case UDC_MSG_PONG:
+                {
+                    auto event = processPong(address, time);
+
+                    if (event != nullptr)
+                    {
+                        return event;
+                    }
+                }
+                break;
+            case UDC_MSG_UNRELIABLE:
+                {
+                    auto event = processUnreliable(address, msgSize);
+
+                    if (event != nullptr)
+                    {
+                        return event;
+                    }
+                }
+                break;
+            case UDC_MSG_RELIABLE_RESET:
+                {
+                    auto event = processReliableMessage(-1, address, msgSize, time);
+
+                    if (event != nullptr)
+                    {
+                        return event;
+                    }
+                }
+                break;
+            case UDC_MSG_RELIABLE_0:
+                {
+                    auto event = processReliableMessage(0, address, msgSize, time);
+
+                    if (event != nullptr)
+                    {
+                        return event;
+                    }
+                }
+                break;
+            case UDC_MSG_RELIABLE_1:
+                {
+                    auto event = processReliableMessage(1, address, msgSize, time);
+
+                    if (event != nullptr)
+                    {
+                        return event;
+                    }
+                }
+                break;
+            case UDC_MSG_RELIABLE_HANDSHAKE_RESET:
+                {
+                    auto event = processReliableHandshake(-1, address, time);
+
+                    if (event != nullptr)
+                    {
+                        return event;
+                    }
+                }
+                break;
+            case UDC_MSG_RELIABLE_HANDSHAKE_0:
+                {
+                    auto event = processReliableHandshake(0, address, time);
+
+                    if (event != nullptr)
+                    {
+                        return event;
+                    }
+                }
+                break;
+            case UDC_MSG_RELIABLE_HANDSHAKE_1:
+                {
+                    auto event = processReliableHandshake(1, address, time);
+
+                    if (event != nullptr)
+                    {
+                        return event;
+                    }
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    return nullptr;
+}
+
+const UdcEvent* UdcServerImpl::updateTimers(std::chrono::microseconds time)
+{
+    // Connection events released by an earlier call
+    auto* connectionEvent = popConnectionEvent();
+
+    if (connectionEvent != nullptr)
+    {
+        return connectionEvent;
+    }
+
+    bool advanced = false;
+
+    while (true)
+    {
+        // Timers left over from a previous call that returned an event
+        // are handled before the wheel is advanced again
+        if (m_expiredIndex == m_expiredTimers.size())
+        {
+            m_expiredTimers.clear();
+            m_expiredIndex = 0;
+
+            if (advanced)
+            {
+                return nullptr;
+            }
+
+            applyResolvedAddresses(time);
+            m_timers.advance(static_cast<uint64_t>(time.count()), m_expiredTimers);
+            m_reliableStates.expire(time);
+            advanced = true;
+
+            if (m_maintenancePool != nullptr)
+            {
+                updateMaintenanceTimers(time);
+            }
+
+            continue;
+        }
+
+        uint32_t timer = m_expiredTimers[m_expiredIndex++];
+
+        // The client may have been removed (or its slot reused) after the timer expired
+        // so every timer handler re-checks its condition
+        UdcClient client;
+
+        if (!m_clients.atIndex(timer / UDC_TIMER_COUNT, client))
+        {
+            continue;
+        }
+
+        const UdcEvent* event = nullptr;
+
+        switch (timer % UDC_TIMER_COUNT)
+        {
+            case UDC_TIMER_CONNECT:
+                event = updateConnectionAttempt(client, time);
+                break;
+            case UDC_TIMER_PING:
+                updatePing(client, time, m_maintenanceBatches[0]);
+                applyMaintenanceBatch(m_maintenanceBatches[0]);
+                break;
+            case UDC_TIMER_RELIABLE:
+                updateReliable(client, time, m_maintenanceBatches[0]);
+                applyMaintenanceBatch(m_maintenanceBatches[0]);
+                break;
+            case UDC_TIMER_CONNECTION_LOST:
+                event = updateConnectionLost(client, time);
+                break;
+            default:
+                break;
+        }
+
+        if (event != nullptr)
+        {
+            return event;
+        }
+    }
+}
+
+const UdcEvent* UdcServerImpl::updateConnectionAttempt(UdcClient client, std::chrono::microseconds time)
+{
+    if (!client.pending())
+    {
+        return nullptr;
+    }
+
+    // Check if trying to connect is taking too long
+    if (client.needsConnectionTimeoutEvent(time))
+    {
+        UdcEndPointId endPointId = client.id();
+
+        if (m_orderedConnectionEvents)
+        {
+            cancelTimer(endPointId, UDC_TIMER_CONNECT);
+            return resolveOrderedConnection(endPointId, UDC_EVENT_CONNECTION_TIMEOUT, client.outgoingAddress(), time);
+        }
+
+        removeTimedOutClient(client);
+        return connectionEvent(UDC_EVENT_CONNECTION_TIMEOUT, endPointId);
+    }
+
+    uint8_t msg[serial::msgConnection::SIZE];
+    serial::msgHeader::serializeMsgSignature(msg, m_packetSignature);
+    serial::msgHeader::serializeMsgId(msg, UDC_MSG_CONNECTION_REQUEST);
+    serial::msgConnection::serializeEndPointId(msg, client.id());
+
+    // Check if it has been long enough to send another connection request
+    // there's nowhere to send it until the address has been looked up
+    if (!client.resolving() && client.needsConnectionAttempt(time))
+    {
+        client.retryConnecting(time);
+
+        sendPacket(client.outgoingAddress(), msg, sizeof(msg), &client.stats());
+
+        if (client.raceStarted())
+        {
+            sendPacket(client.alternateAddress(), msg, sizeof(msg), &client.stats());
+        }
+    }
+
+    // Start racing the other family if the first hasn't answered
+    if (client.needsAlternateAttempt(time))
+    {
+        client.startRace();
+
+        sendPacket(client.alternateAddress(), msg, sizeof(msg), &client.stats());
+    }
+
+    scheduleTimer(client.id(), UDC_TIMER_CONNECT, client.nextConnectionAttemptTime());
+    return nullptr;
+}
+
+void UdcServerImpl::applyResolvedAddresses(std::chrono::microseconds time)
+{
+    m_resolver.takeResults(m_resolvedAddresses);
+
+    for (const auto& result : m_resolvedAddresses)
+    {
+        UdcClient client;
+
+        // The client may have been disconnected while its address was looked up
+        if (!m_clients.find(result.endPointId, client) || !client.resolving())
+        {
+            continue;
+        }
+
+        UdcAddressMux address;
+        UdcAddressMux alternate;
+
+        if (result.addresses.count == 0)
+        {
+            client.failResolving(time);
+        }
+        else if (chooseAddresses(result.addresses, address, alternate))
+        {
+            client.finishResolving(address);
+            client.setAlternateAddress(alternate);
+        }
+        else
+        {
+            client.finishResolving(address);
+        }
+
+        scheduleTimer(result.endPointId, UDC_TIMER_CONNECT, time);
+    }
+}
+
+bool UdcServerImpl::chooseAddresses(const UdcResolver::Addresses& addresses, UdcAddressMux& address, UdcAddressMux& alternate) const
+{
+    address = addresses.address[0];
+
+    if (addresses.count < 2)
+    {
+        return false;
+    }
+
+    bool firstBound = m_socket.isBound(addresses.address[0].family);
+    bool secondBound = m_socket.isBound(addresses.address[1].family);
+
+    if (firstBound && secondBound)
+    {
+        alternate = addresses.address[1];
+        return true;
+    }
+
+    if (secondBound)
+    {
+        address = addresses.address[1];
+    }
+
+    return false;
+}
+
+void UdcServerImpl::updatePing(UdcClient client, std::chrono::microseconds time, UdcMaintenanceBatch& batch) const
+{
+    if (client.pending())
+    {
+        return;
+    }
+
+    if (!client.needsPing(time))
+    {
+        batch.timers.push_back({client.id(), UDC_TIMER_PING, client.nextPingTime()});
+        return;
+    }
+
+    // Send PING
+    auto offset = static_cast<uint32_t>(batch.headers.size());
+    batch.headers.resize(offset + serial::msgPingPong::SIZE);
+
+    uint8_t* msg = batch.headers.data() + offset;
+    serial::msgHeader::serializeMsgSignature(msg, m_packetSignature);
+    serial::msgHeader::serializeMsgId(msg, UDC_MSG_PING);
+    serial::msgPingPong::serializeTimeStamp(msg, static_cast<uint32_t>(time.count()));
+
+    batch.sends.push_back({client.outgoingAddress(), offset, serial::msgPingPong::SIZE, nullptr, 0});
+    client.stats().countSent(UDC_MSG_PING, serial::msgPingPong::SIZE);
+
+    // Keep pinging until a PONG arrives
+    batch.timers.push_back({client.id(), UDC_TIMER_PING, time + client.retransmitPeriod()});
+}
+
+void UdcServerImpl::updateReliable(UdcClient client, std::chrono::microseconds time, UdcMaintenanceBatch& batch) const
+{
+    if (client.pending() || client.reliableMessages().empty())
+    {
+        return;
+    }
+
+    // Reset the reliable state if the handshake is taking too long
+    if (client.reliableState() != -1 && client.needsReliableReset(time))
+    {
+        client.setReliableState(-1);
+        client.resetSendReliable();
+    }
+
+    int reliableState = client.reliableState();
+
+    auto offset = static_cast<uint32_t>(batch.headers.size());
+    batch.headers.resize(offset + serial::msgReliable::SIZE);
+
+    uint8_t* header = batch.headers.data() + offset;
+    serial::msgHeader::serializeMsgSignature(header, m_packetSignature);
+    serial::msgReliable::serializeTimeStamp(header, static_cast<uint32_t>(time.count()));
+
+    if (reliableState == -1)
+    {
+        serial::msgHeader::serializeMsgId(header, UDC_MSG_RELIABLE_RESET);
+
+        batch.sends.push_back({client.outgoingAddress(), offset, serial::msgReliable::SIZE, nullptr, 0});
+        client.stats().countSent(UDC_MSG_RELIABLE_RESET, serial::msgReliable::SIZE);
+    }
+    else
+    {
+        auto* msg = client.reliableMessages().front();
+
+        serial::msgHeader::serializeMsgId(header, (reliableState == 0)
+            ? UDC_MSG_RELIABLE_0
+            : UDC_MSG_RELIABLE_1);
+
+        // The payload is sent straight from the pooled block
+        batch.sends.push_back({client.outgoingAddress(), offset, serial::msgReliable::SIZE, msg->data(), msg->size});
+        client.stats().countSent(UDC_MSG_RELIABLE_0, serial::msgReliable::SIZE + msg->size);
+
+        // Already sent, and not acknowledged in time
+        if (client.awaitingReliableHandshake())
+        {
+            ++client.stats().retransmissions;
+            ++batch.retransmissions;
+        }
+
+        client.setSendReliable(time);
+    }
+
+    // Resend until the handshake arrives
+    batch.timers.push_back({client.id(), UDC_TIMER_RELIABLE, time + client.retransmitPeriod()});
+}
+
+void UdcServerImpl::updateMaintenanceTimers(std::chrono::microseconds time)
+{
+    // Ping and reliable timers are moved out, the rest stay for the calling thread
+    m_maintenanceTimers.clear();
+
+    uint32_t kept = m_expiredIndex;
+
+    for (uint32_t i = m_expiredIndex; i != m_expiredTimers.size(); ++i)
+    {
+        uint32_t timer = m_expiredTimers[i];
+        uint32_t kind = timer % UDC_TIMER_COUNT;
+
+        if (kind == UDC_TIMER_PING || kind == UDC_TIMER_RELIABLE)
+        {
+            m_maintenanceTimers.push_back(timer);
+        }
+        else
+        {
+            m_expiredTimers[kept++] = timer;
+        }
+    }
+
+    m_expiredTimers.resize(kept);
+
+    auto timerCount = static_cast<uint32_t>(m_maintenanceTimers.size());
+    uint32_t itemCount = (timerCount + MAINTENANCE_ITEM_SIZE - 1) / MAINTENANCE_ITEM_SIZE;
+
+    // Every timer belongs to one client, and a worker only changes the client of the timer
+    // it's handling, so the workers only share reads of the tables
+    auto work = [&](uint32_t worker, uint32_t item)
+    {
+        auto& batch = m_maintenanceBatches[worker];
+
+        uint32_t begin = item * MAINTENANCE_ITEM_SIZE;
+        uint32_t end = std::min(begin + MAINTENANCE_ITEM_SIZE, timerCount);
+
+        for (uint32_t i = begin; i != end; ++i)
+        {
+            uint32_t timer = m_maintenanceTimers[i];
+            UdcClient client;
+
+            if (!m_clients.atIndex(timer / UDC_TIMER_COUNT, client))
+            {
+                continue;
+            }
+
+            if (timer % UDC_TIMER_COUNT == UDC_TIMER_PING)
+            {
+                updatePing(client, time, batch);
+            }
+            else
+            {
+                updateReliable(client, time, batch);
+            }
+        }
+    };
+
+    m_maintenancePool->run(itemCount, work);
+
+    for (auto& batch : m_maintenanceBatches)
+    {
+        applyMaintenanceBatch(batch);
+    }
+}
+
+void UdcServerImpl::applyMaintenanceBatch(UdcMaintenanceBatch& batch)
+{
+    for (const auto& send : batch.sends)
+    {
+        UdcSegment message[] = {
+            {batch.headers.data() + send.headerOffset, send.headerSize},
+            {send.payload, send.payloadSize}};
+
+        sendPacket(send.address, message, (send.payload != nullptr) ? 2 : 1, nullptr);
+    }
+
+    m_stats.retransmissions += batch.retransmissions;
+    batch.retransmissions = 0;
+
+    for (const auto& reschedule : batch.timers)
+    {
+        scheduleTimer(reschedule.endPointId, reschedule.timer, reschedule.time);
+    }
+
+    batch.headers.clear();
+    batch.sends.clear();
+    batch.timers.clear();
+}
+
+bool UdcServerImpl::setMaintenanceThreads(uint32_t threadCount)
+{
+    if (threadCount > UdcWorkerPool::MAX_WORKERS)
+    {
+        return false;
+    }
+
+    m_maintenancePool.reset();
+
+    if (threadCount > 1)
+    {
+        m_maintenancePool = std::make_unique<UdcWorkerPool>(threadCount, m_maintenanceProcessors);
+    }
+
+    m_maintenanceBatches.resize(std::max(threadCount, 1u));
+    return true;
+}
+
+bool UdcServerImpl::setThreadAffinity(UdcThreadRole role, const UdcProcessorSet& processors)
+{
+    switch (role)
+    {
+        case UDC_THREAD_IO:
+            if (m_ioMode)
+            {
+                return false;
+            }
+
+            m_ioProcessors = processors;
+            return true;
+        case UDC_THREAD_MAINTENANCE:
+            m_maintenanceProcessors = processors;
+
+            // Restart the workers on their new processors
+            if (m_maintenancePool != nullptr)
+            {
+                m_maintenancePool = std::make_unique<UdcWorkerPool>(m_maintenancePool->workerCount(), processors);
+            }
+
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool UdcServerImpl::reserveEndPoints(uint32_t count)
 {
-    if (size + serial::msgReliable::SIZE > m_messageBufferSize)
+    if (!m_clients.reserve(count))
     {
         return false;
     }
 
-    UdcClient* client;
-    if (!tryGetClient(endPointId, &client))
-    {
-        return false;
-    }
+    // Every timer can expire at once
+    m_timers.resize(m_clients.slotCount() * UDC_TIMER_COUNT);
+    m_expiredTimers.reserve(m_clients.slotCount() * UDC_TIMER_COUNT);
 
-    client->reliableMessages().push(std::vector<uint8_t>(data, data + size));
     return true;
 }
 
-const UdcEvent* UdcServerImpl::receiveMessages(std::chrono::milliseconds time)
+const UdcEvent* UdcServerImpl::updateConnectionLost(UdcClient client, std::chrono::microseconds time)
 {
-    UdcSignature signature;
-    UdcMessageId msgId;
-    UdcAddressMux address;
-
-    uint32_t msgSize = m_messageBufferSize;
+    if (client.pending() || !client.connected())
+    {
+        return nullptr;
+    }
 
-    while (m_socket.receive(address, m_messageBuffer, msgSize))
+    if (!client.needsConnectionLostEvent(time))
     {
-        // Read message header
-        if (msgSize < serial::msgHeader::SIZE)
-        {
-            continue;
-        }
+        scheduleTimer(client.id(), UDC_TIMER_CONNECTION_LOST, client.connectionLostTime());
+        return nullptr;
+    }
 
-        serial::msgHeader::deserializeMsgSignature(m_messageBuffer, signature);
+    // Throw connection lost event
+    // the timer is scheduled again when the connection is regained
+    client.setConnectionLost();
 
-        if (memcmp(m_packetSignature.bytes, signature.bytes, sizeof(signature.bytes)) != 0)
-        {
-            // Write message correct signature back into buffer
-            serial::msgHeader::serializeMsgSignature(m_messageBuffer, m_packetSignature);
-            continue;
-        }
+    m_eventBuffer.eventType = UDC_EVENT_CONNECTION_LOST;
+    m_eventBuffer.endPointId = client.id();
 
-        serial::msgHeader::deserializeMsgId(m_messageBuffer, msgId);
+    return &m_eventBuffer;
+}
 
-        switch (msgId)
-        {
-            case UDC_MSG_CONNECTION_REQUEST:
-                if (msgSize == serial::msgConnection::SIZE)
-                {
-                    processConnectionRequest(address);
-                }
-                break;
-            case UDC_MSG_CONNECTION_HANDSHAKE:
-                if (msgSize == serial::msgConnection::SIZE)
-                {
-                    auto event = processConnectionHandshake(address, time);
+void UdcServerImpl::scheduleTimer(UdcEndPointId endPointId, UdcTimer timer, std::chrono::microseconds time)
+{
+    m_timers.schedule(
+        UdcEndPointTable::indexOf(endPointId) * UDC_TIMER_COUNT + timer,
+        static_cast<uint64_t>(time.count()));
+}
 
-                    if (event != nullptr)
-                    {
-                        return event;
-                    }
-                }
-                break;
-            case UDC_MSG_PING:
-                if (msgSize == serial::msgPingPong::SIZE)
-                {
-                    processPing(address);
-                }
-                break;
-            case UDC_MSG_PONG:
-                if (msgSize == serial::msgPingPong::SIZE)
-                {
-                    auto event = processPong(address, time);
+void UdcServerImpl::cancelTimer(UdcEndPointId endPointId, UdcTimer timer)
+{
+    m_timers.cancel(UdcEndPointTable::indexOf(endPointId) * UDC_TIMER_COUNT + timer);
+}
 
-                    if (event != nullptr)
-                    {
-                        return event;
-                    }
-                }
-                break;
-            case UDC_MSG_UNRELIABLE:
-                if (msgSize >= serial::msgHeader::SIZE)
-                {
-                    auto event = processUnreliable(address, msgSize);
+void UdcServerImpl::cancelTimers(UdcEndPointId endPointId)
+{
+    uint32_t first = UdcEndPointTable::indexOf(endPointId) * UDC_TIMER_COUNT;
 
-                    if (event != nullptr)
-                    {
-                        return event;
-                    }
-                }
-                break;
-            case UDC_MSG_RELIABLE_RESET:
-                if (msgSize == serial::msgReliable::SIZE)
-                {
-                    auto event = processReliableMessage(-1, address, msgSize);
+    for (uint32_t timer = 0; timer != UDC_TIMER_COUNT; ++timer)
+    {
+        m_timers.cancel(first + timer);
+    }
+}
 
-                    if (event != nullptr)
-                    {
-                        return event;
-                    }
-                }
-                break;
-            case UDC_MSG_RELIABLE_0:
-                if (msgSize >= serial::msgReliable::SIZE)
-                {
-                    auto event = processReliableMessage(0, address, msgSize);
+void UdcServerImpl::completeConnection(UdcClient client, const UdcAddressMux& fromAddress, std::chrono::microseconds time)
+{
+    UdcEndPointId endPointId = client.id();
 
-                    if (event != nullptr)
-                    {
-                        return event;
-                    }
-                }
-                break;
-            case UDC_MSG_RELIABLE_1:
-                if (msgSize >= serial::msgReliable::SIZE)
-                {
-                    auto event = processReliableMessage(1, address, msgSize);
+    // The first family to answer wins, the other stops getting connection requests
+    client.finishRace(fromAddress);
+    client.receiveConnectionHandshake(time);
+    m_clientsByAddress.insert(fromAddress, endPointId);
+    --m_pendingClientCount;
 
-                    if (event != nullptr)
-                    {
-                        return event;
-                    }
-                }
-                break;
-            case UDC_MSG_RELIABLE_HANDSHAKE_RESET:
-                if (msgSize == serial::msgReliable::SIZE)
-                {
-                    auto event = processReliableHandshake(-1, address, time);
+    scheduleTimer(endPointId, UDC_TIMER_PING, time);
+    scheduleTimer(endPointId, UDC_TIMER_CONNECTION_LOST, client.connectionLostTime());
+}
 
-                    if (event != nullptr)
-                    {
-                        return event;
-                    }
-                }
-                break;
-            case UDC_MSG_RELIABLE_HANDSHAKE_0:
-                if (msgSize == serial::msgReliable::SIZE)
-                {
-                    auto event = processReliableHandshake(0, address, time);
+void UdcServerImpl::removeTimedOutClient(UdcClient client)
+{
+    UdcEndPointId endPointId = client.id();
 
-                    if (event != nullptr)
-                    {
-                        return event;
-                    }
-                }
-                break;
-            case UDC_MSG_RELIABLE_HANDSHAKE_1:
-                if (msgSize == serial::msgReliable::SIZE)
-                {
-                    auto event = processReliableHandshake(1, address, time);
+    cancelTimers(endPointId);
 
-                    if (event != nullptr)
-                    {
-                        return event;
-                    }
-                }
-                break;
-            default:
-                break;
-        }
+    // Forget reliable state received from the address, unless another client is connected to it
+    if (m_clientsByAddress.find(client.outgoingAddress()) == nullptr)
+    {
+        m_reliableStates.erase(client.outgoingAddress());
     }
 
-    return nullptr;
+    m_clients.erase(endPointId);
+    --m_pendingClientCount;
 }
 
-const UdcEvent* UdcServerImpl::updatePendingClients(std::chrono::milliseconds time)
+const UdcEvent* UdcServerImpl::connectionEvent(UdcEventType eventType, UdcEndPointId endPointId)
 {
-    // Get first pending client
-    UdcClient* client;
-    if (!tryGetFirstPendingClient(&client))
-    {
-        return nullptr;
-    }
+    m_eventBuffer.eventType = eventType;
+    m_eventBuffer.endPointId = endPointId;
+    return &m_eventBuffer;
+}
 
-    // Check if trying to connect is taking too long
-    if (client->needsConnectionTimeoutEvent(time))
+const UdcEvent* UdcServerImpl::resolveOrderedConnection(
+    UdcEndPointId endPointId,
+    UdcEventType result,
+    const UdcAddressMux& fromAddress,
+    std::chrono::microseconds time)
+{
+    for (auto& connection : m_connectionOrder)
     {
-        // Send a timeout event
-        m_eventBuffer.eventType = UDC_EVENT_CONNECTION_TIMEOUT;
-        m_eventBuffer.endPointId = client->id();
-
-        // Timed-out, remove pending client from the queue
-        m_pendingClients.pop_front();
-
-        return &m_eventBuffer;
+        if (connection.endPointId == endPointId)
+        {
+            connection.result = result;
+            connection.resolved = true;
+            connection.address = fromAddress;
+            break;
+        }
     }
 
-    // Check if it has been long enough to send another connection request
-    if (client->needsConnectionAttempt(time))
-    {
-        client->retryConnecting(time);
-
-        // Send connection request
-        assert(m_messageBufferSize >= serial::msgConnection::SIZE);
-
-        serial::msgHeader::serializeMsgId(m_messageBuffer, UDC_MSG_CONNECTION_REQUEST);
-        serial::msgConnection::serializeEndPointId(m_messageBuffer, client->id());
-
-        m_socket.send(client->outgoingAddress(), m_messageBuffer, serial::msgConnection::SIZE);
-    }
+    releaseOrderedConnections(time);
 
-    return nullptr;
+    return popConnectionEvent();
 }
 
-const UdcEvent* UdcServerImpl::updateClientConnectionStatus(std::chrono::milliseconds time)
+void UdcServerImpl::releaseOrderedConnections(std::chrono::microseconds time)
 {
-    for (auto& pair : m_clientsById)
+    while (!m_connectionOrder.empty() && m_connectionOrder.front().resolved)
     {
-        auto* client = pair.second.get();
+        auto connection = m_connectionOrder.front();
+        m_connectionOrder.pop_front();
 
-        // Send reliable messages
-        if (!client->reliableMessages().empty())
+        UdcClient client;
+        if (!m_clients.find(connection.endPointId, client))
         {
-            int reliableState = client->reliableState();
-
-            if (reliableState == -1)
-            {
-                assert(m_messageBufferSize >= serial::msgReliable::SIZE);
-
-                serial::msgHeader::serializeMsgId(m_messageBuffer, UDC_MSG_RELIABLE_RESET);
-                serial::msgReliable::serializeTimeStamp(m_messageBuffer, time.count());
-
-                m_socket.send(client->outgoingAddress(), m_messageBuffer, serial::msgReliable::SIZE);
-            }
-            else
-            {
-                if (client->needsReliableReset(time))
-                {
-                    client->setReliableState(-1);
-                    client->resetSendReliable();
-                }
-                else
-                {
-                    auto& msg = client->reliableMessages().front();
-
-                    assert(m_messageBufferSize >= serial::msgReliable::SIZE + msg.size());
-
-                    serial::msgHeader::serializeMsgId(m_messageBuffer, (reliableState == 0)
-                        ? UDC_MSG_RELIABLE_0
-                        : UDC_MSG_RELIABLE_1);
-                    serial::msgReliable::serializeTimeStamp(m_messageBuffer, time.count());
-                    serial::msgReliable::serializeData(m_messageBuffer, msg.data(), msg.size());
-
-                    m_socket.send(client->outgoingAddress(), m_messageBuffer, serial::msgReliable::SIZE + msg.size());
-
-                    client->setSendReliable(time);
-                }
-            }
+            continue;
         }
 
-        // Send PING
-        if (client->needsPing(time))
+        // Another client may have connected to the address while this one was held
+        if (connection.result == UDC_EVENT_CONNECTION_SUCCESS && m_clientsByAddress.find(connection.address) != nullptr)
         {
-            assert(m_messageBufferSize >= serial::msgPingPong::SIZE);
-
-            serial::msgHeader::serializeMsgId(m_messageBuffer, UDC_MSG_PING);
-            serial::msgPingPong::serializeTimeStamp(m_messageBuffer, time.count());
-
-            m_socket.send(client->outgoingAddress(), m_messageBuffer, serial::msgPingPong::SIZE);
+            connection.result = UDC_EVENT_CONNECTION_TIMEOUT;
         }
 
-        // Throw connection lost event if needed
-        if (client->needsConnectionLostEvent(time))
+        if (connection.result == UDC_EVENT_CONNECTION_SUCCESS)
+        {
+            completeConnection(client, connection.address, time);
+        }
+        else
         {
-            client->setConnectionLost();
+            removeTimedOutClient(client);
+        }
 
-            m_eventBuffer.eventType = UDC_EVENT_CONNECTION_LOST;
-            m_eventBuffer.endPointId = client->id();
+        UdcEvent event = {};
+        event.eventType = connection.result;
+        event.endPointId = connection.endPointId;
 
-            return &m_eventBuffer;
-        }
+        m_connectionEvents.push_back(event);
     }
+}
 
-    return nullptr;
+const UdcEvent* UdcServerImpl::popConnectionEvent()
+{
+    if (m_connectionEvents.empty())
+    {
+        return nullptr;
+    }
+
+    m_eventBuffer = m_connectionEvents.front();
+    m_connectionEvents.pop_front();
+
+    return &m_eventBuffer;
 }
 
 void UdcServerImpl::processConnectionRequest(const UdcAddressMux& fromAddress)
@@ -415,44 +2031,53 @@ void UdcServerImpl::processConnectionRequest(const UdcAddressMux& fromAddress)
     // nothing else needs to change
     serial::msgHeader::serializeMsgId(m_messageBuffer, UDC_MSG_CONNECTION_HANDSHAKE);
 
-    // Send handshake
-    m_socket.send(fromAddress, m_messageBuffer, serial::msgConnection::SIZE);
-}
-
-const UdcEvent* UdcServerImpl::processConnectionHandshake(const UdcAddressMux& fromAddress, std::chrono::milliseconds time)
-{
-    UdcClient* client;
+    // An endpoint that's connected to the sender counts the request, since another one can come from there
+    UdcClient client;
+    UdcTrafficStats* stats = nullptr;
 
-    // Get client pending connection
-    if (!tryGetFirstPendingClient(&client))
+    if (tryGetClient(fromAddress, client))
     {
-        return nullptr;
+        stats = &client.stats();
+        stats->countReceived(UDC_MSG_CONNECTION_REQUEST, serial::msgConnection::SIZE);
     }
 
+    // Send handshake
+    sendPacket(fromAddress, m_messageBuffer, serial::msgConnection::SIZE, stats);
+}
+
+const UdcEvent* UdcServerImpl::processConnectionHandshake(const UdcAddressMux& fromAddress, std::chrono::microseconds time)
+{
     // Get endpoint id from message
     UdcEndPointId endPointId;
     serial::msgConnection::deserializeEndPointId(m_messageBuffer, endPointId);
 
-    if (client->id() != endPointId)
+    // Get the pending client that sent the connection request
+    UdcClient client;
+    if (!m_clients.find(endPointId, client) || !client.pending())
     {
         return nullptr;
     }
 
+    client.stats().countReceived(UDC_MSG_CONNECTION_HANDSHAKE, serial::msgConnection::SIZE);
+
     // Check that outgoingAddress isn't already connected
-    if (m_clientsByAddress.find(fromAddress) != m_clientsByAddress.cend())
+    if (m_clientsByAddress.find(fromAddress) != nullptr)
     {
         return nullptr;
     }
 
+    cancelTimer(endPointId, UDC_TIMER_CONNECT);
+
+    if (m_orderedConnectionEvents)
+    {
+        // Completed once every earlier client has a result
+        return resolveOrderedConnection(endPointId, UDC_EVENT_CONNECTION_SUCCESS, fromAddress, time);
+    }
+
     // Complete connection
-    client->receiveConnectionHandshake(time);
-    m_clientsById[endPointId] = m_pendingClients.front();
-    m_clientsByAddress.insert(fromAddress, m_pendingClients.front());
-    m_pendingClients.pop_front();
+    completeConnection(client, fromAddress, time);
 
-    m_eventBuffer.eventType = UDC_EVENT_CONNECTION_SUCCESS;
-    m_eventBuffer.endPointId = endPointId;
-    return &m_eventBuffer;
+    return connectionEvent(UDC_EVENT_CONNECTION_SUCCESS, endPointId);
 }
 
 void UdcServerImpl::processPing(const UdcAddressMux& fromAddress)
@@ -461,204 +2086,277 @@ void UdcServerImpl::processPing(const UdcAddressMux& fromAddress)
     // everything else can stay the same
     serial::msgHeader::serializeMsgId(m_messageBuffer, UDC_MSG_PONG);
 
+    UdcClient client;
+    UdcTrafficStats* stats = nullptr;
+
+    if (tryGetClient(fromAddress, client))
+    {
+        stats = &client.stats();
+        stats->countReceived(UDC_MSG_PING, serial::msgPingPong::SIZE);
+    }
+
     // Send pong
-    m_socket.send(fromAddress, m_messageBuffer, serial::msgPingPong::SIZE);
+    sendPacket(fromAddress, m_messageBuffer, serial::msgPingPong::SIZE, stats);
 }
 
-const UdcEvent* UdcServerImpl::processPong(const UdcAddressMux& fromAddress, std::chrono::milliseconds time)
+const UdcEvent* UdcServerImpl::processPong(const UdcAddressMux& fromAddress, std::chrono::microseconds time)
 {
     // Check if fromAddress belongs to a client
-    UdcClient* client;
-    if (!tryGetClient(fromAddress, &client))
+    UdcClient client;
+    if (!tryGetClient(fromAddress, client))
     {
         return nullptr;
     }
 
+    client.stats().countReceived(UDC_MSG_PONG, serial::msgPingPong::SIZE);
+
     // Get timestamp
     uint32_t timeStamp;
     serial::msgPingPong::deserializeTimeStamp(m_messageBuffer, timeStamp);
-    auto timeStampMs = std::chrono::milliseconds(timeStamp);
 
-    if (time < timeStampMs)
+    std::chrono::microseconds elapsed;
+    if (!tryGetElapsedTime(time, timeStamp, elapsed))
     {
         return nullptr;
     }
 
     // Receive pong on client
     // if true, then a connection has been regained
-    if (!client->receivePong(timeStampMs, time))
+    if (!client.receivePong(time - elapsed, time))
     {
         return nullptr;
     }
 
     // Connection has been regained
+    scheduleTimer(client.id(), UDC_TIMER_CONNECTION_LOST, client.connectionLostTime());
+
     m_eventBuffer.eventType = UDC_EVENT_CONNECTION_REGAINED;
-    m_eventBuffer.endPointId = client->id();
+    m_eventBuffer.endPointId = client.id();
     return &m_eventBuffer;
 }
 
-const UdcEvent* UdcServerImpl::processReliableMessage(int state, const UdcAddressMux& fromAddress, uint32_t msgSize)
+const UdcEvent* UdcServerImpl::processReliableMessage(int state, const UdcAddressMux& fromAddress, uint32_t msgSize, std::chrono::microseconds time)
 {
-    auto it = m_reliableStates.find(fromAddress);
+    auto* reliableState = m_reliableStates.find(fromAddress, time);
+
+    // The sender is looked up once, for its counters and for the message event
+    UdcClient client;
+    UdcClient* sender = nullptr;
+    UdcTrafficStats* stats = nullptr;
+
+    if (tryGetClient(fromAddress, client))
+    {
+        sender = &client;
+        stats = &client.stats();
+        stats->countReceived(UDC_MSG_RELIABLE_0, msgSize);
+    }
 
     if (state == -1)
     {
         // reset reliable state for address
-        if (it != m_reliableStates.end())
+        if (reliableState != nullptr)
         {
-            it->second = 0;
+            *reliableState = 0;
         }
 
         // send handshake
         serial::msgHeader::serializeMsgId(m_messageBuffer, UDC_MSG_RELIABLE_HANDSHAKE_RESET);
-        m_socket.send(fromAddress, m_messageBuffer, serial::msgReliable::SIZE);
+        sendPacket(fromAddress, m_messageBuffer, serial::msgReliable::SIZE, stats);
 
         return nullptr;
     }
 
-    bool notInHash = (it == m_reliableStates.end());
-    bool process = (notInHash || it->second == state);
+    bool notInHash = (reliableState == nullptr);
+    bool process = (notInHash || *reliableState == state);
 
     // move to next state
     if (notInHash)
     {
-        m_reliableStates.insert(fromAddress, (state == 0) ? 1 : 0);
+        m_reliableStates.insert(fromAddress, (state == 0) ? 1 : 0, time);
     }
     else
     {
-        it->second = (state == 0) ? 1 : 0;
+        *reliableState = (state == 0) ? 1 : 0;
     }
 
     // send handshake
     serial::msgHeader::serializeMsgId(m_messageBuffer, (state == 0) ? UDC_MSG_RELIABLE_HANDSHAKE_0 : UDC_MSG_RELIABLE_HANDSHAKE_1);
-    m_socket.send(fromAddress, m_messageBuffer, serial::msgReliable::SIZE);
+    sendPacket(fromAddress, m_messageBuffer, serial::msgReliable::SIZE, stats);
 
     // process message
     if (process)
     {
-        if (fromAddress.family == UDC_IPV4)
-        {
-            m_eventBuffer.eventType = UDC_EVENT_RECEIVE_MESSAGE_IPV4;
-            m_eventBuffer.addressIPv4 = fromAddress.address.ipv4;
-        }
-        else
-        {
-            m_eventBuffer.eventType = UDC_EVENT_RECEIVE_MESSAGE_IPV6;
-            m_eventBuffer.addressIPv6 = fromAddress.address.ipv6;
-        }
+        return deliverMessage(fromAddress, sender, serial::msgReliable::SIZE, msgSize);
+    }
 
-        m_eventBuffer.port = fromAddress.port;
-        m_eventBuffer.msgIndex = serial::msgReliable::SIZE;
-        m_eventBuffer.msgSize = msgSize - serial::msgReliable::SIZE;
+    // The acknowledgement was lost, so the message was sent again
+    ++m_stats.duplicatesDropped;
 
-        return &m_eventBuffer;
+    if (stats != nullptr)
+    {
+        ++stats->duplicatesDropped;
     }
 
     return nullptr;
 }
 
-const UdcEvent* UdcServerImpl::processReliableHandshake(int state, const UdcAddressMux& fromAddress, std::chrono::milliseconds time)
+const UdcEvent* UdcServerImpl::processReliableHandshake(int state, const UdcAddressMux& fromAddress, std::chrono::microseconds time)
 {
     // Check if fromAddress belongs to a client
-    UdcClient* client;
-    if (!tryGetClient(fromAddress, &client))
+    UdcClient client;
+    if (!tryGetClient(fromAddress, client))
     {
         return nullptr;
     }
 
+    client.stats().countReceived(UDC_MSG_RELIABLE_HANDSHAKE_0, serial::msgReliable::SIZE);
+
     // Get timestamp
     uint32_t timeStamp;
     serial::msgReliable::deserializeTimeStamp(m_messageBuffer, timeStamp);
-    auto timeStampMs = std::chrono::milliseconds(timeStamp);
 
-    if (time < timeStampMs)
+    std::chrono::microseconds elapsed;
+    if (!tryGetElapsedTime(time, timeStamp, elapsed))
     {
         return nullptr;
     }
 
     // Process handshake
-    int reliableState = client->reliableState();
+    int reliableState = client.reliableState();
 
     // handshake must match the server's expectation of client state
     if (state == reliableState)
     {
-        if (reliableState != -1 && !client->reliableMessages().empty())
+        if (reliableState != -1 && !client.reliableMessages().empty())
         {
-            client->reliableMessages().pop();
+            m_messagePool.release(client.reliableMessages().front());
+            client.reliableMessages().pop();
+            client.acknowledgeReliable();
         }
 
         // -1 -> 0 (reset), 0 -> 1, 1 -> 0
-        client->setReliableState((state == 0) ? 1 : 0);
+        client.setReliableState((state == 0) ? 1 : 0);
 
         // acknowledge received, and await sending a new reliable message
-        client->resetSendReliable();
+        client.resetSendReliable();
+
+        if (!client.reliableMessages().empty())
+        {
+            scheduleTimer(client.id(), UDC_TIMER_RELIABLE, time);
+        }
+        else
+        {
+            cancelTimer(client.id(), UDC_TIMER_RELIABLE);
+        }
     }
 
     // Check for lost connection regained from reliable handshake
-    if (!client->receiveReliableHandshake(timeStampMs, time))
+    if (!client.receiveReliableHandshake(time - elapsed, time))
     {
         return nullptr;
     }
 
     // Connection has been regained
+    scheduleTimer(client.id(), UDC_TIMER_CONNECTION_LOST, client.connectionLostTime());
+
     m_eventBuffer.eventType = UDC_EVENT_CONNECTION_REGAINED;
-    m_eventBuffer.endPointId = client->id();
+    m_eventBuffer.endPointId = client.id();
     return &m_eventBuffer;
 }
 
 const UdcEvent* UdcServerImpl::processUnreliable(const UdcAddressMux& fromAddress, uint32_t msgSize)
 {
-    if (fromAddress.family == UDC_IPV4)
-    {
-        m_eventBuffer.eventType = UDC_EVENT_RECEIVE_MESSAGE_IPV4;
-        m_eventBuffer.addressIPv4 = fromAddress.address.ipv4;
-    }
-    else
+    UdcClient client;
+    UdcClient* sender = nullptr;
+
+    if (tryGetClient(fromAddress, client))
     {
-        m_eventBuffer.eventType = UDC_EVENT_RECEIVE_MESSAGE_IPV6;
-        m_eventBuffer.addressIPv6 = fromAddress.address.ipv6;
+        sender = &client;
+        client.stats().countReceived(UDC_MSG_UNRELIABLE, msgSize);
     }
 
-    m_eventBuffer.port = fromAddress.port;
-    m_eventBuffer.msgIndex = serial::msgHeader::SIZE;
-    m_eventBuffer.msgSize = msgSize - serial::msgHeader::SIZE;
+    return deliverMessage(fromAddress, sender, serial::msgHeader::SIZE, msgSize);
+}
 
-    return &m_eventBuffer;
+bool UdcServerImpl::tryGetClient(UdcEndPointId clientId, UdcClient& client)
+{
+    // Pending clients can't be used until they're connected
+    return m_clients.find(clientId, client) && !client.pending();
 }
 
-bool UdcServerImpl::tryGetClient(UdcEndPointId clientId, UdcClient** client)
+bool UdcServerImpl::tryGetClient(const UdcAddressMux& address, UdcClient& client)
 {
-    auto it = m_clientsById.find(clientId);
+    auto* endPointId = m_clientsByAddress.find(address);
 
-    if (it == m_clientsById.end())
+    if (endPointId == nullptr)
     {
         return false;
     }
 
-    *client = it->second.get();
-    return true;
+    return m_clients.find(*endPointId, client);
+}
+
+void UdcServerImpl::sendPacket(const UdcAddressMux& address, const uint8_t* data, uint32_t size, UdcTrafficStats* endPointStats)
+{
+    UdcSegment segment = {data, size};
+    sendPacket(address, &segment, 1, endPointStats);
 }
 
-bool UdcServerImpl::tryGetClient(const UdcAddressMux& address, UdcClient** client)
+void UdcServerImpl::sendPacket(const UdcAddressMux& address, const UdcSegment* segments, uint32_t segmentCount, UdcTrafficStats* endPointStats)
 {
-    auto it = m_clientsByAddress.find(address);
+    uint32_t size = 0;
 
-    if (it == m_clientsByAddress.cend())
+    for (uint32_t i = 0; i != segmentCount; ++i)
     {
-        return false;
+        size += segments[i].size;
     }
 
-    *client = it->second.get();
-    return true;
+    // Every packet starts with the header, in the first segment
+    UdcMessageId msgId;
+    serial::msgHeader::deserializeMsgId(segments[0].data, msgId);
+
+    m_stats.countSent(msgId, size);
+
+    if (endPointStats != nullptr)
+    {
+        endPointStats->countSent(msgId, size);
+    }
+
+    m_socket.send(address, segments, segmentCount);
 }
 
-bool UdcServerImpl::tryGetFirstPendingClient(UdcClient** client)
+bool UdcServerImpl::hasValidSize(UdcMessageId msgId, uint32_t msgSize)
 {
-    if (m_pendingClients.empty())
+    switch (msgId)
     {
-        return false;
+        case UDC_MSG_CONNECTION_REQUEST:
+        case UDC_MSG_CONNECTION_HANDSHAKE:
+            return msgSize == serial::msgConnection::SIZE;
+        case UDC_MSG_PING:
+        case UDC_MSG_PONG:
+            return msgSize == serial::msgPingPong::SIZE;
+        case UDC_MSG_UNRELIABLE:
+            return msgSize >= serial::msgHeader::SIZE;
+        case UDC_MSG_RELIABLE_RESET:
+        case UDC_MSG_RELIABLE_HANDSHAKE_RESET:
+        case UDC_MSG_RELIABLE_HANDSHAKE_0:
+        case UDC_MSG_RELIABLE_HANDSHAKE_1:
+            return msgSize == serial::msgReliable::SIZE;
+        case UDC_MSG_RELIABLE_0:
+        case UDC_MSG_RELIABLE_1:
+            return msgSize >= serial::msgReliable::SIZE;
+        default:
+            return false;
     }
+}
 
-    *client = m_pendingClients.front().get();
-    return true;
+void UdcServerImpl::releaseReliableMessages(UdcClient client)
+{
+    auto& messages = client.reliableMessages();
+
+    while (!messages.empty())
+    {
+        m_messagePool.release(messages.front());
+        messages.pop();
+    }
 }
@@ -0,0 +1,339 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcSharedInbox.h"
+
+#include <cstring>
+
+UdcSharedInbox::UdcSharedInbox()
+    : m_layout(nullptr)
+    , m_channel(nullptr)
+    , m_nextChannel(0)
+    , m_oversizedDrops(0)
+{}
+
+UdcSharedInbox::~UdcSharedInbox()
+{
+    close();
+}
+
+std::string UdcSharedInbox::eventName(UdcAddressFamily family, uint16_t port)
+{
+    return memoryName(family, port) + "-event";
+}
+
+bool UdcSharedInbox::create(UdcAddressFamily family, uint16_t port)
+{
+    close();
+
+    bool existed = false;
+
+    if (!m_memory.create(memoryName(family, port), sizeof(Layout), existed))
+    {
+        return false;
+    }
+
+    auto* layout = reinterpret_cast<Layout*>(m_memory.data());
+    uint32_t receiverId = UdcProcess::currentId();
+
+    if (existed)
+    {
+        // A receiver that's still setting up new memory hasn't stored the magic yet
+        if (layout->magic.load(std::memory_order_acquire) != MAGIC)
+        {
+            m_memory.close();
+            return false;
+        }
+
+        // Only an inbox that its receiver closed, or whose receiver has exited, can be taken over
+        uint32_t previousId = layout->receiverId.load(std::memory_order_acquire);
+        UdcProcess previous;
+
+        if (layout->closed.load(std::memory_order_acquire) == 0 &&
+            previous.open(previousId, layout->receiverStartTime.load(std::memory_order_acquire)) &&
+            previous.running())
+        {
+            m_memory.close();
+            return false;
+        }
+
+        // Only one of the servers that find the same receiver gone takes over
+        if (!layout->receiverId.compare_exchange_strong(previousId, receiverId, std::memory_order_acq_rel))
+        {
+            m_memory.close();
+            return false;
+        }
+
+        layout->receiverStartTime.store(UdcProcess::currentStartTime(), std::memory_order_release);
+    }
+    else
+    {
+        // New memory is zeroed, which is an empty inbox with no claimed channels
+        layout->receiverId.store(receiverId, std::memory_order_relaxed);
+        layout->receiverStartTime.store(UdcProcess::currentStartTime(), std::memory_order_relaxed);
+        layout->magic.store(MAGIC, std::memory_order_release);
+    }
+
+    m_layout = layout;
+
+    // Senders may still hold the inbox of a receiver that closed or exited, and keep their channels
+    for (auto& channel : m_layout->channels)
+    {
+        channel.head.store(channel.tail.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    m_layout->closed.store(0, std::memory_order_release);
+
+    return true;
+}
+
+bool UdcSharedInbox::open(UdcAddressFamily family, uint16_t port, uint16_t fromPort)
+{
+    close();
+
+    if (!m_memory.open(memoryName(family, port), sizeof(Layout)))
+    {
+        return false;
+    }
+
+    auto* layout = reinterpret_cast<Layout*>(m_memory.data());
+
+    if (layout->magic.load(std::memory_order_acquire) != MAGIC || layout->closed.load(std::memory_order_acquire) != 0)
+    {
+        m_memory.close();
+        return false;
+    }
+
+    // The receiver is held open, so that a crash is seen even though the memory outlives it
+    if (!m_receiver.open(
+            layout->receiverId.load(std::memory_order_acquire),
+            layout->receiverStartTime.load(std::memory_order_acquire)) ||
+        !m_receiver.running())
+    {
+        m_receiver.close();
+        m_memory.close();
+        return false;
+    }
+
+    // A channel left by an earlier sender on the same port is taken back first
+    uint32_t owner = static_cast<uint32_t>(fromPort) + 1;
+    Channel* claimed = nullptr;
+
+    for (auto& channel : layout->channels)
+    {
+        if (channel.owner.load(std::memory_order_relaxed) == owner)
+        {
+            claimed = &channel;
+            break;
+        }
+    }
+
+    for (uint32_t i = 0; claimed == nullptr && i != CHANNEL_COUNT; ++i)
+    {
+        uint32_t unclaimed = 0;
+
+        if (layout->channels[i].owner.compare_exchange_strong(unclaimed, owner, std::memory_order_acquire))
+        {
+            claimed = &layout->channels[i];
+        }
+    }
+
+    if (claimed == nullptr)
+    {
+        m_receiver.close();
+        m_memory.close();
+        return false;
+    }
+
+    m_layout = layout;
+    m_channel = claimed;
+
+    return true;
+}
+
+void UdcSharedInbox::close()
+{
+    if (m_layout == nullptr)
+    {
+        return;
+    }
+
+    // Datagrams that the receiver hasn't taken stay in the channel for it,
+    // and each one says which port sent it, so the next owner can't be confused with this one
+    if (m_channel != nullptr)
+    {
+        m_channel->owner.store(0, std::memory_order_release);
+    }
+    else
+    {
+        m_layout->closed.store(1, std::memory_order_release);
+    }
+
+    m_receiver.close();
+    m_memory.close();
+    m_layout = nullptr;
+    m_channel = nullptr;
+}
+
+bool UdcSharedInbox::isOpen() const
+{
+    return m_layout != nullptr && m_layout->closed.load(std::memory_order_relaxed) == 0;
+}
+
+bool UdcSharedInbox::receiverRunning() const
+{
+    return m_receiver.running();
+}
+
+bool UdcSharedInbox::push(UdcAddressFamily family, uint16_t port, const UdcSegment* segments, uint32_t segmentCount, bool& wake)
+{
+    wake = false;
+
+    uint32_t size = 0;
+
+    for (uint32_t i = 0; i != segmentCount; ++i)
+    {
+        size += segments[i].size;
+    }
+
+    if (m_channel == nullptr || size > MAX_DATAGRAM_SIZE)
+    {
+        return false;
+    }
+
+    uint32_t tail = m_channel->tail.load(std::memory_order_relaxed);
+    uint32_t head = m_channel->head.load(std::memory_order_acquire);
+
+    // A record doesn't wrap around the end of the ring, so the rest of it is skipped instead
+    uint32_t offset = tail & (CHANNEL_SIZE - 1);
+    uint32_t length = recordSize(size);
+    uint32_t skip = (CHANNEL_SIZE - offset < length) ? CHANNEL_SIZE - offset : 0;
+
+    if (CHANNEL_SIZE - (tail - head) < skip + length)
+    {
+        return false;
+    }
+
+    if (skip != 0)
+    {
+        reinterpret_cast<Record*>(m_channel->data + offset)->size = WRAP;
+        offset = 0;
+    }
+
+    auto* record = reinterpret_cast<Record*>(m_channel->data + offset);
+    record->size = size;
+    record->port = port;
+    record->family = family;
+    record->reserved = 0;
+
+    uint8_t* payload = m_channel->data + offset + sizeof(Record);
+
+    for (uint32_t i = 0; i != segmentCount; ++i)
+    {
+        memcpy(payload, segments[i].data, segments[i].size);
+        payload += segments[i].size;
+    }
+
+    // The receiver stores the head and then loads the tail, in the opposite order to this,
+    // so either it sees the new datagram or this sees that it has emptied the channel
+    m_channel->tail.store(tail + skip + length, std::memory_order_seq_cst);
+    wake = m_channel->head.load(std::memory_order_seq_cst) == tail;
+
+    return true;
+}
+
+bool UdcSharedInbox::pop(UdcAddressFamily& family, uint16_t& port, uint8_t* buffer, uint32_t& size)
+{
+    if (m_layout == nullptr || m_channel != nullptr)
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i != CHANNEL_COUNT; ++i)
+    {
+        uint32_t index = (m_nextChannel + i) % CHANNEL_COUNT;
+        auto& channel = m_layout->channels[index];
+
+        uint32_t head = channel.head.load(std::memory_order_relaxed);
+
+        while (head != channel.tail.load(std::memory_order_seq_cst))
+        {
+            uint32_t offset = head & (CHANNEL_SIZE - 1);
+
+            // Another process wrote the record, so it's copied before it's checked
+            Record record;
+            memcpy(&record, channel.data + offset, sizeof(Record));
+
+            if (record.size == WRAP)
+            {
+                head += CHANNEL_SIZE - offset;
+                channel.head.store(head, std::memory_order_seq_cst);
+                continue;
+            }
+
+            // A corrupt record empties the channel rather than overrunning it
+            if (record.size > MAX_DATAGRAM_SIZE || recordSize(record.size) > CHANNEL_SIZE - offset)
+            {
+                head = channel.tail.load(std::memory_order_acquire);
+                channel.head.store(head, std::memory_order_seq_cst);
+                break;
+            }
+
+            bool fits = record.size <= size;
+
+            if (fits)
+            {
+                size = record.size;
+                port = record.port;
+                family = (record.family == UDC_IPV6) ? UDC_IPV6 : UDC_IPV4;
+                memcpy(buffer, channel.data + offset + sizeof(Record), size);
+            }
+
+            head += recordSize(record.size);
+            channel.head.store(head, std::memory_order_seq_cst);
+
+            if (fits)
+            {
+                m_nextChannel = index + 1;
+                return true;
+            }
+
+            ++m_oversizedDrops;
+        }
+    }
+
+    return false;
+}
+
+bool UdcSharedInbox::empty() const
+{
+    if (m_layout == nullptr)
+    {
+        return true;
+    }
+
+    for (const auto& channel : m_layout->channels)
+    {
+        if (channel.head.load(std::memory_order_relaxed) != channel.tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+uint64_t UdcSharedInbox::oversizedDrops() const
+{
+    return m_oversizedDrops;
+}
+
+std::string UdcSharedInbox::memoryName(UdcAddressFamily family, uint16_t port)
+{
+    return std::string((family == UDC_IPV6) ? "udp-connect-ipv6-" : "udp-connect-ipv4-") + std::to_string(port);
+}
+
+uint32_t UdcSharedInbox::recordSize(uint32_t size)
+{
+    return (static_cast<uint32_t>(sizeof(Record)) + size + 7) & ~7u;
+}
@@ -3,9 +3,26 @@
 
 #include "UdcSocketMux.h"
 
-UdcSocketMux::UdcSocketMux() = default;
+#include <cstring>
+
+UdcSocketMux::UdcSocketMux()
+    : m_receiveEventReset(false)
+    , m_portIPv4(0)
+    , m_portIPv6(0)
+    , m_sharedSent(0)
+    , m_sharedReceived(0)
+    , m_receiveSharedFirst(false)
+    , m_oversizedDrops(0)
+{}
 
 UdcSocketMux::UdcSocketMux(const std::string& logFileName)
+    : m_receiveEventReset(false)
+    , m_portIPv4(0)
+    , m_portIPv6(0)
+    , m_sharedSent(0)
+    , m_sharedReceived(0)
+    , m_receiveSharedFirst(false)
+    , m_oversizedDrops(0)
 {
     try
     {
@@ -26,7 +43,19 @@ bool UdcSocketMux::tryBindIPv4(uint16_t port)
 
     if (socket.localBindIPv4(port))
     {
+        if (m_socketIPv4.empty())
+        {
+            m_portIPv4 = socket.localPort();
+        }
+
         m_socketIPv4.push_back(socket);
+        updateReceiveSockets();
+
+        if (m_receiveEvent)
+        {
+            static_cast<void>(m_receiveEvent->watch(socket));
+        }
+
         return true;
     }
 
@@ -39,7 +68,19 @@ bool UdcSocketMux::tryBindIPv6(uint16_t port)
 
     if (socket.localBindIPv6(port))
     {
+        if (m_socketIPv6.empty())
+        {
+            m_portIPv6 = socket.localPort();
+        }
+
         m_socketIPv6.push_back(socket);
+        updateReceiveSockets();
+
+        if (m_receiveEvent)
+        {
+            static_cast<void>(m_receiveEvent->watch(socket));
+        }
+
         return true;
     }
 
@@ -64,7 +105,14 @@ bool UdcSocketMux::send(const UdcAddressIPv4& address, uint16_t port, const uint
         return false;
     }
 
-    bool result = m_socketIPv4.front().sendIPv4(address, port, data, size);
+    // Servers on the same host are sent to through shared memory, if they have an inbox
+    bool result = false;
+    UdcSegment segment = {data, size};
+
+    if (!(isLoopback(address) && trySendShared(UDC_IPV4, port, &segment, 1, result)))
+    {
+        result = m_socketIPv4.front().sendIPv4(address, port, data, size);
+    }
 
     // Log if necessary
     if (m_logger && result)
@@ -83,7 +131,14 @@ bool UdcSocketMux::send(const UdcAddressIPv6& address, uint16_t port, const uint
         return false;
     }
 
-    bool result = m_socketIPv6.front().sendIPv6(address, port, data, size);
+    // Servers on the same host are sent to through shared memory, if they have an inbox
+    bool result = false;
+    UdcSegment segment = {data, size};
+
+    if (!(isLoopback(address) && trySendShared(UDC_IPV6, port, &segment, 1, result)))
+    {
+        result = m_socketIPv6.front().sendIPv6(address, port, data, size);
+    }
 
     // Log if necessary
     if (m_logger && result)
@@ -94,8 +149,96 @@ bool UdcSocketMux::send(const UdcAddressIPv6& address, uint16_t port, const uint
     return result;
 }
 
+bool UdcSocketMux::send(const UdcAddressMux& address, const UdcSegment* segments, uint32_t segmentCount) const
+{
+    if (address.family == UDC_IPV6)
+    {
+        return send(address.address.ipv6, address.port, segments, segmentCount);
+    }
+
+    return send(address.address.ipv4, address.port, segments, segmentCount);
+}
+
+bool UdcSocketMux::send(const UdcAddressIPv4& address, uint16_t port, const UdcSegment* segments, uint32_t segmentCount) const
+{
+    // Not connected
+    if (m_socketIPv4.empty())
+    {
+        return false;
+    }
+
+    bool result = false;
+
+    if (!(isLoopback(address) && trySendShared(UDC_IPV4, port, segments, segmentCount, result)))
+    {
+        result = m_socketIPv4.front().sendIPv4(address, port, segments, segmentCount);
+    }
+
+    // Log if necessary
+    if (m_logger && result)
+    {
+        m_logger->logSent(address, port, segments, segmentCount);
+    }
+
+    return result;
+}
+
+bool UdcSocketMux::send(const UdcAddressIPv6& address, uint16_t port, const UdcSegment* segments, uint32_t segmentCount) const
+{
+    // Not connected
+    if (m_socketIPv6.empty())
+    {
+        return false;
+    }
+
+    bool result = false;
+
+    if (!(isLoopback(address) && trySendShared(UDC_IPV6, port, segments, segmentCount, result)))
+    {
+        result = m_socketIPv6.front().sendIPv6(address, port, segments, segmentCount);
+    }
+
+    // Log if necessary
+    if (m_logger && result)
+    {
+        m_logger->logSent(address, port, segments, segmentCount);
+    }
+
+    return result;
+}
+
+bool UdcSocketMux::send(const UdcAddressMux* addresses, uint32_t addressCount, const UdcSegment* segments, uint32_t segmentCount) const
+{
+    // WinSock has no call that sends to several addresses,
+    // but the packet is only gathered from the same segments each time
+    bool result = true;
+
+    for (uint32_t i = 0; i != addressCount; ++i)
+    {
+        result &= send(addresses[i], segments, segmentCount);
+    }
+
+    return result;
+}
+
 bool UdcSocketMux::receive(UdcAddressMux& address, uint8_t* buffer, uint32_t& size)
 {
+    // The event is reset before the sockets are emptied, so a packet that arrives
+    // after the last receive signals it again
+    if (m_receiveEvent && !m_receiveEventReset)
+    {
+        m_receiveEvent->reset();
+        m_receiveEventReset = true;
+    }
+
+    // A busy inbox can't starve the sockets, or the other way around
+    m_receiveSharedFirst = !m_receiveSharedFirst;
+
+    if (m_receiveSharedFirst && receiveShared(address, buffer, size))
+    {
+        return true;
+    }
+
     if (receive(address.address.ipv6, address.port, buffer, size))
     {
         address.family = UDC_IPV6;
@@ -108,14 +251,31 @@ bool UdcSocketMux::receive(UdcAddressMux& address, uint8_t* buffer, uint32_t& si
         return true;
     }
 
+    if (!m_receiveSharedFirst && receiveShared(address, buffer, size))
+    {
+        return true;
+    }
+
+    m_receiveEventReset = false;
     return false;
 }
 
 bool UdcSocketMux::receive(UdcAddressIPv4& address, uint16_t& port, uint8_t* buffer, uint32_t& size)
 {
+    uint32_t capacity = size;
+
     for (auto& socket : m_socketIPv4)
     {
-        if (socket.receiveIPv4(address, port, buffer, size) == 1)
+        int32_t result;
+
+        // A message that doesn't fit is dropped, and the socket is read again
+        while ((result = socket.receiveIPv4(address, port, buffer, size)) == -1)
+        {
+            ++m_oversizedDrops;
+            size = capacity;
+        }
+
+        if (result == 1)
         {
             if (m_logger)
             {
@@ -131,9 +291,20 @@ bool UdcSocketMux::receive(UdcAddressIPv4& address, uint16_t& port, uint8_t* buf
 
 bool UdcSocketMux::receive(UdcAddressIPv6& address, uint16_t& port, uint8_t* buffer, uint32_t& size)
 {
+    uint32_t capacity = size;
+
     for (auto& socket : m_socketIPv6)
     {
-        if (socket.receiveIPv6(address, port, buffer, size) == 1)
+        int32_t result;
+
+        // A message that doesn't fit is dropped, and the socket is read again
+        while ((result = socket.receiveIPv6(address, port, buffer, size)) == -1)
+        {
+            ++m_oversizedDrops;
+            size = capacity;
+        }
+
+        if (result == 1)
         {
             if (m_logger)
             {
@@ -160,9 +331,247 @@ void UdcSocketMux::disconnect()
         socket.disconnect();
     }
     m_socketIPv6.clear();
+
+    m_portIPv4 = 0;
+    m_portIPv6 = 0;
+
+    m_sharedPeers.clear();
+    m_sharedInbox.reset();
+
+    updateReceiveSockets();
 }
 
 bool UdcSocketMux::isConnected() const
 {
     return !(m_socketIPv4.empty() && m_socketIPv6.empty());
 }
+
+bool UdcSocketMux::isBound(UdcAddressFamily family) const
+{
+    return (family == UDC_IPV6) ? !m_socketIPv6.empty() : !m_socketIPv4.empty();
+}
+
+UdcSocketEvent* UdcSocketMux::receiveEvent()
+{
+    if (m_receiveEvent)
+    {
+        return m_receiveEvent.get();
+    }
+
+    if (!setReceiveEvent(std::make_unique<UdcSocketEvent>()))
+    {
+        return nullptr;
+    }
+
+    return m_receiveEvent.get();
+}
+
+bool UdcSocketMux::enableSharedMemory()
+{
+    if (m_sharedInbox)
+    {
+        return true;
+    }
+
+    // The application may already be waiting on the event, so it can't be replaced with a named one
+    if (m_receiveEvent || !isConnected())
+    {
+        return false;
+    }
+
+    // Only the first family's socket has an inbox, and the other family is sent to with UDP
+    UdcAddressFamily family = m_socketIPv4.empty() ? UDC_IPV6 : UDC_IPV4;
+    uint16_t port = (family == UDC_IPV6) ? m_portIPv6 : m_portIPv4;
+    auto inbox = std::make_unique<UdcSharedInbox>();
+
+    if (port == 0 || !inbox->create(family, port))
+    {
+        return false;
+    }
+
+    // Senders open the event by name, to wake the thread that receives
+    if (!setReceiveEvent(std::make_unique<UdcSocketEvent>(UdcSharedInbox::eventName(family, port))))
+    {
+        return false;
+    }
+
+    m_sharedInbox = std::move(inbox);
+
+    return true;
+}
+
+uint64_t UdcSocketMux::sharedSent() const
+{
+    return m_sharedSent;
+}
+
+uint64_t UdcSocketMux::sharedReceived() const
+{
+    return m_sharedReceived;
+}
+
+uint64_t UdcSocketMux::oversizedDrops() const
+{
+    uint64_t drops = m_oversizedDrops;
+
+    if (m_sharedInbox)
+    {
+        drops += m_sharedInbox->oversizedDrops();
+    }
+
+    return drops;
+}
+
+void UdcSocketMux::updateReceiveSockets()
+{
+    m_receiveSockets.clear();
+
+    for (const auto& socket : m_socketIPv4)
+    {
+        m_receiveSockets.push_back(&socket);
+    }
+
+    for (const auto& socket : m_socketIPv6)
+    {
+        m_receiveSockets.push_back(&socket);
+    }
+}
+
+bool UdcSocketMux::setReceiveEvent(std::unique_ptr<UdcSocketEvent> receiveEvent)
+{
+    if (!receiveEvent->isValid())
+    {
+        return false;
+    }
+
+    for (const UdcSocket* socket : m_receiveSockets)
+    {
+        if (!receiveEvent->watch(*socket))
+        {
+            return false;
+        }
+    }
+
+    // Signalled until the sockets are first emptied
+    receiveEvent->signal();
+
+    m_receiveEvent = std::move(receiveEvent);
+    m_receiveEventReset = false;
+
+    return true;
+}
+
+bool UdcSocketMux::trySendShared(UdcAddressFamily family, uint16_t port, const UdcSegment* segments, uint32_t segmentCount, bool& sent) const
+{
+    if (!m_sharedInbox)
+    {
+        return false;
+    }
+
+    // The destination only has an inbox for the family its socket was bound with
+    auto& peer = m_sharedPeers[(static_cast<uint32_t>(family) << 16) | port];
+    uint16_t fromPort = (family == UDC_IPV6) ? m_portIPv6 : m_portIPv4;
+
+    // A port without an inbox isn't looked for again on every packet
+    if (!peer.inbox)
+    {
+        auto now = std::chrono::steady_clock::now();
+
+        if (now < peer.retryTime)
+        {
+            return false;
+        }
+
+        peer.retryTime = now + SHARED_RETRY_PERIOD;
+
+        auto inbox = std::make_unique<UdcSharedInbox>();
+
+        if (!inbox->open(family, port, fromPort))
+        {
+            return false;
+        }
+
+        peer.event = std::make_unique<UdcSocketEvent>(UdcSharedInbox::eventName(family, port));
+        peer.inbox = std::move(inbox);
+    }
+
+    // The server on the port has gone, and another one may bind it without shared memory
+    if (!peer.inbox->isOpen())
+    {
+        peer.inbox.reset();
+        peer.event.reset();
+        return false;
+    }
+
+    bool wake = false;
+    sent = peer.inbox->push(family, fromPort, segments, segmentCount, wake);
+
+    // A receiver that crashed never closes its inbox, so it's checked whenever the inbox
+    // looks idle or full, and the packet goes through UDP instead
+    // a crashed receiver loses at most the datagrams that fit in its channel
+    if ((wake || !sent) && !peer.inbox->receiverRunning())
+    {
+        peer.inbox.reset();
+        peer.event.reset();
+        sent = false;
+        return false;
+    }
+
+    if (wake)
+    {
+        peer.event->signal();
+    }
+
+    if (sent)
+    {
+        ++m_sharedSent;
+    }
+
+    return true;
+}
+
+bool UdcSocketMux::receiveShared(UdcAddressMux& address, uint8_t* buffer, uint32_t& size)
+{
+    if (!m_sharedInbox || !m_sharedInbox->pop(address.family, address.port, buffer, size))
+    {
+        return false;
+    }
+
+    ++m_sharedReceived;
+
+    // The source is the loopback address that the packet would have come from through UDP
+    if (address.family == UDC_IPV6)
+    {
+        address.address.ipv6 = {};
+        reinterpret_cast<uint8_t*>(address.address.ipv6.segments)[15] = 1;
+
+        if (m_logger)
+        {
+            m_logger->logReceived(address.address.ipv6, address.port, buffer, size);
+        }
+    }
+    else
+    {
+        address.address.ipv4 = {{127, 0, 0, 1}};
+
+        if (m_logger)
+        {
+            m_logger->logReceived(address.address.ipv4, address.port, buffer, size);
+        }
+    }
+
+    return true;
+}
+
+bool UdcSocketMux::isLoopback(const UdcAddressIPv4& address)
+{
+    return address.octets[0] == 127;
+}
+
+bool UdcSocketMux::isLoopback(const UdcAddressIPv6& address)
+{
+    // ::1, the segments are in network byte order
+    static constexpr uint8_t loopback[16] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1};
+
+    return memcmp(address.segments, loopback, sizeof(loopback)) == 0;
+}
@@ -0,0 +1,321 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcTimerWheel.h"
+
+#include <cassert>
+
+UdcTimerWheel::UdcTimerWheel(uint64_t currentTick)
+    : m_currentTick(currentTick)
+    , m_count(0)
+    , m_occupied()
+{
+    for (auto& head : m_heads)
+    {
+        head = NONE;
+    }
+}
+
+void UdcTimerWheel::resize(uint32_t timerCount)
+{
+    if (timerCount <= m_slots.size())
+    {
+        return;
+    }
+
+    m_deadlines.resize(timerCount, 0);
+    m_next.resize(timerCount, NONE);
+    m_prev.resize(timerCount, NONE);
+    m_slots.resize(timerCount, NONE);
+}
+
+void UdcTimerWheel::schedule(uint32_t timer, uint64_t deadline)
+{
+    assert(timer < m_slots.size());
+
+    if (m_slots[timer] != NONE)
+    {
+        unlink(timer);
+    }
+
+    m_deadlines[timer] = deadline;
+    link(timer);
+}
+
+void UdcTimerWheel::cancel(uint32_t timer)
+{
+    if (timer < m_slots.size() && m_slots[timer] != NONE)
+    {
+        unlink(timer);
+    }
+}
+
+bool UdcTimerWheel::scheduled(uint32_t timer) const
+{
+    return timer < m_slots.size() && m_slots[timer] != NONE;
+}
+
+void UdcTimerWheel::advance(uint64_t now, std::vector<uint32_t>& expired)
+{
+    // Timers that were scheduled in the past
+    expireSlot(DUE, expired);
+
+    if (now <= m_currentTick)
+    {
+        return;
+    }
+
+    while (true)
+    {
+        if (m_count == 0)
+        {
+            m_currentTick = now;
+            return;
+        }
+
+        // Skip over empty blocks straight to the next cascade
+        if (m_occupied[0] == 0)
+        {
+            uint64_t next = nextCascadeTick();
+
+            if (next > now)
+            {
+                m_currentTick = now;
+                return;
+            }
+
+            m_currentTick = next;
+            cascade();
+
+            if (m_occupied[0] & 1ull)
+            {
+                expireSlot(0, expired);
+            }
+
+            expireSlot(DUE, expired);
+            continue;
+        }
+
+        // Expire the level 0 slots between the current tick and the
+        // end of the current block (or now)
+        uint64_t blockLast = m_currentTick | (SLOTS - 1);
+        uint64_t target = (now < blockLast) ? now : blockLast;
+
+        uint32_t lo = static_cast<uint32_t>(m_currentTick & (SLOTS - 1)) + 1;
+        uint32_t hi = static_cast<uint32_t>(target & (SLOTS - 1));
+
+        if (lo <= hi)
+        {
+            uint64_t mask = m_occupied[0] & (~0ull << lo) & (~0ull >> (SLOTS - 1 - hi));
+
+            for (; mask != 0; mask &= mask - 1)
+            {
+                expireSlot(static_cast<uint32_t>(__builtin_ctzll(mask)), expired);
+            }
+        }
+
+        if (now <= blockLast)
+        {
+            m_currentTick = now;
+            return;
+        }
+
+        // Start the next block
+        m_currentTick = blockLast + 1;
+        cascade();
+
+        if (m_occupied[0] & 1ull)
+        {
+            expireSlot(0, expired);
+        }
+
+        expireSlot(DUE, expired);
+    }
+}
+
+uint64_t UdcTimerWheel::currentTick() const
+{
+    return m_currentTick;
+}
+
+uint64_t UdcTimerWheel::nextDeadline() const
+{
+    if (m_count == 0)
+    {
+        return NEVER;
+    }
+
+    if (m_heads[DUE] != NONE)
+    {
+        return m_currentTick;
+    }
+
+    // Level 0 slots hold single ticks of the current block
+    uint32_t index = static_cast<uint32_t>(m_currentTick & (SLOTS - 1));
+
+    uint64_t mask = (index == SLOTS - 1)
+        ? 0
+        : m_occupied[0] & (~0ull << (index + 1));
+
+    if (mask != 0)
+    {
+        return (m_currentTick & ~static_cast<uint64_t>(SLOTS - 1)) | static_cast<uint64_t>(__builtin_ctzll(mask));
+    }
+
+    // Higher level timers are due no earlier than their slot is cascaded
+    return nextCascadeTick();
+}
+
+void UdcTimerWheel::link(uint32_t timer)
+{
+    uint64_t deadline = m_deadlines[timer];
+    uint32_t slot;
+
+    if (deadline <= m_currentTick)
+    {
+        slot = DUE;
+    }
+    else
+    {
+        // The level is the highest 6-bit digit where the deadline differs from the current tick
+        uint32_t level = (63 - static_cast<uint32_t>(__builtin_clzll(deadline ^ m_currentTick))) / LEVEL_BITS;
+        uint32_t index;
+
+        if (level < LEVELS)
+        {
+            index = static_cast<uint32_t>(deadline >> (level * LEVEL_BITS)) & (SLOTS - 1);
+        }
+        else
+        {
+            // Beyond the range of the wheel, so the deadline is after the top level wraps
+            // park it in top level slot 0, which is redistributed when the top level wraps
+            level = LEVELS - 1;
+            index = 0;
+        }
+
+        slot = level * SLOTS + index;
+        m_occupied[level] |= 1ull << index;
+    }
+
+    uint32_t head = m_heads[slot];
+
+    m_prev[timer] = NONE;
+    m_next[timer] = head;
+    m_slots[timer] = slot;
+
+    if (head != NONE)
+    {
+        m_prev[head] = timer;
+    }
+
+    m_heads[slot] = timer;
+    ++m_count;
+}
+
+void UdcTimerWheel::unlink(uint32_t timer)
+{
+    uint32_t slot = m_slots[timer];
+    uint32_t prev = m_prev[timer];
+    uint32_t next = m_next[timer];
+
+    if (prev != NONE)
+    {
+        m_next[prev] = next;
+    }
+    else
+    {
+        m_heads[slot] = next;
+
+        if (next == NONE && slot != DUE)
+        {
+            m_occupied[slot / SLOTS] &= ~(1ull << (slot % SLOTS));
+        }
+    }
+
+    if (next != NONE)
+    {
+        m_prev[next] = prev;
+    }
+
+    m_slots[timer] = NONE;
+    --m_count;
+}
+
+void UdcTimerWheel::expireSlot(uint32_t slot, std::vector<uint32_t>& expired)
+{
+    uint32_t timer = m_heads[slot];
+
+    while (timer != NONE)
+    {
+        uint32_t next = m_next[timer];
+
+        m_slots[timer] = NONE;
+        --m_count;
+        expired.push_back(timer);
+
+        timer = next;
+    }
+
+    m_heads[slot] = NONE;
+
+    if (slot != DUE)
+    {
+        m_occupied[slot / SLOTS] &= ~(1ull << (slot % SLOTS));
+    }
+}
+
+void UdcTimerWheel::cascade()
+{
+    // Level l is cascaded when every level below it has wrapped back to slot 0
+    uint32_t top = 1;
+
+    while (top < LEVELS - 1 && ((m_currentTick >> (top * LEVEL_BITS)) & (SLOTS - 1)) == 0)
+    {
+        ++top;
+    }
+
+    // Cascade higher levels first so their timers can land in lower level slots that are cascaded next
+    for (uint32_t level = top; level != 0; --level)
+    {
+        uint32_t index = static_cast<uint32_t>(m_currentTick >> (level * LEVEL_BITS)) & (SLOTS - 1);
+        uint32_t slot = level * SLOTS + index;
+        uint32_t timer = m_heads[slot];
+
+        m_heads[slot] = NONE;
+        m_occupied[level] &= ~(1ull << index);
+
+        while (timer != NONE)
+        {
+            uint32_t next = m_next[timer];
+
+            --m_count;
+            link(timer);
+
+            timer = next;
+        }
+    }
+}
+
+uint64_t UdcTimerWheel::nextCascadeTick() const
+{
+    // The first occupied slot after the current slot of the lowest level possible
+    for (uint32_t level = 1; level != LEVELS; ++level)
+    {
+        uint32_t shift = level * LEVEL_BITS;
+        uint32_t index = static_cast<uint32_t>(m_currentTick >> shift) & (SLOTS - 1);
+
+        uint64_t mask = (index == SLOTS - 1)
+            ? 0
+            : m_occupied[level] & (~0ull << (index + 1));
+
+        if (mask != 0)
+        {
+            uint64_t base = (m_currentTick >> (shift + LEVEL_BITS)) << (shift + LEVEL_BITS);
+            return base | (static_cast<uint64_t>(__builtin_ctzll(mask)) << shift);
+        }
+    }
+
+    // Timers parked beyond the range of the wheel
+    constexpr uint32_t top = LEVELS * LEVEL_BITS;
+    return ((m_currentTick >> top) + 1) << top;
+}
@@ -0,0 +1,165 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcWorkerPool.h"
+
+// The set of the nth processor of a set, counting around the set
+static UdcProcessorSet nthProcessor(const UdcProcessorSet& processors, uint32_t n)
+{
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i != 64; ++i)
+    {
+        count += (processors.mask >> i) & 1u;
+    }
+
+    n %= count;
+
+    for (uint32_t i = 0; i != 64; ++i)
+    {
+        if (((processors.mask >> i) & 1u) != 0 && n-- == 0)
+        {
+            return {processors.group, uint64_t(1) << i};
+        }
+    }
+
+    return processors;
+}
+
+UdcWorkerPool::UdcWorkerPool(uint32_t workerCount, UdcProcessorSet processors)
+    : m_workerCount(workerCount)
+    , m_processors(processors)
+    , m_ranges(new Range[workerCount])
+    , m_generation(0)
+    , m_busy(0)
+    , m_stopping(false)
+    , m_function(nullptr)
+    , m_context(nullptr)
+{
+    for (uint32_t i = 0; i != m_workerCount; ++i)
+    {
+        m_ranges[i].next.store(0, std::memory_order_relaxed);
+        m_ranges[i].end = 0;
+    }
+
+    // The calling thread is worker 0
+    for (uint32_t i = 1; i < m_workerCount; ++i)
+    {
+        m_threads.emplace_back(&UdcWorkerPool::runThread, this, i);
+    }
+}
+
+UdcWorkerPool::~UdcWorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+
+    m_start.notify_all();
+
+    for (auto& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+uint32_t UdcWorkerPool::workerCount() const
+{
+    return m_workerCount;
+}
+
+void UdcWorkerPool::run(uint32_t itemCount, WorkFunction function, void* context)
+{
+    if (itemCount == 0)
+    {
+        return;
+    }
+
+    // Not worth waking the threads for
+    if (m_workerCount == 1 || itemCount == 1)
+    {
+        for (uint32_t item = 0; item != itemCount; ++item)
+        {
+            function(context, 0, item);
+        }
+
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        for (uint32_t i = 0; i != m_workerCount; ++i)
+        {
+            auto begin = static_cast<uint32_t>(uint64_t(itemCount) * i / m_workerCount);
+            auto end = static_cast<uint32_t>(uint64_t(itemCount) * (i + 1) / m_workerCount);
+
+            m_ranges[i].next.store(begin, std::memory_order_relaxed);
+            m_ranges[i].end = end;
+        }
+
+        m_function = function;
+        m_context = context;
+        m_busy = m_workerCount - 1;
+        ++m_generation;
+    }
+
+    m_start.notify_all();
+
+    processItems(0);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this]() { return m_busy == 0; });
+}
+
+void UdcWorkerPool::runThread(uint32_t worker)
+{
+    // The calling thread is left on the first processor
+    if (m_processors.mask != 0)
+    {
+        UdcThreadPlacement::pinCurrentThread(nthProcessor(m_processors, worker));
+    }
+
+    uint64_t generation = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_start.wait(lock, [&]() { return m_stopping || m_generation != generation; });
+
+            if (m_stopping)
+            {
+                return;
+            }
+
+            generation = m_generation;
+        }
+
+        processItems(worker);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (--m_busy == 0)
+        {
+            m_done.notify_one();
+        }
+    }
+}
+
+void UdcWorkerPool::processItems(uint32_t worker)
+{
+    // The ranges were set under the mutex before this run started,
+    // so claiming an item only has to be atomic
+    for (uint32_t i = 0; i != m_workerCount; ++i)
+    {
+        auto& range = m_ranges[(worker + i) % m_workerCount];
+        uint32_t item;
+
+        while ((item = range.next.fetch_add(1, std::memory_order_relaxed)) < range.end)
+        {
+            m_function(m_context, worker, item);
+        }
+    }
+}
@@ -43,6 +43,43 @@ UdcServer* udcCreateServer(
     return reinterpret_cast<UdcServer*>(server);
 }
 
+UdcServer* udcCreateServerRing(
+    UdcSignature signature,
+    uint8_t* buffer,
+    uint32_t size,
+    uint32_t slotCount,
+    UdcRingMode mode,
+    const char* logFileName)
+{
+    if (slotCount == 0 || size / slotCount < udcGetMinimumBufferSize())
+    {
+        return nullptr;
+    }
+
+    auto* server = udcCreateServer(signature, buffer, size, logFileName);
+
+    if (server == nullptr)
+    {
+        return nullptr;
+    }
+
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+
+    if (!serverImpl->setEventRing(slotCount, mode == UDC_RING_MANUAL_RELEASE))
+    {
+        udcDeleteServer(server);
+        return nullptr;
+    }
+
+    return server;
+}
+
+bool udcReleaseMessage(UdcServer* server, uint32_t msgIndex)
+{
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    return serverImpl->releaseMessage(msgIndex);
+}
+
 void udcDeleteServer(UdcServer* server)
 {
     delete reinterpret_cast<UdcServerImpl*>(server);
@@ -53,6 +90,8 @@ bool udcTryBindIPv4(
     uint16_t port)
 {
     auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    auto lock = serverImpl->lockState();
+
     return serverImpl->tryBindIPv4(port);
 }
 
@@ -61,9 +100,27 @@ bool udcTryBindIPv6(
     uint16_t port)
 {
     auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    auto lock = serverImpl->lockState();
+
     return serverImpl->tryBindIPv6(port);
 }
 
+bool udcEnableSharedMemory(UdcServer* server)
+{
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    auto lock = serverImpl->lockState();
+
+    return serverImpl->enableSharedMemory();
+}
+
+void udcGetSharedMemoryCounters(UdcServer* server, uint64_t& sent, uint64_t& received)
+{
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    auto lock = serverImpl->lockState();
+
+    serverImpl->getSharedMemoryCounters(sent, received);
+}
+
 bool udcTryParseAddressIPv4(
     const char* nodeName,
     const char* serviceName,
@@ -89,24 +146,74 @@ bool udcTryConnect(
     uint32_t timeout,
     UdcEndPointId& endPointId)
 {
-    uint16_t port;
+    if (server == nullptr || timeout == 0)
+    {
+        return false;
+    }
 
-    union
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+
+    // The resolver has its own lock, so a slow lookup doesn't hold up the I/O thread
+    UdcResolver::Addresses addresses;
+
+    if (!serverImpl->resolveAddress(nodeName, serviceName, addresses))
     {
-        UdcAddressIPv4 ipv4;
-        UdcAddressIPv6 ipv6;
-    };
+        return false;
+    }
+
+    auto currentTime = UdcServerImpl::currentTime();
+    auto lock = serverImpl->lockState();
 
-    if (UdcSocket::stringToIPv6(nodeName, serviceName, ipv6, port))
+    // Races both families when the name has both
+    return serverImpl->addPendingClient(
+        addresses,
+        std::chrono::milliseconds(timeout),
+        std::min(std::chrono::milliseconds(500),
+        std::chrono::milliseconds(timeout) / 10),
+        currentTime,
+        endPointId);
+}
+
+bool udcTryConnectAsync(
+    UdcServer* server,
+    const char* nodeName,
+    const char* serviceName,
+    uint32_t timeout,
+    UdcEndPointId& endPointId)
+{
+    if (server == nullptr || timeout == 0)
     {
-        return udcTryConnectIPv6(server, ipv6, port, timeout, endPointId);
+        return false;
     }
-    else if (UdcSocket::stringToIPv4(nodeName, serviceName, ipv4, port))
+
+    auto currentTime = UdcServerImpl::currentTime();
+
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    auto lock = serverImpl->lockState();
+
+    return serverImpl->addResolvingClient(
+        nodeName,
+        serviceName,
+        std::chrono::milliseconds(timeout),
+        std::min(std::chrono::milliseconds(500),
+        std::chrono::milliseconds(timeout) / 10),
+        currentTime,
+        endPointId);
+}
+
+void udcSetResolverCache(
+    UdcServer* server,
+    uint32_t positiveTtl,
+    uint32_t negativeTtl)
+{
+    if (server == nullptr)
     {
-        return udcTryConnectIPv4(server, ipv4, port, timeout, endPointId);
+        return;
     }
 
-    return false;
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+
+    serverImpl->setResolverTtl(std::chrono::milliseconds(positiveTtl), std::chrono::milliseconds(negativeTtl));
 }
 
 bool udcTryConnectIPv4(
@@ -121,10 +228,10 @@ bool udcTryConnectIPv4(
         return false;
     }
 
-    auto currentTime = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::system_clock::now().time_since_epoch());
+    auto currentTime = UdcServerImpl::currentTime();
 
     auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    auto lock = serverImpl->lockState();
 
     UdcAddressMux address =
         {
@@ -133,19 +240,14 @@ bool udcTryConnectIPv4(
             .port = port,
         };
 
-    endPointId = serverImpl->createUniqueId();
-
-    auto client = std::make_shared<UdcClient>(
-        endPointId,
+    // Add to pending
+    return serverImpl->addPendingClient(
         address,
         std::chrono::milliseconds(timeout),
         std::min(std::chrono::milliseconds(500),
-        std::chrono::milliseconds(timeout) / 10));
-
-    // Add to pending
-    serverImpl->addPendingClient(std::move(client), currentTime);
-
-    return true;
+        std::chrono::milliseconds(timeout) / 10),
+        currentTime,
+        endPointId);
 }
 
 bool udcTryConnectIPv6(
@@ -160,10 +262,10 @@ bool udcTryConnectIPv6(
         return false;
     }
 
-    auto currentTime = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::system_clock::now().time_since_epoch());
+    auto currentTime = UdcServerImpl::currentTime();
 
     auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    auto lock = serverImpl->lockState();
 
     UdcAddressMux address =
         {
@@ -172,29 +274,38 @@ bool udcTryConnectIPv6(
             .port = port,
         };
 
-    endPointId = serverImpl->createUniqueId();
-
-    auto client = std::make_shared<UdcClient>(
-        endPointId,
+    // Add to pending
+    return serverImpl->addPendingClient(
         address,
         std::chrono::milliseconds(timeout),
         std::min(std::chrono::milliseconds(500),
-        std::chrono::milliseconds(timeout) / 10));
+        std::chrono::milliseconds(timeout) / 10),
+        currentTime,
+        endPointId);
+}
 
-    // Add to pending
-    serverImpl->addPendingClient(std::move(client), currentTime);
+bool udcGetStatus(UdcServer* server, UdcEndPointId id, uint32_t& ping)
+{
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    auto lock = serverImpl->lockState();
 
-    return true;
+    std::chrono::microseconds cping(0);
+
+    bool result = serverImpl->getEndPointStatus(id, cping);
+    ping = std::chrono::duration_cast<std::chrono::milliseconds>(cping).count();
+
+    return result;
 }
 
-bool udcGetStatus(UdcServer* server, UdcEndPointId id, uint32_t& ping)
+bool udcGetStatusMicroseconds(UdcServer* server, UdcEndPointId id, uint32_t& ping)
 {
     auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    auto lock = serverImpl->lockState();
 
-    std::chrono::milliseconds cping;
+    std::chrono::microseconds cping(0);
 
     bool result = serverImpl->getEndPointStatus(id, cping);
-    ping = cping.count();
+    ping = static_cast<uint32_t>(cping.count());
 
     return result;
 }
@@ -202,34 +313,121 @@ bool udcGetStatus(UdcServer* server, UdcEndPointId id, uint32_t& ping)
 void udcDisconnect(UdcServer* server, UdcEndPointId endPointId)
 {
     auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    auto lock = serverImpl->lockState();
+
     serverImpl->disconnectFromClient(endPointId);
 }
 
-const UdcEvent* udcProcessEvents(UdcServer* server)
+bool udcSetEndPointContext(UdcServer* server, UdcEndPointId endPointId, void* context)
+{
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    auto lock = serverImpl->lockState();
+
+    return serverImpl->setEndPointContext(endPointId, context);
+}
+
+bool udcGetReliableProgress(UdcServer* server, UdcEndPointId endPointId, uint64_t& acknowledged, uint32_t& queued)
+{
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    auto lock = serverImpl->lockState();
+
+    return serverImpl->getReliableProgress(endPointId, acknowledged, queued);
+}
+
+bool udcSetOrderedConnectionEvents(UdcServer* server, bool ordered)
+{
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    auto lock = serverImpl->lockState();
+
+    return serverImpl->setOrderedConnectionEvents(ordered);
+}
+
+bool udcSetReliableStateLimits(UdcServer* server, uint32_t capacity, uint32_t idleTimeout)
+{
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    auto lock = serverImpl->lockState();
+
+    return serverImpl->setReliableStateLimits(capacity, std::chrono::milliseconds(idleTimeout));
+}
+
+void udcGetReliableStateMetrics(UdcServer* server, uint32_t& size, uint64_t& evictions, uint64_t& expirations)
+{
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    auto lock = serverImpl->lockState();
+
+    serverImpl->getReliableStateMetrics(size, evictions, expirations);
+}
+
+bool udcGetStats(UdcServer* server, UdcEndPointId endPointId, UdcStats& stats)
+{
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    auto lock = serverImpl->lockState();
+
+    return serverImpl->getStats(endPointId, stats);
+}
+
+bool udcSetConnectionCallback(UdcServer* server, UdcEventType eventType, UdcConnectionCallback callback, void* context)
+{
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    auto lock = serverImpl->lockState();
+
+    return serverImpl->setConnectionCallback(eventType, callback, context);
+}
+
+void udcSetMessageIPv4Callback(UdcServer* server, UdcMessageIPv4Callback callback, void* context)
 {
-    const auto currentTime = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::system_clock::now().time_since_epoch());
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    auto lock = serverImpl->lockState();
 
+    serverImpl->setMessageCallback(callback, context);
+}
+
+void udcSetMessageIPv6Callback(UdcServer* server, UdcMessageIPv6Callback callback, void* context)
+{
     auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    auto lock = serverImpl->lockState();
+
+    serverImpl->setMessageCallback(callback, context);
+}
+
+const UdcEvent* udcProcessEvents(UdcServer* server)
+{
+    // Every update in this pass uses the same time
+    const auto currentTime = UdcServerImpl::currentTime();
 
-    // Send outgoing pending connection requests
-    auto* event = serverImpl->updatePendingClients(currentTime);
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
 
-    if (event != nullptr)
+    // The I/O thread has already done the work
+    if (serverImpl->ioThreadRunning())
     {
-        return event;
+        return serverImpl->popIoEvent();
     }
 
-    // Send pings and get connection status
-    event = serverImpl->updateClientConnectionStatus(currentTime);
+    // Send messages submitted by other threads
+    serverImpl->flushSendQueue();
+
+    // Send connection requests, pings and reliable messages
+    // and get connection status
+    const UdcEvent* event;
 
-    if (event != nullptr)
+    while ((event = serverImpl->updateTimers(currentTime)) != nullptr)
     {
-        return event;
+        if (!serverImpl->dispatchEvent(event))
+        {
+            return event;
+        }
     }
 
     // Receive messages
-    return serverImpl->receiveMessages(currentTime);
+    while ((event = serverImpl->receiveMessages(currentTime)) != nullptr)
+    {
+        if (!serverImpl->dispatchEvent(event))
+        {
+            return event;
+        }
+    }
+
+    return nullptr;
 }
 
 UdcEventType udcGetEventType(const UdcEvent* event)
@@ -243,12 +441,247 @@ bool udcSendMessage(
     const uint8_t* data,
     uint32_t size,
     UdcMessageType reliability)
+{
+    UdcSegment segment = {data, size};
+
+    return udcSendMessageV(server, endPointId, &segment, 1, reliability);
+}
+
+bool udcSendMessageV(
+    UdcServer* server,
+    UdcEndPointId endPointId,
+    const UdcSegment* segments,
+    uint32_t segmentCount,
+    UdcMessageType reliability)
 {
     auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
 
+    // The I/O thread sends it
+    if (serverImpl->ioThreadRunning())
+    {
+        return segmentCount <= UDC_MAX_MESSAGE_SEGMENTS && serverImpl->queueMessage(endPointId, segments, segmentCount, reliability);
+    }
+
     return (reliability == UDC_UNRELIABLE_MESSAGE)
-        ? serverImpl->sendUnreliableMessage(endPointId, data, size)
-        : serverImpl->sendReliableMessage(endPointId, data, size);
+        ? serverImpl->sendUnreliableMessage(endPointId, segments, segmentCount)
+        : serverImpl->sendReliableMessage(endPointId, segments, segmentCount);
+}
+
+bool udcSetMaintenanceThreads(UdcServer* server, uint32_t threadCount)
+{
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    auto lock = serverImpl->lockState();
+    return serverImpl->setMaintenanceThreads(threadCount);
+}
+
+bool udcSetThreadAffinity(UdcServer* server, UdcThreadRole role, uint16_t processorGroup, uint64_t processorMask)
+{
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    auto lock = serverImpl->lockState();
+    return serverImpl->setThreadAffinity(role, {processorGroup, processorMask});
+}
+
+bool udcReserveEndPoints(UdcServer* server, uint32_t count)
+{
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    auto lock = serverImpl->lockState();
+    return serverImpl->reserveEndPoints(count);
+}
+
+uint8_t* udcAllocateBuffer(uint32_t size, uint16_t processorGroup, uint64_t processorMask)
+{
+    return UdcThreadPlacement::allocate(size, {processorGroup, processorMask});
+}
+
+void udcFreeBuffer(uint8_t* buffer)
+{
+    UdcThreadPlacement::free(buffer);
+}
+
+bool udcStartIoThread(UdcServer* server, uint32_t eventCapacity, uint32_t period)
+{
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    return serverImpl->startIoThread(eventCapacity, std::chrono::microseconds(period));
+}
+
+void udcStopIoThread(UdcServer* server)
+{
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    serverImpl->stopIoThread();
+}
+
+void* udcGetEventHandle(UdcServer* server)
+{
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    return serverImpl->eventHandle();
+}
+
+uint32_t udcGetNextTimeout(UdcServer* server)
+{
+    auto currentTime = UdcServerImpl::currentTime();
+
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    auto lock = serverImpl->lockState();
+
+    auto timeout = serverImpl->nextTimeout(currentTime);
+
+    return static_cast<uint32_t>(std::min<int64_t>(timeout.count(), UDC_NO_TIMEOUT));
+}
+
+bool udcWaitEvents(UdcServer* server, uint32_t timeout)
+{
+    auto currentTime = UdcServerImpl::currentTime();
+
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    std::chrono::microseconds waitTime;
+
+    {
+        auto lock = serverImpl->lockState();
+        waitTime = std::min(std::chrono::microseconds(timeout), serverImpl->nextTimeout(currentTime));
+    }
+
+    if (waitTime.count() == 0)
+    {
+        return true;
+    }
+
+    // Timers are due when the wait ends early because of them
+    return serverImpl->waitForEvents(waitTime) || waitTime < std::chrono::microseconds(timeout);
+}
+
+bool udcSetIoBusyPoll(UdcServer* server, uint32_t spinPeriod)
+{
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    return serverImpl->setIoBusyPoll(std::chrono::microseconds(spinPeriod));
+}
+
+void udcGetIoWaitCounters(UdcServer* server, uint64_t& spins, uint64_t& sleeps, uint64_t& wakeups)
+{
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    serverImpl->getIoWaitCounters(spins, sleeps, wakeups);
+}
+
+bool udcCreateSendQueue(UdcServer* server, uint32_t capacity)
+{
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    return serverImpl->createSendQueue(capacity);
+}
+
+bool udcQueueMessage(UdcServer* server, UdcEndPointId endPointId, const uint8_t* data, uint32_t size, UdcMessageType reliability)
+{
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+
+    UdcSegment segment = {data, size};
+
+    return serverImpl->queueMessage(endPointId, &segment, 1, reliability);
+}
+
+bool udcCreateGroup(UdcServer* server, UdcGroupId& groupId)
+{
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    auto lock = serverImpl->lockState();
+
+    return serverImpl->createGroup(groupId);
+}
+
+bool udcDeleteGroup(UdcServer* server, UdcGroupId groupId)
+{
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    auto lock = serverImpl->lockState();
+
+    return serverImpl->deleteGroup(groupId);
+}
+
+bool udcAddToGroup(UdcServer* server, UdcGroupId groupId, UdcEndPointId endPointId)
+{
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    auto lock = serverImpl->lockState();
+
+    return serverImpl->addToGroup(groupId, endPointId);
+}
+
+bool udcRemoveFromGroup(UdcServer* server, UdcGroupId groupId, UdcEndPointId endPointId)
+{
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    auto lock = serverImpl->lockState();
+
+    return serverImpl->removeFromGroup(groupId, endPointId);
+}
+
+bool udcSendMessageGroup(
+    UdcServer* server,
+    UdcGroupId groupId,
+    const uint8_t* data,
+    uint32_t size,
+    UdcMessageType reliability)
+{
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+    auto lock = serverImpl->lockState();
+
+    UdcSegment segment = {data, size};
+
+    return serverImpl->sendGroupMessage(groupId, &segment, 1, reliability);
+}
+
+uint32_t udcProcessEventsBatch(UdcServer* server, UdcEvent* events, uint32_t capacity)
+{
+    // Every update in this batch uses the same time
+    const auto currentTime = UdcServerImpl::currentTime();
+
+    auto* serverImpl = reinterpret_cast<UdcServerImpl*>(server);
+
+    // The I/O thread has already done the work
+    if (serverImpl->ioThreadRunning())
+    {
+        return serverImpl->popIoEvents(events, capacity);
+    }
+
+    uint32_t count = 0;
+
+    // Send messages submitted by other threads
+    serverImpl->flushSendQueue();
+
+    // Send connection requests, pings and reliable messages
+    // and get connection status
+    while (count != capacity)
+    {
+        auto* event = serverImpl->updateTimers(currentTime);
+
+        if (event == nullptr)
+        {
+            break;
+        }
+
+        if (!serverImpl->dispatchEvent(event))
+        {
+            events[count++] = *event;
+        }
+    }
+
+    // Receive messages, each message in the batch needs its own slot, and so do the ones
+    // passed to a callback, or they could recycle the slot of a message in the batch
+    uint32_t messageLimit = serverImpl->slotCount();
+
+    while (count != capacity)
+    {
+        auto* event = serverImpl->receiveMessages(currentTime, messageLimit);
+
+        if (event == nullptr)
+        {
+            break;
+        }
+
+        bool message = event->eventType == UDC_EVENT_RECEIVE_MESSAGE_IPV4 || event->eventType == UDC_EVENT_RECEIVE_MESSAGE_IPV6;
+
+        if (!message && serverImpl->dispatchEvent(event))
+        {
+            continue;
+        }
+
+        events[count++] = *event;
+    }
+
+    return count;
 }
 
 bool udcGetResultConnectionEvent(const UdcEvent* event, UdcEndPointId& endPointId)
@@ -291,3 +724,16 @@ bool udcGetResultMessageIPv6Event(const UdcEvent* event, UdcAddressIPv6& address
 
     return true;
 }
+
+bool udcGetResultMessageEndPoint(const UdcEvent* event, UdcEndPointId& endPointId, void*& context)
+{
+    if (event->eventType != UDC_EVENT_RECEIVE_MESSAGE_IPV4 && event->eventType != UDC_EVENT_RECEIVE_MESSAGE_IPV6)
+    {
+        return false;
+    }
+
+    endPointId = event->endPointId;
+    context = event->context;
+
+    return true;
+}
@@ -0,0 +1,219 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcAsync.h"
+
+#include <cstring>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include <chrono>
+#include <iostream>
+
+// Counts every heap allocation made by the process
+static uint64_t allocationCount = 0;
+
+void* operator new(size_t size)
+{
+    ++allocationCount;
+
+    void* ptr = malloc(size == 0 ? 1 : size);
+
+    if (ptr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    return ptr;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+constexpr uint32_t warmUpMessages = 20;
+constexpr uint32_t totalMessages = 200;
+
+// State shared with the coroutines
+struct Progress
+{
+    bool failed = false;
+    bool finished = false;
+    bool cancelled = false;
+    uint32_t roundTrips = 0;
+    uint64_t allocationsAfterWarmUp = 0;
+    UdcEndPointId idB = 0;
+};
+
+// Echo every message back to the endpoint it came from
+UdcTask echo(UdcAsyncServer& server, Progress& progress)
+{
+    auto endPoint = co_await server.connect("127.0.0.1", "2345", 1000);
+
+    if (!endPoint)
+    {
+        progress.failed = true;
+        co_return;
+    }
+
+    while (true)
+    {
+        auto message = co_await endPoint.receive();
+
+        if (!message || !co_await endPoint.sendReliable(message.data(), message.size()))
+        {
+            co_return;
+        }
+    }
+}
+
+// Send numbered messages, each after the previous one has been acknowledged and echoed
+UdcTask ping(UdcAsyncServer& server, Progress& progress)
+{
+    auto endPoint = co_await server.connect("127.0.0.1", "2346", 1000);
+
+    if (!endPoint)
+    {
+        progress.failed = true;
+        co_return;
+    }
+
+    progress.idB = endPoint.id();
+
+    for (uint32_t i = 0; i != totalMessages; ++i)
+    {
+        if (i == warmUpMessages)
+        {
+            progress.allocationsAfterWarmUp = allocationCount;
+        }
+
+        if (!co_await endPoint.sendReliable(reinterpret_cast<const uint8_t*>(&i), sizeof(i)))
+        {
+            std::cout << "message " << i << " wasn't acknowledged\n";
+            progress.failed = true;
+            co_return;
+        }
+
+        auto reply = co_await endPoint.receive();
+
+        if (!reply || reply.size() != sizeof(i) || memcmp(reply.data(), &i, sizeof(i)) != 0)
+        {
+            std::cout << "reply " << i << " wasn't the same\n";
+            progress.failed = true;
+            co_return;
+        }
+
+        ++progress.roundTrips;
+    }
+
+    progress.allocationsAfterWarmUp = allocationCount - progress.allocationsAfterWarmUp;
+    progress.finished = true;
+
+    // Nothing else is sent, so this only returns when cancelled
+    auto message = co_await endPoint.receive();
+    progress.cancelled = !message;
+}
+
+int main()
+{
+    UdcSignature sig = {{0x01, 0x02, 0x03, 0x04}};
+
+    // Messages wait in their slots until the coroutines take them
+    std::vector<uint8_t> bufferA(16 * 64);
+    std::vector<uint8_t> bufferB(16 * 64);
+
+    UdcServer* nodeA = udcCreateServerRing(sig, bufferA.data(), bufferA.size(), 16, UDC_RING_MANUAL_RELEASE, nullptr);
+    UdcServer* nodeB = udcCreateServerRing(sig, bufferB.data(), bufferB.size(), 16, UDC_RING_MANUAL_RELEASE, nullptr);
+
+    if (nodeA == nullptr || nodeB == nullptr)
+    {
+        std::cout << "failed to create nodes\n";
+        udcDeleteServer(nodeA);
+        udcDeleteServer(nodeB);
+        return -1;
+    }
+
+    if (!udcTryBindIPv4(nodeA, 2345) || !udcTryBindIPv4(nodeB, 2346))
+    {
+        std::cout << "failed to bind nodes\n";
+        udcDeleteServer(nodeA);
+        udcDeleteServer(nodeB);
+        return -1;
+    }
+
+    Progress progress;
+
+    {
+        UdcAsyncServer serverA(nodeA, bufferA.data());
+        UdcAsyncServer serverB(nodeB, bufferB.data());
+
+        echo(serverB, progress);
+        ping(serverA, progress);
+
+        auto t0 = std::chrono::system_clock::now();
+
+        while (!progress.finished && !progress.failed)
+        {
+            if (std::chrono::system_clock::now() - t0 >= std::chrono::seconds(10))
+            {
+                std::cout << "only " << progress.roundTrips << " of " << totalMessages << " round trips finished\n";
+                progress.failed = true;
+                break;
+            }
+
+            // Both servers run on this thread, so neither waits for long
+            serverA.run(1000);
+            serverB.run(1000);
+        }
+
+        if (!progress.failed)
+        {
+            serverA.cancel(progress.idB);
+        }
+
+        // The echo coroutine is still waiting, and is destroyed with serverB
+    }
+
+    udcDeleteServer(nodeA);
+    udcDeleteServer(nodeB);
+
+    if (progress.failed)
+    {
+        return -1;
+    }
+
+    if (!progress.cancelled)
+    {
+        std::cout << "waiting receive wasn't cancelled\n";
+        return -1;
+    }
+
+    if (progress.allocationsAfterWarmUp != 0)
+    {
+        std::cout << progress.allocationsAfterWarmUp << " allocations after warm up\n";
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,121 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcSocketMux.h"
+
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+int main()
+{
+    UdcSignature sig = {{0x01, 0x02, 0x03, 0x04}};
+
+    std::vector<uint8_t> buffer(2048);
+
+    // Create nodeA
+    UdcServer* nodeA = udcCreateServer(sig, buffer.data(), buffer.size(), "test_connect_async_logA.txt");
+
+    if (nodeA == nullptr)
+    {
+        std::cout << "failed to create Node A\n";
+        return -1;
+    }
+
+    if (!udcTryBindIPv4(nodeA, 2345))
+    {
+        std::cout << "failed to bind Node A\n";
+        return -1;
+    }
+
+    // Create nodeB
+    UdcServer* nodeB = udcCreateServer(sig, buffer.data(), buffer.size(), "test_connect_async_logB.txt");
+
+    if (nodeB == nullptr)
+    {
+        std::cout << "failed to create Node B\n";
+        udcDeleteServer(nodeA);
+        return -1;
+    }
+
+    if (!udcTryBindIPv4(nodeB, 2346))
+    {
+        std::cout << "failed to bind Node B\n";
+        return -1;
+    }
+
+    // Connect nodeA to nodeB, and to a name that can never be resolved
+    UdcEndPointId id;
+    UdcEndPointId invalidId;
+
+    if (!udcTryConnectAsync(nodeA, "127.0.0.1", "2346", 5000, id) ||
+        !udcTryConnectAsync(nodeA, "udp-connect.invalid", "2346", 1000, invalidId))
+    {
+        std::cout << "failed to initiate connections from A\n";
+        udcDeleteServer(nodeA);
+        udcDeleteServer(nodeB);
+        return -1;
+    }
+
+    // Receive until both connections have a result
+    bool connected = false;
+    bool timedOut = false;
+    const UdcEvent* event;
+    UdcEndPointId eventId;
+
+    auto t0 = std::chrono::system_clock::now();
+
+    while (!connected || !timedOut)
+    {
+        auto t1 = std::chrono::system_clock::now();
+        auto dt = t1 - t0;
+
+        if (dt >= std::chrono::seconds(5))
+        {
+            udcDeleteServer(nodeA);
+            udcDeleteServer(nodeB);
+            std::cout << "took too long.\n";
+            return -1;
+        }
+
+        // Receive from nodeA
+        while ((event = udcProcessEvents(nodeA)) != nullptr)
+        {
+            switch(udcGetEventType(event))
+            {
+            case UDC_EVENT_CONNECTION_SUCCESS:
+                if (!udcGetResultConnectionEvent(event, eventId) || eventId != id)
+                {
+                    udcDeleteServer(nodeA);
+                    udcDeleteServer(nodeB);
+                    std::cout << "wrong endpoint connected\n";
+                    return -1;
+                }
+                connected = true;
+                break;
+            case UDC_EVENT_CONNECTION_TIMEOUT:
+                if (!udcGetResultConnectionEvent(event, eventId) || eventId != invalidId)
+                {
+                    udcDeleteServer(nodeA);
+                    udcDeleteServer(nodeB);
+                    std::cout << "wrong endpoint timed out\n";
+                    return -1;
+                }
+                timedOut = true;
+                break;
+            default:
+                break;
+            }
+        }
+
+        // Receive from nodeB
+        while (udcProcessEvents(nodeB) != nullptr)
+        {
+        }
+    }
+
+    udcDeleteServer(nodeA);
+    udcDeleteServer(nodeB);
+
+    return 0;
+}
@@ -0,0 +1,157 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcSocketMux.h"
+
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Connect nodeA to a port nobody is bound to and then to nodeB,
+// returns the endpoints in the order their connection events happened
+bool connectBoth(UdcServer* nodeA, UdcServer* nodeB, std::vector<UdcEndPointId>& order, UdcEndPointId& deadId, UdcEndPointId& liveId)
+{
+    if (!udcTryConnect(nodeA, "127.0.0.1", "2347", 300, deadId) ||
+        !udcTryConnect(nodeA, "127.0.0.1", "2346", 1000, liveId))
+    {
+        std::cout << "failed to initiate connections\n";
+        return false;
+    }
+
+    auto t0 = std::chrono::system_clock::now();
+
+    while (order.size() < 2)
+    {
+        if (std::chrono::system_clock::now() - t0 >= std::chrono::seconds(5))
+        {
+            std::cout << "took too long to resolve connections\n";
+            return false;
+        }
+
+        const UdcEvent* event;
+
+        while ((event = udcProcessEvents(nodeA)) != nullptr)
+        {
+            UdcEndPointId id;
+
+            switch (udcGetEventType(event))
+            {
+                case UDC_EVENT_CONNECTION_SUCCESS:
+                    udcGetResultConnectionEvent(event, id);
+
+                    if (id != liveId)
+                    {
+                        std::cout << "unexpected connection success\n";
+                        return false;
+                    }
+
+                    order.push_back(id);
+                    break;
+                case UDC_EVENT_CONNECTION_TIMEOUT:
+                    udcGetResultConnectionEvent(event, id);
+
+                    if (id != deadId)
+                    {
+                        std::cout << "unexpected connection timeout\n";
+                        return false;
+                    }
+
+                    order.push_back(id);
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        while (udcProcessEvents(nodeB) != nullptr);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    return true;
+}
+
+int main()
+{
+    UdcSignature sig = {{0x01, 0x02, 0x03, 0x04}};
+
+    std::vector<uint8_t> buffer(2048);
+
+    UdcServer* nodeA = udcCreateServer(sig, buffer.data(), buffer.size(), "test_connect_parallel_logA.txt");
+    UdcServer* nodeB = udcCreateServer(sig, buffer.data(), buffer.size(), "test_connect_parallel_logB.txt");
+
+    auto deleteNodes = [&]()
+    {
+        udcDeleteServer(nodeA);
+        udcDeleteServer(nodeB);
+    };
+
+    if (nodeA == nullptr || nodeB == nullptr)
+    {
+        std::cout << "failed to create nodes\n";
+        deleteNodes();
+        return -1;
+    }
+
+    if (!udcTryBindIPv4(nodeA, 2345) || !udcTryBindIPv4(nodeB, 2346))
+    {
+        std::cout << "failed to bind nodes\n";
+        deleteNodes();
+        return -1;
+    }
+
+    std::vector<UdcEndPointId> order;
+    UdcEndPointId deadId;
+    UdcEndPointId liveId;
+
+    // Unordered, nodeB connects without waiting for the dead endpoint to time out
+    if (!connectBoth(nodeA, nodeB, order, deadId, liveId))
+    {
+        deleteNodes();
+        return -1;
+    }
+
+    if (order[0] != liveId)
+    {
+        std::cout << "connection to B waited for the dead endpoint\n";
+        deleteNodes();
+        return -1;
+    }
+
+    udcDisconnect(nodeA, liveId);
+
+    // Ordered, the connection to nodeB is reported after the dead endpoint times out
+    if (!udcSetOrderedConnectionEvents(nodeA, true))
+    {
+        std::cout << "failed to set ordered connection events\n";
+        deleteNodes();
+        return -1;
+    }
+
+    order.clear();
+
+    if (!connectBoth(nodeA, nodeB, order, deadId, liveId))
+    {
+        deleteNodes();
+        return -1;
+    }
+
+    if (order[0] != deadId)
+    {
+        std::cout << "connection events are out of order\n";
+        deleteNodes();
+        return -1;
+    }
+
+    uint32_t ping;
+    if (!udcGetStatus(nodeA, liveId, ping))
+    {
+        std::cout << "not connected to B\n";
+        deleteNodes();
+        return -1;
+    }
+
+    deleteNodes();
+    return 0;
+}
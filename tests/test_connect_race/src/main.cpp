@@ -0,0 +1,130 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcSocketMux.h"
+
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+int main()
+{
+    UdcSignature sig = {{0x01, 0x02, 0x03, 0x04}};
+
+    std::vector<uint8_t> buffer(2048);
+    std::vector<uint8_t> message = {0x01, 0x02, 0x03, 0x04};
+
+    // The race needs a name with both families
+    UdcAddressIPv6 localhostIPv6;
+    uint16_t localhostPort;
+
+    if (!udcTryParseAddressIPv6("localhost", "2346", localhostIPv6, localhostPort))
+    {
+        std::cout << "localhost has no IPv6 address, so there's nothing to race\n";
+        return 0;
+    }
+
+    // Create nodeA on both families
+    UdcServer* nodeA = udcCreateServer(sig, buffer.data(), buffer.size(), "test_connect_race_logA.txt");
+
+    if (nodeA == nullptr)
+    {
+        std::cout << "failed to create Node A\n";
+        return -1;
+    }
+
+    if (!udcTryBindIPv4(nodeA, 2345) || !udcTryBindIPv6(nodeA, 2345))
+    {
+        std::cout << "failed to bind Node A\n";
+        return -1;
+    }
+
+    // Create nodeB on IPv4 only, so that requests to its IPv6 address go unanswered
+    UdcServer* nodeB = udcCreateServer(sig, buffer.data(), buffer.size(), "test_connect_race_logB.txt");
+
+    if (nodeB == nullptr)
+    {
+        std::cout << "failed to create Node B\n";
+        udcDeleteServer(nodeA);
+        return -1;
+    }
+
+    if (!udcTryBindIPv4(nodeB, 2346))
+    {
+        std::cout << "failed to bind Node B\n";
+        return -1;
+    }
+
+    // Connect nodeA to nodeB, IPv6 is tried first and IPv4 wins the race
+    UdcEndPointId id;
+    if (!udcTryConnect(nodeA, "localhost", "2346", 5000, id))
+    {
+        std::cout << "failed to initiate connection from A to B\n";
+        udcDeleteServer(nodeA);
+        udcDeleteServer(nodeB);
+        return -1;
+    }
+
+    // Receive until B gets a message from A
+    uint32_t successCount = 0;
+    const UdcEvent* event;
+
+    auto t0 = std::chrono::system_clock::now();
+
+    while (true)
+    {
+        auto t1 = std::chrono::system_clock::now();
+        auto dt = t1 - t0;
+
+        if (dt >= std::chrono::seconds(5))
+        {
+            udcDeleteServer(nodeA);
+            udcDeleteServer(nodeB);
+            std::cout << "took too long.\n";
+            return -1;
+        }
+
+        // Send from A to B once connected, on the family that won
+        if (successCount != 0)
+        {
+            udcSendMessage(nodeA, id, message.data(), message.size(), UDC_UNRELIABLE_MESSAGE);
+        }
+
+        // Receive from nodeA
+        while ((event = udcProcessEvents(nodeA)) != nullptr)
+        {
+            switch(udcGetEventType(event))
+            {
+                case UDC_EVENT_CONNECTION_SUCCESS:
+                    ++successCount;
+                    break;
+                case UDC_EVENT_CONNECTION_TIMEOUT:
+                    std::cout << "connection timed out\n";
+                    udcDeleteServer(nodeA);
+                    udcDeleteServer(nodeB);
+                    return -1;
+                default:
+                    break;
+            }
+        }
+
+        if (successCount > 1)
+        {
+            std::cout << "connected more than once\n";
+            udcDeleteServer(nodeA);
+            udcDeleteServer(nodeB);
+            return -1;
+        }
+
+        // Receive from nodeB
+        while ((event = udcProcessEvents(nodeB)) != nullptr)
+        {
+            if (udcGetEventType(event) == UDC_EVENT_RECEIVE_MESSAGE_IPV4)
+            {
+                udcDeleteServer(nodeA);
+                udcDeleteServer(nodeB);
+                return 0;
+            }
+        }
+    }
+}
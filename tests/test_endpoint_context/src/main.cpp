@@ -0,0 +1,151 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcSocketMux.h"
+
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+int main()
+{
+    UdcSignature sig = {{0x01, 0x02, 0x03, 0x04}};
+
+    std::vector<uint8_t> buffer(2048);
+
+    UdcServer* nodeA = udcCreateServer(sig, buffer.data(), buffer.size(), "test_endpoint_context_logA.txt");
+    UdcServer* nodeB = udcCreateServer(sig, buffer.data(), buffer.size(), "test_endpoint_context_logB.txt");
+    UdcServer* nodeC = udcCreateServer(sig, buffer.data(), buffer.size(), "test_endpoint_context_logC.txt");
+
+    auto deleteNodes = [&]()
+    {
+        udcDeleteServer(nodeA);
+        udcDeleteServer(nodeB);
+        udcDeleteServer(nodeC);
+    };
+
+    if (nodeA == nullptr || nodeB == nullptr || nodeC == nullptr)
+    {
+        std::cout << "failed to create nodes\n";
+        deleteNodes();
+        return -1;
+    }
+
+    if (!udcTryBindIPv4(nodeA, 2345) || !udcTryBindIPv4(nodeB, 2346) || !udcTryBindIPv4(nodeC, 2347))
+    {
+        std::cout << "failed to bind nodes\n";
+        deleteNodes();
+        return -1;
+    }
+
+    // nodeA and nodeB are endpoints of each other, nodeA is an endpoint of nodeC but not the other way around
+    UdcEndPointId idA;
+    UdcEndPointId idB;
+    UdcEndPointId idAFromC;
+
+    if (!udcTryConnect(nodeA, "127.0.0.1", "2346", 10000, idB) ||
+        !udcTryConnect(nodeB, "127.0.0.1", "2345", 10000, idA) ||
+        !udcTryConnect(nodeC, "127.0.0.1", "2345", 10000, idAFromC))
+    {
+        std::cout << "failed to initiate connections\n";
+        deleteNodes();
+        return -1;
+    }
+
+    int contextB = 0;
+
+    if (!udcSetEndPointContext(nodeA, idB, &contextB))
+    {
+        std::cout << "failed to set endpoint context\n";
+        deleteNodes();
+        return -1;
+    }
+
+    if (udcSetEndPointContext(nodeA, idB + 1, &contextB))
+    {
+        std::cout << "set the context of an endpoint that doesn't exist\n";
+        deleteNodes();
+        return -1;
+    }
+
+    bool receivedFromB = false;
+    bool receivedFromC = false;
+    bool sentFromB = false;
+    bool sentFromC = false;
+
+    auto t0 = std::chrono::system_clock::now();
+
+    while (!receivedFromB || !receivedFromC)
+    {
+        if (std::chrono::system_clock::now() - t0 >= std::chrono::seconds(5))
+        {
+            std::cout << "took too long to receive messages\n";
+            deleteNodes();
+            return -1;
+        }
+
+        const UdcEvent* event;
+
+        while ((event = udcProcessEvents(nodeA)) != nullptr)
+        {
+            if (udcGetEventType(event) != UDC_EVENT_RECEIVE_MESSAGE_IPV4)
+            {
+                continue;
+            }
+
+            UdcEndPointId endPointId;
+            void* context;
+
+            if (!udcGetResultMessageEndPoint(event, endPointId, context))
+            {
+                std::cout << "failed to get the endpoint of a message\n";
+                deleteNodes();
+                return -1;
+            }
+
+            uint8_t from = buffer[event->msgIndex];
+
+            if (from == 'B' && (endPointId != idB || context != &contextB))
+            {
+                std::cout << "message from B has the wrong endpoint\n";
+                deleteNodes();
+                return -1;
+            }
+
+            if (from == 'C' && (endPointId != 0 || context != nullptr))
+            {
+                std::cout << "message from C has an endpoint\n";
+                deleteNodes();
+                return -1;
+            }
+
+            receivedFromB |= (from == 'B');
+            receivedFromC |= (from == 'C');
+        }
+
+        while (udcProcessEvents(nodeB) != nullptr);
+        while (udcProcessEvents(nodeC) != nullptr);
+
+        uint32_t ping;
+
+        if (!sentFromB && udcGetStatus(nodeB, idA, ping))
+        {
+            uint8_t msg = 'B';
+            udcSendMessage(nodeB, idA, &msg, 1, UDC_RELIABLE_MESSAGE);
+            sentFromB = true;
+        }
+
+        if (!sentFromC && udcGetStatus(nodeC, idAFromC, ping))
+        {
+            uint8_t msg = 'C';
+            udcSendMessage(nodeC, idAFromC, &msg, 1, UDC_RELIABLE_MESSAGE);
+            sentFromC = true;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    deleteNodes();
+    return 0;
+}
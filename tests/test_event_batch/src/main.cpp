@@ -0,0 +1,260 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcSocketMux.h"
+
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+// Connect a node to the node bound on port, processing both until connected
+bool connect(UdcServer* from, UdcServer* to, const char* nodeName, const char* port, UdcEndPointId& id)
+{
+    if (!udcTryConnect(from, nodeName, port, 1000, id))
+    {
+        return false;
+    }
+
+    UdcEvent events[16];
+
+    auto t0 = std::chrono::system_clock::now();
+
+    while (std::chrono::system_clock::now() - t0 < std::chrono::seconds(5))
+    {
+        while (udcProcessEventsBatch(to, events, 16) != 0);
+
+        uint32_t count;
+
+        while ((count = udcProcessEventsBatch(from, events, 16)) != 0)
+        {
+            for (uint32_t i = 0; i != count; ++i)
+            {
+                switch (events[i].eventType)
+                {
+                    case UDC_EVENT_CONNECTION_SUCCESS:
+                        return events[i].endPointId == id;
+                    case UDC_EVENT_CONNECTION_TIMEOUT:
+                        return false;
+                    default:
+                        break;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+// Count the IPv4 messages passed to the callback
+void __cdecl countMessage(
+    void* context, UdcEndPointId, void*, const UdcAddressIPv4&, uint16_t, uint32_t, uint32_t)
+{
+    ++*static_cast<uint32_t*>(context);
+}
+
+// nodeB passes IPv4 messages to a callback and returns IPv6 ones in the batch
+// the callback's messages take slots too, so they mustn't recycle the slot of a message in the batch
+// returns 0 on success
+int checkCallbackSlots(UdcServer* nodeA, UdcServer* nodeB, UdcEndPointId idB, const std::vector<uint8_t>& bufferB, uint32_t slotCount)
+{
+    constexpr uint32_t totalCallbackMessages = 32;
+    constexpr uint32_t totalMessages = 8;
+
+    std::vector<uint8_t> bufferC(2048);
+    UdcSignature sig = {{0x01, 0x02, 0x03, 0x04}};
+    UdcServer* nodeC = udcCreateServer(sig, bufferC.data(), bufferC.size(), nullptr);
+
+    UdcEndPointId idC;
+
+    if (nodeC == nullptr || !udcTryBindIPv6(nodeB, 2346) || !udcTryBindIPv6(nodeC, 2347) ||
+        !connect(nodeC, nodeB, "::1", "2346", idC))
+    {
+        std::cout << "failed to connect over IPv6\n";
+        udcDeleteServer(nodeC);
+        return -1;
+    }
+
+    uint32_t callbackMessages = 0;
+    udcSetMessageIPv4Callback(nodeB, countMessage, &callbackMessages);
+
+    // The IPv6 messages are received first, and the callback's messages come after them
+    for (uint32_t i = 0; i != totalMessages; ++i)
+    {
+        udcSendMessage(nodeC, idC, reinterpret_cast<uint8_t*>(&i), sizeof(i), UDC_UNRELIABLE_MESSAGE);
+    }
+
+    for (uint32_t i = 0; i != totalCallbackMessages; ++i)
+    {
+        uint32_t msg = ~0u;
+        udcSendMessage(nodeA, idB, reinterpret_cast<uint8_t*>(&msg), sizeof(msg), UDC_UNRELIABLE_MESSAGE);
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    UdcEvent events[2 * totalMessages];
+    uint32_t received = 0;
+    int result = 0;
+
+    auto t0 = std::chrono::system_clock::now();
+
+    while (result == 0 && (received < totalMessages || callbackMessages < totalCallbackMessages))
+    {
+        if (std::chrono::system_clock::now() - t0 >= std::chrono::seconds(1))
+        {
+            std::cout << "received " << received << " messages and " << callbackMessages << " through the callback\n";
+            result = -1;
+            break;
+        }
+
+        while (udcProcessEventsBatch(nodeA, events, 2 * totalMessages) != 0);
+        while (udcProcessEventsBatch(nodeC, events, 2 * totalMessages) != 0);
+
+        uint32_t callbackMessagesBefore = callbackMessages;
+        uint32_t count = udcProcessEventsBatch(nodeB, events, 2 * totalMessages);
+        uint32_t messageCount = 0;
+
+        for (uint32_t i = 0; i != count; ++i)
+        {
+            if (events[i].eventType != UDC_EVENT_RECEIVE_MESSAGE_IPV6)
+            {
+                continue;
+            }
+
+            // Every payload in the batch is still intact
+            if (events[i].msgSize != sizeof(received) ||
+                memcmp(&received, bufferB.data() + events[i].msgIndex, sizeof(received)) != 0)
+            {
+                std::cout << "message was overwritten by a message passed to the callback\n";
+                result = -1;
+                break;
+            }
+
+            ++received;
+            ++messageCount;
+        }
+
+        if (messageCount + callbackMessages - callbackMessagesBefore > slotCount)
+        {
+            std::cout << "batch took more slots than the ring has\n";
+            result = -1;
+        }
+    }
+
+    udcSetMessageIPv4Callback(nodeB, nullptr, nullptr);
+    udcDeleteServer(nodeC);
+
+    return result;
+}
+
+int main()
+{
+    constexpr uint32_t slotCount = 16;
+    constexpr uint32_t totalMessages = 32;
+
+    UdcSignature sig = {{0x01, 0x02, 0x03, 0x04}};
+
+    std::vector<uint8_t> bufferA(2048);
+    std::vector<uint8_t> bufferB(slotCount * 64);
+
+    UdcServer* nodeA = udcCreateServer(sig, bufferA.data(), bufferA.size(), "test_event_batch_logA.txt");
+    UdcServer* nodeB = udcCreateServerRing(sig, bufferB.data(), bufferB.size(), slotCount, UDC_RING_RECYCLE, "test_event_batch_logB.txt");
+
+    auto deleteNodes = [&]()
+    {
+        udcDeleteServer(nodeA);
+        udcDeleteServer(nodeB);
+    };
+
+    if (nodeA == nullptr || nodeB == nullptr)
+    {
+        std::cout << "failed to create nodes\n";
+        deleteNodes();
+        return -1;
+    }
+
+    if (!udcTryBindIPv4(nodeA, 2345) || !udcTryBindIPv4(nodeB, 2346))
+    {
+        std::cout << "failed to bind nodes\n";
+        deleteNodes();
+        return -1;
+    }
+
+    UdcEndPointId id;
+
+    if (!connect(nodeA, nodeB, "127.0.0.1", "2346", id))
+    {
+        std::cout << "failed to connect to B\n";
+        deleteNodes();
+        return -1;
+    }
+
+    // Every message is waiting to be received before nodeB processes events
+    for (uint32_t i = 0; i != totalMessages; ++i)
+    {
+        udcSendMessage(nodeA, id, reinterpret_cast<uint8_t*>(&i), sizeof(i), UDC_UNRELIABLE_MESSAGE);
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    UdcEvent events[2 * slotCount];
+    uint32_t received = 0;
+    uint32_t largestBatch = 0;
+
+    auto t0 = std::chrono::system_clock::now();
+
+    while (received < totalMessages)
+    {
+        if (std::chrono::system_clock::now() - t0 >= std::chrono::seconds(1))
+        {
+            std::cout << "received " << received << " of " << totalMessages << " messages\n";
+            deleteNodes();
+            return -1;
+        }
+
+        while (udcProcessEventsBatch(nodeA, events, 2 * slotCount) != 0);
+
+        uint32_t count = udcProcessEventsBatch(nodeB, events, 2 * slotCount);
+        uint32_t messageCount = 0;
+
+        for (uint32_t i = 0; i != count; ++i)
+        {
+            if (events[i].eventType != UDC_EVENT_RECEIVE_MESSAGE_IPV4)
+            {
+                continue;
+            }
+
+            // Every payload in the batch is still intact
+            if (events[i].msgSize != sizeof(received) ||
+                memcmp(&received, bufferB.data() + events[i].msgIndex, sizeof(received)) != 0)
+            {
+                std::cout << "message wasn't the same\n";
+                deleteNodes();
+                return -1;
+            }
+
+            ++received;
+            ++messageCount;
+        }
+
+        if (messageCount > slotCount)
+        {
+            std::cout << "batch held more messages than slots\n";
+            deleteNodes();
+            return -1;
+        }
+
+        largestBatch = std::max(largestBatch, messageCount);
+    }
+
+    if (largestBatch != slotCount)
+    {
+        std::cout << "messages weren't batched, largest batch was " << largestBatch << "\n";
+        deleteNodes();
+        return -1;
+    }
+
+    int result = checkCallbackSlots(nodeA, nodeB, id, bufferB, slotCount);
+
+    deleteNodes();
+    return result;
+}
@@ -0,0 +1,189 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcSocketMux.h"
+
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// State shared with the callbacks through their context
+struct Received
+{
+    UdcServer* server;
+    const uint8_t* buffer;
+    UdcEndPointId connectedId;
+    uint32_t messageCount;
+    bool corrupt;
+};
+
+void __cdecl onConnectionSuccess(void* context, UdcEndPointId endPointId)
+{
+    auto* received = static_cast<Received*>(context);
+    received->connectedId = endPointId;
+
+    // Messages from the endpoint are passed the same context
+    received->corrupt |= !udcSetEndPointContext(received->server, endPointId, received);
+}
+
+void __cdecl onMessageIPv4(
+    void* context,
+    UdcEndPointId endPointId,
+    void* endPointContext,
+    const UdcAddressIPv4& address,
+    uint16_t port,
+    uint32_t msgIndex,
+    uint32_t msgSize)
+{
+    auto* received = static_cast<Received*>(context);
+
+    // Messages are the bytes 0..msgSize-1 with the first byte replaced by the message number
+    const uint8_t* msg = received->buffer + msgIndex;
+
+    if (endPointId != received->connectedId || endPointContext != received ||
+        address.octets[0] != 127 || port != 2346 || msgSize != 64 || msg[0] != received->messageCount)
+    {
+        received->corrupt = true;
+    }
+
+    for (uint32_t i = 1; i < msgSize; ++i)
+    {
+        if (msg[i] != i)
+        {
+            received->corrupt = true;
+        }
+    }
+
+    ++received->messageCount;
+}
+
+int main()
+{
+    UdcSignature sig = {{0x01, 0x02, 0x03, 0x04}};
+
+    std::vector<uint8_t> bufferA(2048);
+    std::vector<uint8_t> bufferB(2048);
+
+    UdcServer* nodeA = udcCreateServer(sig, bufferA.data(), bufferA.size(), "test_event_callbacks_logA.txt");
+    UdcServer* nodeB = udcCreateServer(sig, bufferB.data(), bufferB.size(), "test_event_callbacks_logB.txt");
+
+    auto deleteNodes = [&]()
+    {
+        udcDeleteServer(nodeA);
+        udcDeleteServer(nodeB);
+    };
+
+    if (nodeA == nullptr || nodeB == nullptr)
+    {
+        std::cout << "failed to create nodes\n";
+        deleteNodes();
+        return -1;
+    }
+
+    if (!udcTryBindIPv4(nodeA, 2345) || !udcTryBindIPv4(nodeB, 2346))
+    {
+        std::cout << "failed to bind nodes\n";
+        deleteNodes();
+        return -1;
+    }
+
+    Received received = {nodeA, bufferA.data(), 0, 0, false};
+
+    if (udcSetConnectionCallback(nodeA, UDC_EVENT_RECEIVE_MESSAGE_IPV4, onConnectionSuccess, &received))
+    {
+        std::cout << "set a connection callback for message events\n";
+        deleteNodes();
+        return -1;
+    }
+
+    if (!udcSetConnectionCallback(nodeA, UDC_EVENT_CONNECTION_SUCCESS, onConnectionSuccess, &received))
+    {
+        std::cout << "failed to set connection callback\n";
+        deleteNodes();
+        return -1;
+    }
+
+    udcSetMessageIPv4Callback(nodeA, onMessageIPv4, &received);
+
+    // nodeB connects to nodeA, nodeA connects to nodeB and reports it through the callback
+    UdcEndPointId idA;
+    UdcEndPointId idB;
+
+    if (!udcTryConnect(nodeA, "127.0.0.1", "2346", 10000, idB) ||
+        !udcTryConnect(nodeB, "127.0.0.1", "2345", 10000, idA))
+    {
+        std::cout << "failed to initiate connections\n";
+        deleteNodes();
+        return -1;
+    }
+
+    const uint32_t messageCount = 16;
+    bool sent = false;
+
+    auto t0 = std::chrono::system_clock::now();
+
+    while (received.messageCount != messageCount)
+    {
+        if (std::chrono::system_clock::now() - t0 >= std::chrono::seconds(5))
+        {
+            std::cout << "took too long to receive messages\n";
+            deleteNodes();
+            return -1;
+        }
+
+        const UdcEvent* event;
+
+        // Events with a callback are never returned
+        while ((event = udcProcessEvents(nodeA)) != nullptr)
+        {
+            if (udcGetEventType(event) == UDC_EVENT_CONNECTION_SUCCESS ||
+                udcGetEventType(event) == UDC_EVENT_RECEIVE_MESSAGE_IPV4)
+            {
+                std::cout << "returned an event that has a callback\n";
+                deleteNodes();
+                return -1;
+            }
+        }
+
+        while (udcProcessEvents(nodeB) != nullptr);
+
+        uint32_t ping;
+
+        if (!sent && udcGetStatus(nodeB, idA, ping))
+        {
+            uint8_t msg[64];
+
+            for (uint32_t i = 0; i < sizeof(msg); ++i)
+            {
+                msg[i] = static_cast<uint8_t>(i);
+            }
+
+            for (uint32_t i = 0; i < messageCount; ++i)
+            {
+                msg[0] = static_cast<uint8_t>(i);
+                udcSendMessage(nodeB, idA, msg, sizeof(msg), UDC_RELIABLE_MESSAGE);
+            }
+
+            sent = true;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    deleteNodes();
+
+    if (received.connectedId != idB)
+    {
+        std::cout << "connection callback wasn't called\n";
+        return -1;
+    }
+
+    if (received.corrupt)
+    {
+        std::cout << "message wasn't the same\n";
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,225 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcSocketMux.h"
+
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+// Connect a node to the node bound on port, processing both until connected
+bool connect(UdcServer* from, UdcServer* to, const char* port, UdcEndPointId& id)
+{
+    // A long timeout, so the sender doesn't reset its reliable state while nodeB holds every slot
+    if (!udcTryConnect(from, "127.0.0.1", port, 10000, id))
+    {
+        return false;
+    }
+
+    auto t0 = std::chrono::system_clock::now();
+
+    while (std::chrono::system_clock::now() - t0 < std::chrono::seconds(5))
+    {
+        while (udcProcessEvents(to) != nullptr);
+
+        const UdcEvent* event;
+
+        while ((event = udcProcessEvents(from)) != nullptr)
+        {
+            switch (udcGetEventType(event))
+            {
+                case UDC_EVENT_CONNECTION_SUCCESS:
+                    return true;
+                case UDC_EVENT_CONNECTION_TIMEOUT:
+                    return false;
+                default:
+                    break;
+            }
+        }
+    }
+
+    return false;
+}
+
+// Process both nodes for a while, keeping the index of every message received by nodeB
+void receive(UdcServer* nodeA, UdcServer* nodeB, std::vector<uint32_t>& indices, uint32_t count, std::chrono::milliseconds duration)
+{
+    auto t0 = std::chrono::system_clock::now();
+
+    while (indices.size() < count && std::chrono::system_clock::now() - t0 < duration)
+    {
+        while (udcProcessEvents(nodeA) != nullptr);
+
+        const UdcEvent* event;
+
+        while ((event = udcProcessEvents(nodeB)) != nullptr)
+        {
+            UdcAddressIPv4 ip;
+            uint16_t port;
+            uint32_t index;
+            uint32_t size;
+
+            if (udcGetResultMessageIPv4Event(event, ip, port, index, size))
+            {
+                indices.push_back(index);
+            }
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+// Check that every received payload still holds the message it was received with
+bool payloadsIntact(const std::vector<uint8_t>& buffer, const std::vector<uint32_t>& indices)
+{
+    for (uint32_t i = 0; i != indices.size(); ++i)
+    {
+        if (memcmp(&i, buffer.data() + indices[i], sizeof(i)) != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Fill every slot of a ring with manual release, then release them and receive the rest
+// with an I/O thread, releases go through it to the thread that owns the slots
+// returns 0 on success
+int run(bool ioThread)
+{
+    constexpr uint32_t slotCount = 8;
+    constexpr uint32_t totalMessages = 12;
+
+    UdcSignature sig = {{0x01, 0x02, 0x03, 0x04}};
+
+    std::vector<uint8_t> bufferA(2048);
+    std::vector<uint8_t> bufferB(slotCount * 64);
+
+    if (udcCreateServerRing(sig, bufferB.data(), bufferB.size(), 0, UDC_RING_MANUAL_RELEASE, nullptr) != nullptr ||
+        udcCreateServerRing(sig, bufferB.data(), bufferB.size(), bufferB.size(), UDC_RING_MANUAL_RELEASE, nullptr) != nullptr)
+    {
+        std::cout << "created a ring with invalid slots\n";
+        return -1;
+    }
+
+    UdcServer* nodeA = udcCreateServer(sig, bufferA.data(), bufferA.size(), "test_event_ring_logA.txt");
+    UdcServer* nodeB = udcCreateServerRing(sig, bufferB.data(), bufferB.size(), slotCount, UDC_RING_MANUAL_RELEASE, "test_event_ring_logB.txt");
+
+    auto deleteNodes = [&]()
+    {
+        udcDeleteServer(nodeA);
+        udcDeleteServer(nodeB);
+    };
+
+    if (nodeA == nullptr || nodeB == nullptr)
+    {
+        std::cout << "failed to create nodes\n";
+        deleteNodes();
+        return -1;
+    }
+
+    if (!udcTryBindIPv4(nodeA, 2345) || !udcTryBindIPv4(nodeB, 2346))
+    {
+        std::cout << "failed to bind nodes\n";
+        deleteNodes();
+        return -1;
+    }
+
+    if (ioThread && !udcStartIoThread(nodeB, 128, 200))
+    {
+        std::cout << "failed to start the I/O thread\n";
+        deleteNodes();
+        return -1;
+    }
+
+    UdcEndPointId id;
+
+    if (!connect(nodeA, nodeB, "2346", id))
+    {
+        std::cout << "failed to connect to B\n";
+        deleteNodes();
+        return -1;
+    }
+
+    for (uint32_t i = 0; i != totalMessages; ++i)
+    {
+        udcSendMessage(nodeA, id, reinterpret_cast<uint8_t*>(&i), sizeof(i), UDC_RELIABLE_MESSAGE);
+    }
+
+    // Every slot fills up, and nothing more is received while they are held
+    std::vector<uint32_t> indices;
+
+    receive(nodeA, nodeB, indices, totalMessages, std::chrono::milliseconds(200));
+
+    if (indices.size() != slotCount)
+    {
+        std::cout << "received " << indices.size() << " messages into " << slotCount << " slots\n";
+        deleteNodes();
+        return -1;
+    }
+
+    if (!payloadsIntact(bufferB, indices))
+    {
+        std::cout << "a held payload was overwritten\n";
+        deleteNodes();
+        return -1;
+    }
+
+    // Releasing slots lets the rest of the messages in
+    for (uint32_t index : indices)
+    {
+        if (!udcReleaseMessage(nodeB, index))
+        {
+            std::cout << "failed to release a message\n";
+            deleteNodes();
+            return -1;
+        }
+    }
+
+    if (udcReleaseMessage(nodeB, indices.front()))
+    {
+        std::cout << "released a message twice\n";
+        deleteNodes();
+        return -1;
+    }
+
+    receive(nodeA, nodeB, indices, totalMessages, std::chrono::seconds(5));
+
+    if (indices.size() != totalMessages)
+    {
+        std::cout << "received " << indices.size() << " of " << totalMessages << " messages after releasing\n";
+        deleteNodes();
+        return -1;
+    }
+
+    // The slots of the released messages were reused, so only check the new ones
+    for (uint32_t i = slotCount; i != totalMessages; ++i)
+    {
+        if (memcmp(&i, bufferB.data() + indices[i], sizeof(i)) != 0)
+        {
+            std::cout << "message wasn't the same\n";
+            deleteNodes();
+            return -1;
+        }
+    }
+
+    deleteNodes();
+    return 0;
+}
+
+int main()
+{
+    if (run(false) != 0)
+    {
+        return -1;
+    }
+
+    if (run(true) != 0)
+    {
+        std::cout << "with an I/O thread\n";
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,161 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcSocketMux.h"
+
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// nodeA's I/O thread only updates every 100 ms, but with busy-polling it wakes as soon as
+// a packet arrives, so nodeB's connection and messages don't wait for the period
+
+int main()
+{
+    constexpr uint32_t totalMessages = 20;
+    constexpr auto period = std::chrono::milliseconds(100);
+
+    UdcSignature sig = {{0x01, 0x02, 0x03, 0x04}};
+
+    std::vector<uint8_t> bufferA(64 * 64);
+    std::vector<uint8_t> bufferB(2048);
+
+    UdcServer* nodeA = udcCreateServerRing(sig, bufferA.data(), bufferA.size(), 64, UDC_RING_RECYCLE, "test_io_busy_poll_logA.txt");
+    UdcServer* nodeB = udcCreateServer(sig, bufferB.data(), bufferB.size(), "test_io_busy_poll_logB.txt");
+
+    auto deleteNodes = [&]()
+    {
+        udcDeleteServer(nodeA);
+        udcDeleteServer(nodeB);
+    };
+
+    if (nodeA == nullptr || nodeB == nullptr)
+    {
+        std::cout << "failed to create nodes\n";
+        deleteNodes();
+        return -1;
+    }
+
+    if (!udcTryBindIPv4(nodeA, 2345) || !udcTryBindIPv4(nodeB, 2346))
+    {
+        std::cout << "failed to bind nodes\n";
+        deleteNodes();
+        return -1;
+    }
+
+    if (!udcSetIoBusyPoll(nodeA, 100) ||
+        !udcStartIoThread(nodeA, 128, std::chrono::microseconds(period).count()) ||
+        udcSetIoBusyPoll(nodeA, 0))
+    {
+        std::cout << "busy-polling could be changed while the I/O thread was running\n";
+        deleteNodes();
+        return -1;
+    }
+
+    // nodeA answers the connection request from its I/O thread
+    UdcEndPointId idA;
+
+    if (!udcTryConnect(nodeB, "127.0.0.1", "2345", 5000, idA))
+    {
+        std::cout << "failed to initiate connection\n";
+        deleteNodes();
+        return -1;
+    }
+
+    const UdcEvent* event;
+    bool connected = false;
+    auto t0 = std::chrono::system_clock::now();
+
+    while (!connected)
+    {
+        if (std::chrono::system_clock::now() - t0 >= std::chrono::seconds(5))
+        {
+            std::cout << "failed to connect\n";
+            deleteNodes();
+            return -1;
+        }
+
+        while ((event = udcProcessEvents(nodeB)) != nullptr)
+        {
+            connected |= udcGetEventType(event) == UDC_EVENT_CONNECTION_SUCCESS;
+        }
+    }
+
+    if (std::chrono::system_clock::now() - t0 >= period / 2)
+    {
+        std::cout << "the connection waited for the I/O thread's period\n";
+        deleteNodes();
+        return -1;
+    }
+
+    // nodeB sends messages that arrive while nodeA's I/O thread is spinning or sleeping
+    uint32_t received = 0;
+
+    for (uint32_t i = 0; i != totalMessages; ++i)
+    {
+        uint8_t msg = static_cast<uint8_t>(i);
+        udcSendMessage(nodeB, idA, &msg, 1, UDC_UNRELIABLE_MESSAGE);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    t0 = std::chrono::system_clock::now();
+
+    while (received != totalMessages)
+    {
+        if (std::chrono::system_clock::now() - t0 >= std::chrono::seconds(5))
+        {
+            std::cout << "received " << received << " of " << totalMessages << " messages\n";
+            deleteNodes();
+            return -1;
+        }
+
+        while ((event = udcProcessEvents(nodeA)) != nullptr)
+        {
+            received += udcGetEventType(event) == UDC_EVENT_RECEIVE_MESSAGE_IPV4;
+        }
+
+        while (udcProcessEvents(nodeB) != nullptr)
+        {
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    uint64_t spins;
+    uint64_t sleeps;
+    uint64_t wakeups;
+    udcGetIoWaitCounters(nodeA, spins, sleeps, wakeups);
+
+    if (sleeps == 0 || wakeups == 0)
+    {
+        std::cout << "the I/O thread slept " << sleeps << " times and was woken " << wakeups << " times\n";
+        deleteNodes();
+        return -1;
+    }
+
+    // While nodeA's application doesn't take its events, the thread stops receiving,
+    // and sleeps instead of spinning on the packets it leaves in the socket
+    for (uint32_t i = 0; i != 256; ++i)
+    {
+        uint8_t msg = static_cast<uint8_t>(i);
+        udcSendMessage(nodeB, idA, &msg, 1, UDC_UNRELIABLE_MESSAGE);
+    }
+
+    std::this_thread::sleep_for(period);
+
+    uint64_t fullSpins;
+    udcGetIoWaitCounters(nodeA, fullSpins, sleeps, wakeups);
+    std::this_thread::sleep_for(3 * period);
+    udcGetIoWaitCounters(nodeA, spins, sleeps, wakeups);
+
+    if (spins - fullSpins > 10)
+    {
+        std::cout << "the I/O thread spun " << spins - fullSpins << " times while its events were full\n";
+        deleteNodes();
+        return -1;
+    }
+
+    deleteNodes();
+    return 0;
+}
@@ -0,0 +1,135 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "udp_connect.h"
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// nodeA's I/O thread only updates once a second, but a message queued by its application
+// wakes it, so nodeB receives the message long before the period passes
+
+constexpr uint32_t ioPeriod = 1000000;
+
+// Connect nodeA to nodeB, processing both until connected
+bool connect(UdcServer* nodeA, UdcServer* nodeB, UdcEndPointId& idB)
+{
+    if (!udcTryConnect(nodeA, "127.0.0.1", "2346", 5000, idB))
+    {
+        return false;
+    }
+
+    auto t0 = std::chrono::system_clock::now();
+
+    while (std::chrono::system_clock::now() - t0 < std::chrono::seconds(5))
+    {
+        while (udcProcessEvents(nodeB) != nullptr);
+
+        const UdcEvent* event;
+
+        while ((event = udcProcessEvents(nodeA)) != nullptr)
+        {
+            if (udcGetEventType(event) == UDC_EVENT_CONNECTION_SUCCESS)
+            {
+                return true;
+            }
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    return false;
+}
+
+// Send from nodeA while its I/O thread sleeps, and time how long nodeB takes to receive it
+// returns 0 on success
+int sendWhileSleeping(UdcServer* nodeA, UdcServer* nodeB, UdcEndPointId idB, uint32_t spinPeriod)
+{
+    if (!udcSetIoBusyPoll(nodeA, spinPeriod) || !udcStartIoThread(nodeA, 128, ioPeriod))
+    {
+        std::cout << "failed to start the I/O thread\n";
+        return -1;
+    }
+
+    // Let the thread finish its first pass and go to sleep
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    uint8_t msg = 'A';
+    auto t0 = std::chrono::system_clock::now();
+
+    if (!udcSendMessage(nodeA, idB, &msg, 1, UDC_UNRELIABLE_MESSAGE))
+    {
+        std::cout << "failed to queue a message\n";
+        udcStopIoThread(nodeA);
+        return -1;
+    }
+
+    bool received = false;
+
+    while (!received && std::chrono::system_clock::now() - t0 < std::chrono::milliseconds(250))
+    {
+        const UdcEvent* event;
+
+        while ((event = udcProcessEvents(nodeB)) != nullptr)
+        {
+            received |= udcGetEventType(event) == UDC_EVENT_RECEIVE_MESSAGE_IPV4 && event->msgSize == 1;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    udcStopIoThread(nodeA);
+
+    if (!received)
+    {
+        std::cout << "queued message waited for the I/O period, spin period " << spinPeriod << "\n";
+        return -1;
+    }
+
+    return 0;
+}
+
+int main()
+{
+    UdcSignature sig = {{0x01, 0x02, 0x03, 0x04}};
+    std::vector<uint8_t> bufferA(2048);
+    std::vector<uint8_t> bufferB(2048);
+
+    UdcServer* nodeA = udcCreateServer(sig, bufferA.data(), bufferA.size(), nullptr);
+    UdcServer* nodeB = udcCreateServer(sig, bufferB.data(), bufferB.size(), nullptr);
+
+    auto deleteNodes = [&]()
+    {
+        udcDeleteServer(nodeA);
+        udcDeleteServer(nodeB);
+    };
+
+    if (nodeA == nullptr || nodeB == nullptr)
+    {
+        std::cout << "failed to create nodes\n";
+        deleteNodes();
+        return -1;
+    }
+
+    UdcEndPointId idB;
+
+    if (!udcTryBindIPv4(nodeA, 2345) || !udcTryBindIPv4(nodeB, 2346) || !connect(nodeA, nodeB, idB))
+    {
+        std::cout << "failed to connect\n";
+        deleteNodes();
+        return -1;
+    }
+
+    // Sleeping for the whole period, and then sleeping on the sockets after busy-polling
+    int result = sendWhileSleeping(nodeA, nodeB, idB, 0);
+
+    if (result == 0)
+    {
+        result = sendWhileSleeping(nodeA, nodeB, idB, 100);
+    }
+
+    deleteNodes();
+    return result;
+}
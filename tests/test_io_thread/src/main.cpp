@@ -0,0 +1,219 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcSocketMux.h"
+
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// nodeA has an I/O thread, so it keeps answering nodeB while its application stalls
+// for longer than the connection timeout; nodeB keeps sending reliable messages through the stall,
+// and only hears from nodeA through their acknowledgements, so it mustn't lose the connection
+//
+// received messages don't count as hearing from an endpoint, only pongs and acknowledgements do,
+// so nodeA itself may report its connection to nodeB as lost, and that isn't checked
+
+int main()
+{
+    UdcSignature sig = {{0x01, 0x02, 0x03, 0x04}};
+
+    // Every message received during the stall is held in its own slot
+    std::vector<uint8_t> bufferA(64 * 64);
+    std::vector<uint8_t> bufferB(2048);
+
+    UdcServer* nodeA = udcCreateServerRing(sig, bufferA.data(), bufferA.size(), 64, UDC_RING_RECYCLE, "test_io_thread_logA.txt");
+    UdcServer* nodeB = udcCreateServer(sig, bufferB.data(), bufferB.size(), "test_io_thread_logB.txt");
+
+    auto deleteNodes = [&]()
+    {
+        udcDeleteServer(nodeA);
+        udcDeleteServer(nodeB);
+    };
+
+    if (nodeA == nullptr || nodeB == nullptr)
+    {
+        std::cout << "failed to create nodes\n";
+        deleteNodes();
+        return -1;
+    }
+
+    if (!udcTryBindIPv4(nodeA, 2345) || !udcTryBindIPv4(nodeB, 2346))
+    {
+        std::cout << "failed to bind nodes\n";
+        deleteNodes();
+        return -1;
+    }
+
+    if (!udcStartIoThread(nodeA, 128, 200) || udcStartIoThread(nodeA, 128, 200))
+    {
+        std::cout << "failed to start exactly one I/O thread\n";
+        deleteNodes();
+        return -1;
+    }
+
+    // The connection is lost after 100 ms without hearing from the other node
+    UdcEndPointId idA;
+    UdcEndPointId idB;
+
+    if (!udcTryConnect(nodeA, "127.0.0.1", "2346", 1000, idB) ||
+        !udcTryConnect(nodeB, "127.0.0.1", "2345", 1000, idA))
+    {
+        std::cout << "failed to initiate connections\n";
+        deleteNodes();
+        return -1;
+    }
+
+    bool connectedA = false;
+    bool connectedB = false;
+    bool lost = false;
+    bool receivedFromA = false;
+    uint32_t receivedFromB = 0;
+    uint32_t sentFromB = 0;
+
+    // Process nodeB, and nodeA unless its application is stalled
+    auto process = [&](bool processA)
+    {
+        const UdcEvent* event;
+
+        while (processA && (event = udcProcessEvents(nodeA)) != nullptr)
+        {
+            switch (udcGetEventType(event))
+            {
+                case UDC_EVENT_CONNECTION_SUCCESS:
+                    connectedA = true;
+                    break;
+                case UDC_EVENT_CONNECTION_TIMEOUT:
+                    lost = true;
+                    break;
+                case UDC_EVENT_RECEIVE_MESSAGE_IPV4:
+                    if (event->msgSize != 1 || bufferA[event->msgIndex] != receivedFromB)
+                    {
+                        std::cout << "message from B wasn't the same\n";
+                        lost = true;
+                    }
+
+                    ++receivedFromB;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        while ((event = udcProcessEvents(nodeB)) != nullptr)
+        {
+            switch (udcGetEventType(event))
+            {
+                case UDC_EVENT_CONNECTION_SUCCESS:
+                    connectedB = true;
+                    break;
+                case UDC_EVENT_CONNECTION_TIMEOUT:
+                case UDC_EVENT_CONNECTION_LOST:
+                    lost = true;
+                    break;
+                case UDC_EVENT_RECEIVE_MESSAGE_IPV4:
+                    receivedFromA |= (event->msgSize == 1 && bufferB[event->msgIndex] == 'A');
+                    break;
+                default:
+                    break;
+            }
+        }
+    };
+
+    auto t0 = std::chrono::system_clock::now();
+
+    while (!connectedA || !connectedB)
+    {
+        if (std::chrono::system_clock::now() - t0 >= std::chrono::seconds(5) || lost)
+        {
+            std::cout << "failed to connect\n";
+            deleteNodes();
+            return -1;
+        }
+
+        process(true);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // nodeA's send is queued and sent by its I/O thread
+    uint8_t msg = 'A';
+
+    if (!udcSendMessage(nodeA, idB, &msg, 1, UDC_RELIABLE_MESSAGE))
+    {
+        std::cout << "failed to send from A\n";
+        deleteNodes();
+        return -1;
+    }
+
+    // nodeA's application stalls for three times the connection timeout
+    auto stallStart = std::chrono::system_clock::now();
+    auto nextSend = stallStart;
+
+    while (std::chrono::system_clock::now() - stallStart < std::chrono::milliseconds(300))
+    {
+        if (std::chrono::system_clock::now() >= nextSend)
+        {
+            msg = static_cast<uint8_t>(sentFromB++);
+            udcSendMessage(nodeB, idA, &msg, 1, UDC_RELIABLE_MESSAGE);
+            nextSend += std::chrono::milliseconds(10);
+        }
+
+        process(false);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    if (lost)
+    {
+        std::cout << "connection was lost during the stall\n";
+        deleteNodes();
+        return -1;
+    }
+
+    // The messages acknowledged by nodeA's I/O thread during the stall are waiting in its event queue
+    t0 = std::chrono::system_clock::now();
+
+    while (receivedFromB != sentFromB)
+    {
+        if (std::chrono::system_clock::now() - t0 >= std::chrono::seconds(5) || lost)
+        {
+            std::cout << "received " << receivedFromB << " of " << sentFromB << " messages from B\n";
+            deleteNodes();
+            return -1;
+        }
+
+        process(true);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    if (!receivedFromA)
+    {
+        std::cout << "message from A wasn't sent by the I/O thread\n";
+        deleteNodes();
+        return -1;
+    }
+
+    // Without the thread, nodeA goes back to being updated by udcProcessEvents()
+    udcStopIoThread(nodeA);
+
+    msg = static_cast<uint8_t>(sentFromB++);
+    udcSendMessage(nodeB, idA, &msg, 1, UDC_RELIABLE_MESSAGE);
+
+    t0 = std::chrono::system_clock::now();
+
+    while (receivedFromB != sentFromB)
+    {
+        if (std::chrono::system_clock::now() - t0 >= std::chrono::seconds(5) || lost)
+        {
+            std::cout << "failed to receive after stopping the I/O thread\n";
+            deleteNodes();
+            return -1;
+        }
+
+        process(true);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    deleteNodes();
+    return 0;
+}
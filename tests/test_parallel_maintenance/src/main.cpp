@@ -0,0 +1,224 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcSocketMux.h"
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main()
+{
+    // Enough endpoints for their timers to be split between the maintenance threads
+    constexpr uint32_t remoteCount = 96;
+    constexpr uint32_t totalMessages = 20;
+    constexpr uint16_t firstPort = 2346;
+
+    UdcSignature sig = {{0x01, 0x02, 0x03, 0x04}};
+
+    std::vector<uint8_t> bufferA(2048);
+    std::vector<std::vector<uint8_t>> buffers(remoteCount, std::vector<uint8_t>(2048));
+
+    // nodeA sends reliable messages to every remote node
+    UdcServer* nodeA = udcCreateServer(sig, bufferA.data(), bufferA.size(), "test_parallel_maintenance_logA.txt");
+    std::vector<UdcServer*> remotes(remoteCount, nullptr);
+
+    auto deleteNodes = [&]()
+    {
+        udcDeleteServer(nodeA);
+
+        for (auto* remote : remotes)
+        {
+            udcDeleteServer(remote);
+        }
+    };
+
+    if (nodeA == nullptr || !udcTryBindIPv4(nodeA, 2345))
+    {
+        std::cout << "failed to create Node A\n";
+        deleteNodes();
+        return -1;
+    }
+
+    for (uint32_t i = 0; i != remoteCount; ++i)
+    {
+        remotes[i] = udcCreateServer(sig, buffers[i].data(), buffers[i].size(), nullptr);
+
+        if (remotes[i] == nullptr || !udcTryBindIPv4(remotes[i], static_cast<uint16_t>(firstPort + i)))
+        {
+            std::cout << "failed to create remote node " << i << "\n";
+            deleteNodes();
+            return -1;
+        }
+    }
+
+    if (udcSetMaintenanceThreads(nodeA, 65) || !udcSetMaintenanceThreads(nodeA, 4))
+    {
+        std::cout << "unexpected result setting maintenance threads\n";
+        deleteNodes();
+        return -1;
+    }
+
+    std::vector<UdcEndPointId> ids(remoteCount);
+
+    for (uint32_t i = 0; i != remoteCount; ++i)
+    {
+        auto port = std::to_string(firstPort + i);
+
+        if (!udcTryConnect(nodeA, "127.0.0.1", port.c_str(), 5000, ids[i]))
+        {
+            std::cout << "failed to initiate connection " << i << "\n";
+            deleteNodes();
+            return -1;
+        }
+    }
+
+    auto processRemotes = [&](std::vector<uint32_t>* expected) -> bool
+    {
+        for (uint32_t i = 0; i != remoteCount; ++i)
+        {
+            const UdcEvent* event;
+
+            while ((event = udcProcessEvents(remotes[i])) != nullptr)
+            {
+                if (expected == nullptr || udcGetEventType(event) != UDC_EVENT_RECEIVE_MESSAGE_IPV4)
+                {
+                    continue;
+                }
+
+                UdcAddressIPv4 ip;
+                uint16_t port;
+                uint32_t index;
+                uint32_t size;
+                uint32_t& next = (*expected)[i];
+
+                if (!udcGetResultMessageIPv4Event(event, ip, port, index, size) ||
+                    size != sizeof(next) ||
+                    memcmp(&next, buffers[i].data() + index, size) != 0)
+                {
+                    std::cout << "remote node " << i << " received an unexpected message\n";
+                    return false;
+                }
+
+                ++next;
+            }
+        }
+
+        return true;
+    };
+
+    // Connect to every remote node
+    uint32_t connected = 0;
+    auto t0 = std::chrono::system_clock::now();
+
+    while (connected != remoteCount)
+    {
+        if (std::chrono::system_clock::now() - t0 >= std::chrono::seconds(5))
+        {
+            std::cout << "took too long to connect\n";
+            deleteNodes();
+            return -1;
+        }
+
+        const UdcEvent* event;
+
+        while ((event = udcProcessEvents(nodeA)) != nullptr)
+        {
+            switch (udcGetEventType(event))
+            {
+                case UDC_EVENT_CONNECTION_SUCCESS:
+                    ++connected;
+                    break;
+                case UDC_EVENT_CONNECTION_TIMEOUT:
+                    std::cout << "connection timed out\n";
+                    deleteNodes();
+                    return -1;
+                default:
+                    break;
+            }
+        }
+
+        processRemotes(nullptr);
+    }
+
+    // Every remote receives every reliable message in order
+    // the messages are resent from the maintenance threads until they're acknowledged
+    for (uint32_t m = 0; m != totalMessages; ++m)
+    {
+        for (uint32_t i = 0; i != remoteCount; ++i)
+        {
+            if (!udcSendMessage(nodeA, ids[i], reinterpret_cast<uint8_t*>(&m), sizeof(m), UDC_RELIABLE_MESSAGE))
+            {
+                std::cout << "failed to send message\n";
+                deleteNodes();
+                return -1;
+            }
+        }
+    }
+
+    std::vector<uint32_t> expected(remoteCount, 0);
+    uint32_t finished = 0;
+    t0 = std::chrono::system_clock::now();
+
+    while (finished != remoteCount)
+    {
+        if (std::chrono::system_clock::now() - t0 >= std::chrono::seconds(10))
+        {
+            std::cout << "took too long to receive messages\n";
+            deleteNodes();
+            return -1;
+        }
+
+        const UdcEvent* event;
+
+        while ((event = udcProcessEvents(nodeA)) != nullptr)
+        {
+            if (udcGetEventType(event) == UDC_EVENT_CONNECTION_LOST)
+            {
+                std::cout << "connection lost\n";
+                deleteNodes();
+                return -1;
+            }
+        }
+
+        if (!processRemotes(&expected))
+        {
+            deleteNodes();
+            return -1;
+        }
+
+        finished = 0;
+
+        for (uint32_t next : expected)
+        {
+            finished += (next == totalMessages) ? 1 : 0;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // Back to handling timers on the processing thread
+    if (!udcSetMaintenanceThreads(nodeA, 0))
+    {
+        std::cout << "failed to stop maintenance threads\n";
+        deleteNodes();
+        return -1;
+    }
+
+    for (uint32_t i = 0; i != remoteCount; ++i)
+    {
+        uint32_t ping;
+
+        if (!udcGetStatus(nodeA, ids[i], ping))
+        {
+            std::cout << "not connected to remote node " << i << "\n";
+            deleteNodes();
+            return -1;
+        }
+    }
+
+    deleteNodes();
+    return 0;
+}
@@ -0,0 +1,206 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "udp_connect.h"
+
+#include <cstring>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include <chrono>
+#include <iostream>
+
+// Counts every heap allocation made by the process
+static uint64_t allocationCount = 0;
+
+void* operator new(size_t size)
+{
+    ++allocationCount;
+
+    void* ptr = malloc(size == 0 ? 1 : size);
+
+    if (ptr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    return ptr;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+int main()
+{
+    constexpr uint32_t warmUpMessages = 2000;
+    constexpr uint32_t totalMessages = 12000;
+    constexpr uint32_t maxInFlight = 64;
+
+    UdcSignature sig = {{0x01, 0x02, 0x03, 0x04}};
+
+    uint32_t sentMessage = 0;
+    uint32_t expectedMessage = 0;
+    uint64_t allocationsAfterWarmUp = 0;
+    std::vector<uint8_t> buffer(2048);
+
+    // Create nodeA
+    UdcServer* nodeA = udcCreateServer(sig, buffer.data(), buffer.size(), nullptr);
+
+    if (nodeA == nullptr)
+    {
+        std::cout << "failed to create Node A\n";
+        return -1;
+    }
+
+    if (!udcTryBindIPv4(nodeA, 2345))
+    {
+        std::cout << "failed to bind Node A\n";
+        return -1;
+    }
+
+    // Create nodeB
+    UdcServer* nodeB = udcCreateServer(sig, buffer.data(), buffer.size(), nullptr);
+
+    if (nodeB == nullptr)
+    {
+        std::cout << "failed to create Node B\n";
+        udcDeleteServer(nodeA);
+        return -1;
+    }
+
+    if (!udcTryBindIPv4(nodeB, 2346))
+    {
+        std::cout << "failed to bind Node B\n";
+        return -1;
+    }
+
+    // Connect nodeA to nodeB
+    UdcEndPointId id;
+    if (!udcTryConnect(nodeA, "127.0.0.1", "2346", 1000, id))
+    {
+        std::cout << "failed to initiate connection from A to B\n";
+        udcDeleteServer(nodeA);
+        udcDeleteServer(nodeB);
+        return -1;
+    }
+
+    bool connected = false;
+    const UdcEvent* event;
+
+    auto t0 = std::chrono::system_clock::now();
+
+    while (true)
+    {
+        auto t1 = std::chrono::system_clock::now();
+        auto dt = t1 - t0;
+
+        if (dt >= std::chrono::seconds(10))
+        {
+            udcDeleteServer(nodeA);
+            udcDeleteServer(nodeB);
+            std::cout << "took too long.\n";
+            return -1;
+        }
+
+        // Send from A to B once connected
+        // keep the number of queued messages bounded so that the
+        // queue depth is the same during warm-up and measurement
+        if (connected && sentMessage < totalMessages && sentMessage - expectedMessage < maxInFlight)
+        {
+            udcSendMessage(nodeA, id, reinterpret_cast<uint8_t*>(&sentMessage), sizeof(sentMessage), UDC_RELIABLE_MESSAGE);
+            ++sentMessage;
+        }
+
+        // Receive from nodeA
+        while ((event = udcProcessEvents(nodeA)) != nullptr)
+        {
+            switch(udcGetEventType(event))
+            {
+                case UDC_EVENT_CONNECTION_SUCCESS:
+                    connected = true;
+                    break;
+                case UDC_EVENT_CONNECTION_TIMEOUT:
+                    std::cout << "connection timed out\n";
+                    udcDeleteServer(nodeA);
+                    udcDeleteServer(nodeB);
+                    return -1;
+                default:
+                    break;
+            }
+        }
+
+        // Receive from nodeB
+        while ((event = udcProcessEvents(nodeB)) != nullptr)
+        {
+            if (udcGetEventType(event) != UDC_EVENT_RECEIVE_MESSAGE_IPV4)
+            {
+                continue;
+            }
+
+            UdcAddressIPv4 ip;
+            uint16_t port;
+            uint32_t index;
+            uint32_t size;
+
+            if (!udcGetResultMessageIPv4Event(event, ip, port, index, size))
+            {
+                std::cout << "couldn't read external ipv4 event\n";
+                udcDeleteServer(nodeA);
+                udcDeleteServer(nodeB);
+                return -1;
+            }
+
+            if (memcmp(&expectedMessage, buffer.data() + index, size) != 0)
+            {
+                std::cout << "message wasn't the same\n";
+                udcDeleteServer(nodeA);
+                udcDeleteServer(nodeB);
+                return -1;
+            }
+            ++expectedMessage;
+
+            if (expectedMessage == warmUpMessages)
+            {
+                allocationsAfterWarmUp = allocationCount;
+            }
+
+            if (expectedMessage >= totalMessages)
+            {
+                uint64_t allocations = allocationCount - allocationsAfterWarmUp;
+
+                udcDeleteServer(nodeA);
+                udcDeleteServer(nodeB);
+
+                if (allocations != 0)
+                {
+                    std::cout << allocations << " heap allocations on the reliable path after warm-up\n";
+                    return -1;
+                }
+
+                return 0;
+            }
+        }
+    }
+}
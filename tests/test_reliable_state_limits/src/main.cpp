@@ -0,0 +1,178 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcSocketMux.h"
+
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+// Connect a node to the node bound on port, processing both until connected
+bool connect(UdcServer* from, UdcServer* to, const char* port, UdcEndPointId& id)
+{
+    if (!udcTryConnect(from, "127.0.0.1", port, 1000, id))
+    {
+        return false;
+    }
+
+    auto t0 = std::chrono::system_clock::now();
+
+    while (std::chrono::system_clock::now() - t0 < std::chrono::seconds(5))
+    {
+        while (udcProcessEvents(to) != nullptr);
+
+        const UdcEvent* event;
+
+        while ((event = udcProcessEvents(from)) != nullptr)
+        {
+            switch (udcGetEventType(event))
+            {
+                case UDC_EVENT_CONNECTION_SUCCESS:
+                    return true;
+                case UDC_EVENT_CONNECTION_TIMEOUT:
+                    return false;
+                default:
+                    break;
+            }
+        }
+    }
+
+    return false;
+}
+
+int main()
+{
+    constexpr uint32_t totalMessages = 100;
+
+    UdcSignature sig = {{0x01, 0x02, 0x03, 0x04}};
+
+    std::vector<uint8_t> buffer(2048);
+
+    // nodeA and nodeC both send reliable messages to nodeB
+    UdcServer* nodeA = udcCreateServer(sig, buffer.data(), buffer.size(), "test_reliable_state_limits_logA.txt");
+    UdcServer* nodeB = udcCreateServer(sig, buffer.data(), buffer.size(), "test_reliable_state_limits_logB.txt");
+    UdcServer* nodeC = udcCreateServer(sig, buffer.data(), buffer.size(), "test_reliable_state_limits_logC.txt");
+
+    auto deleteNodes = [&]()
+    {
+        udcDeleteServer(nodeA);
+        udcDeleteServer(nodeB);
+        udcDeleteServer(nodeC);
+    };
+
+    if (nodeA == nullptr || nodeB == nullptr || nodeC == nullptr)
+    {
+        std::cout << "failed to create nodes\n";
+        deleteNodes();
+        return -1;
+    }
+
+    if (!udcTryBindIPv4(nodeA, 2345) || !udcTryBindIPv4(nodeB, 2346) || !udcTryBindIPv4(nodeC, 2347))
+    {
+        std::cout << "failed to bind nodes\n";
+        deleteNodes();
+        return -1;
+    }
+
+    if (udcSetReliableStateLimits(nodeB, 0, 100) || udcSetReliableStateLimits(nodeB, 1, 0))
+    {
+        std::cout << "accepted invalid reliable state limits\n";
+        deleteNodes();
+        return -1;
+    }
+
+    // Only one address has state at a time, and idle addresses are forgotten after 200 ms
+    if (!udcSetReliableStateLimits(nodeB, 1, 200))
+    {
+        std::cout << "failed to set reliable state limits\n";
+        deleteNodes();
+        return -1;
+    }
+
+    UdcEndPointId idA;
+    UdcEndPointId idC;
+
+    if (!connect(nodeA, nodeB, "2346", idA) || !connect(nodeC, nodeB, "2346", idC))
+    {
+        std::cout << "failed to connect to B\n";
+        deleteNodes();
+        return -1;
+    }
+
+    for (uint32_t i = 0; i != totalMessages; ++i)
+    {
+        udcSendMessage(nodeA, idA, reinterpret_cast<uint8_t*>(&i), sizeof(i), UDC_RELIABLE_MESSAGE);
+        udcSendMessage(nodeC, idC, reinterpret_cast<uint8_t*>(&i), sizeof(i), UDC_RELIABLE_MESSAGE);
+    }
+
+    // Both senders are interleaved, so state is evicted
+    uint32_t received = 0;
+    uint32_t size;
+    uint64_t evictions;
+    uint64_t expirations;
+
+    auto t0 = std::chrono::system_clock::now();
+
+    while (received < 2 * totalMessages)
+    {
+        if (std::chrono::system_clock::now() - t0 >= std::chrono::seconds(5))
+        {
+            std::cout << "took too long, received " << received << " messages\n";
+            deleteNodes();
+            return -1;
+        }
+
+        while (udcProcessEvents(nodeA) != nullptr);
+        while (udcProcessEvents(nodeC) != nullptr);
+
+        const UdcEvent* event;
+
+        while ((event = udcProcessEvents(nodeB)) != nullptr)
+        {
+            if (udcGetEventType(event) == UDC_EVENT_RECEIVE_MESSAGE_IPV4)
+            {
+                ++received;
+            }
+        }
+
+        udcGetReliableStateMetrics(nodeB, size, evictions, expirations);
+
+        if (size > 1)
+        {
+            std::cout << "reliable state exceeded capacity\n";
+            deleteNodes();
+            return -1;
+        }
+    }
+
+    if (evictions == 0)
+    {
+        std::cout << "expected reliable state to be evicted\n";
+        deleteNodes();
+        return -1;
+    }
+
+    // Stop sending, the remaining state expires
+    t0 = std::chrono::system_clock::now();
+
+    while (std::chrono::system_clock::now() - t0 < std::chrono::milliseconds(500))
+    {
+        while (udcProcessEvents(nodeA) != nullptr);
+        while (udcProcessEvents(nodeB) != nullptr);
+        while (udcProcessEvents(nodeC) != nullptr);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    udcGetReliableStateMetrics(nodeB, size, evictions, expirations);
+
+    if (size != 0 || expirations == 0)
+    {
+        std::cout << "expected reliable state to expire\n";
+        deleteNodes();
+        return -1;
+    }
+
+    deleteNodes();
+    return 0;
+}
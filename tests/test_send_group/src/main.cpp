@@ -0,0 +1,218 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcSocketMux.h"
+
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+// Connect a node to the node bound on port, processing both until connected
+bool connect(UdcServer* from, UdcServer* to, const char* port, UdcEndPointId& id)
+{
+    if (!udcTryConnect(from, "127.0.0.1", port, 1000, id))
+    {
+        return false;
+    }
+
+    auto t0 = std::chrono::system_clock::now();
+
+    while (std::chrono::system_clock::now() - t0 < std::chrono::seconds(5))
+    {
+        while (udcProcessEvents(to) != nullptr);
+
+        const UdcEvent* event;
+
+        while ((event = udcProcessEvents(from)) != nullptr)
+        {
+            switch (udcGetEventType(event))
+            {
+                case UDC_EVENT_CONNECTION_SUCCESS:
+                    return true;
+                case UDC_EVENT_CONNECTION_TIMEOUT:
+                    return false;
+                default:
+                    break;
+            }
+        }
+    }
+
+    return false;
+}
+
+// Receive messages on a node, checking that they are the next expected messages
+bool receive(UdcServer* node, const std::vector<uint8_t>& buffer, uint32_t& expectedMessage)
+{
+    const UdcEvent* event;
+
+    while ((event = udcProcessEvents(node)) != nullptr)
+    {
+        if (udcGetEventType(event) != UDC_EVENT_RECEIVE_MESSAGE_IPV4)
+        {
+            continue;
+        }
+
+        UdcAddressIPv4 ip;
+        uint16_t port;
+        uint32_t index;
+        uint32_t size;
+
+        if (!udcGetResultMessageIPv4Event(event, ip, port, index, size) ||
+            size != sizeof(expectedMessage) ||
+            memcmp(&expectedMessage, buffer.data() + index, size) != 0)
+        {
+            return false;
+        }
+
+        ++expectedMessage;
+    }
+
+    return true;
+}
+
+int main()
+{
+    constexpr uint32_t totalMessages = 100;
+
+    UdcSignature sig = {{0x01, 0x02, 0x03, 0x04}};
+
+    std::vector<uint8_t> bufferA(2048);
+    std::vector<uint8_t> bufferB(2048);
+    std::vector<uint8_t> bufferC(2048);
+
+    // nodeA sends to a group of nodeB and nodeC
+    UdcServer* nodeA = udcCreateServer(sig, bufferA.data(), bufferA.size(), "test_send_group_logA.txt");
+    UdcServer* nodeB = udcCreateServer(sig, bufferB.data(), bufferB.size(), "test_send_group_logB.txt");
+    UdcServer* nodeC = udcCreateServer(sig, bufferC.data(), bufferC.size(), "test_send_group_logC.txt");
+
+    auto deleteNodes = [&]()
+    {
+        udcDeleteServer(nodeA);
+        udcDeleteServer(nodeB);
+        udcDeleteServer(nodeC);
+    };
+
+    if (nodeA == nullptr || nodeB == nullptr || nodeC == nullptr)
+    {
+        std::cout << "failed to create nodes\n";
+        deleteNodes();
+        return -1;
+    }
+
+    if (!udcTryBindIPv4(nodeA, 2345) || !udcTryBindIPv4(nodeB, 2346) || !udcTryBindIPv4(nodeC, 2347))
+    {
+        std::cout << "failed to bind nodes\n";
+        deleteNodes();
+        return -1;
+    }
+
+    UdcEndPointId idB;
+    UdcEndPointId idC;
+
+    if (!connect(nodeA, nodeB, "2346", idB) || !connect(nodeA, nodeC, "2347", idC))
+    {
+        std::cout << "failed to connect\n";
+        deleteNodes();
+        return -1;
+    }
+
+    UdcGroupId group;
+
+    if (!udcCreateGroup(nodeA, group) || !udcAddToGroup(nodeA, group, idB) || !udcAddToGroup(nodeA, group, idC))
+    {
+        std::cout << "failed to create group\n";
+        deleteNodes();
+        return -1;
+    }
+
+    if (udcAddToGroup(nodeA, group, idB) || udcAddToGroup(nodeA, group, 0))
+    {
+        std::cout << "added an invalid member\n";
+        deleteNodes();
+        return -1;
+    }
+
+    // Every member receives every reliable message in order
+    for (uint32_t i = 0; i != totalMessages; ++i)
+    {
+        if (!udcSendMessageGroup(nodeA, group, reinterpret_cast<uint8_t*>(&i), sizeof(i), UDC_RELIABLE_MESSAGE))
+        {
+            std::cout << "failed to send to group\n";
+            deleteNodes();
+            return -1;
+        }
+    }
+
+    uint32_t expectedB = 0;
+    uint32_t expectedC = 0;
+
+    auto t0 = std::chrono::system_clock::now();
+
+    while (expectedB < totalMessages || expectedC < totalMessages)
+    {
+        if (std::chrono::system_clock::now() - t0 >= std::chrono::seconds(5))
+        {
+            std::cout << "took too long, received " << expectedB << " and " << expectedC << " messages\n";
+            deleteNodes();
+            return -1;
+        }
+
+        while (udcProcessEvents(nodeA) != nullptr);
+
+        if (!receive(nodeB, bufferB, expectedB) || !receive(nodeC, bufferC, expectedC))
+        {
+            std::cout << "message wasn't the same\n";
+            deleteNodes();
+            return -1;
+        }
+    }
+
+    // Unreliable messages are sent to every member as well
+    uint32_t message = totalMessages;
+
+    if (!udcSendMessageGroup(nodeA, group, reinterpret_cast<uint8_t*>(&message), sizeof(message), UDC_UNRELIABLE_MESSAGE))
+    {
+        std::cout << "failed to send to group\n";
+        deleteNodes();
+        return -1;
+    }
+
+    t0 = std::chrono::system_clock::now();
+
+    while (expectedB == totalMessages || expectedC == totalMessages)
+    {
+        if (std::chrono::system_clock::now() - t0 >= std::chrono::seconds(1))
+        {
+            std::cout << "unreliable message didn't arrive\n";
+            deleteNodes();
+            return -1;
+        }
+
+        while (udcProcessEvents(nodeA) != nullptr);
+
+        if (!receive(nodeB, bufferB, expectedB) || !receive(nodeC, bufferC, expectedC))
+        {
+            std::cout << "message wasn't the same\n";
+            deleteNodes();
+            return -1;
+        }
+    }
+
+    if (!udcRemoveFromGroup(nodeA, group, idC) || udcRemoveFromGroup(nodeA, group, idC))
+    {
+        std::cout << "failed to remove member\n";
+        deleteNodes();
+        return -1;
+    }
+
+    if (!udcDeleteGroup(nodeA, group) ||
+        udcSendMessageGroup(nodeA, group, reinterpret_cast<uint8_t*>(&message), sizeof(message), UDC_RELIABLE_MESSAGE))
+    {
+        std::cout << "sent to a deleted group\n";
+        deleteNodes();
+        return -1;
+    }
+
+    deleteNodes();
+    return 0;
+}
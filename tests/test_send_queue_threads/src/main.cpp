@@ -0,0 +1,191 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcSocketMux.h"
+
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Several threads queue reliable and unreliable messages to nodeB while the main
+// thread processes events, every reliable message has to arrive once, in the order
+// its thread queued it
+constexpr uint32_t threadCount = 4;
+constexpr uint32_t messagesPerThread = 500;
+
+// A message is its thread, its sequence number, and whether it's reliable
+void writeMessage(uint8_t* msg, uint32_t thread, uint32_t sequence, bool reliable)
+{
+    msg[0] = static_cast<uint8_t>(thread);
+    msg[1] = static_cast<uint8_t>(sequence);
+    msg[2] = static_cast<uint8_t>(sequence >> 8);
+    msg[3] = reliable ? 1 : 0;
+}
+
+int main()
+{
+    UdcSignature sig = {{0x01, 0x02, 0x03, 0x04}};
+
+    std::vector<uint8_t> bufferA(2048);
+    std::vector<uint8_t> bufferB(2048);
+
+    UdcServer* nodeA = udcCreateServer(sig, bufferA.data(), bufferA.size(), nullptr);
+    UdcServer* nodeB = udcCreateServer(sig, bufferB.data(), bufferB.size(), nullptr);
+
+    auto deleteNodes = [&]()
+    {
+        udcDeleteServer(nodeA);
+        udcDeleteServer(nodeB);
+    };
+
+    if (nodeA == nullptr || nodeB == nullptr)
+    {
+        std::cout << "failed to create nodes\n";
+        deleteNodes();
+        return -1;
+    }
+
+    if (!udcTryBindIPv4(nodeA, 2345) || !udcTryBindIPv4(nodeB, 2346))
+    {
+        std::cout << "failed to bind nodes\n";
+        deleteNodes();
+        return -1;
+    }
+
+    uint8_t msg[4] = {};
+
+    if (udcQueueMessage(nodeA, 1, msg, sizeof(msg), UDC_RELIABLE_MESSAGE))
+    {
+        std::cout << "queued a message without a send queue\n";
+        deleteNodes();
+        return -1;
+    }
+
+    if (!udcCreateSendQueue(nodeA, 256) || udcCreateSendQueue(nodeA, 256))
+    {
+        std::cout << "failed to create exactly one send queue\n";
+        deleteNodes();
+        return -1;
+    }
+
+    UdcEndPointId idB;
+
+    if (!udcTryConnect(nodeA, "127.0.0.1", "2346", 10000, idB))
+    {
+        std::cout << "failed to initiate connection\n";
+        deleteNodes();
+        return -1;
+    }
+
+    std::atomic<bool> start(false);
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> threads;
+
+    for (uint32_t t = 0; t != threadCount; ++t)
+    {
+        threads.emplace_back([&, t]()
+        {
+            while (!start.load())
+            {
+                std::this_thread::yield();
+            }
+
+            uint8_t threadMsg[4];
+
+            for (uint32_t i = 0; i != messagesPerThread && !stop.load(); ++i)
+            {
+                writeMessage(threadMsg, t, i, false);
+
+                // Unreliable messages are dropped if the queue is full
+                static_cast<void>(udcQueueMessage(nodeA, idB, threadMsg, sizeof(threadMsg), UDC_UNRELIABLE_MESSAGE));
+
+                writeMessage(threadMsg, t, i, true);
+
+                while (!udcQueueMessage(nodeA, idB, threadMsg, sizeof(threadMsg), UDC_RELIABLE_MESSAGE) && !stop.load())
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    auto finish = [&](int result)
+    {
+        stop.store(true);
+        start.store(true);
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        deleteNodes();
+        return result;
+    };
+
+    std::vector<uint32_t> nextSequence(threadCount, 0);
+    uint32_t received = 0;
+
+    auto t0 = std::chrono::system_clock::now();
+
+    while (received != threadCount * messagesPerThread)
+    {
+        if (std::chrono::system_clock::now() - t0 >= std::chrono::seconds(30))
+        {
+            std::cout << "took too long to receive messages, received " << received << "\n";
+            return finish(-1);
+        }
+
+        const UdcEvent* event;
+
+        while ((event = udcProcessEvents(nodeA)) != nullptr)
+        {
+            if (udcGetEventType(event) == UDC_EVENT_CONNECTION_SUCCESS)
+            {
+                start.store(true);
+            }
+            else if (udcGetEventType(event) == UDC_EVENT_CONNECTION_TIMEOUT)
+            {
+                std::cout << "connection timed out\n";
+                return finish(-1);
+            }
+        }
+
+        while ((event = udcProcessEvents(nodeB)) != nullptr)
+        {
+            if (udcGetEventType(event) != UDC_EVENT_RECEIVE_MESSAGE_IPV4)
+            {
+                continue;
+            }
+
+            const uint8_t* data = bufferB.data() + event->msgIndex;
+            uint32_t thread = data[0];
+            uint32_t sequence = data[1] | (data[2] << 8);
+
+            if (event->msgSize != 4 || thread >= threadCount || sequence >= messagesPerThread)
+            {
+                std::cout << "message wasn't the same\n";
+                return finish(-1);
+            }
+
+            if (data[3] == 0)
+            {
+                continue;
+            }
+
+            if (sequence != nextSequence[thread])
+            {
+                std::cout << "reliable message " << sequence << " from thread " << thread
+                          << " arrived when " << nextSequence[thread] << " was expected\n";
+                return finish(-1);
+            }
+
+            ++nextSequence[thread];
+            ++received;
+        }
+    }
+
+    return finish(0);
+}
@@ -0,0 +1,175 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcSocketMux.h"
+
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <string>
+
+// Connect a node to the node bound on port, processing both until connected
+bool connect(UdcServer* from, UdcServer* to, const char* port, UdcEndPointId& id)
+{
+    if (!udcTryConnect(from, "127.0.0.1", port, 1000, id))
+    {
+        return false;
+    }
+
+    auto t0 = std::chrono::system_clock::now();
+
+    while (std::chrono::system_clock::now() - t0 < std::chrono::seconds(5))
+    {
+        while (udcProcessEvents(to) != nullptr);
+
+        const UdcEvent* event;
+
+        while ((event = udcProcessEvents(from)) != nullptr)
+        {
+            switch (udcGetEventType(event))
+            {
+                case UDC_EVENT_CONNECTION_SUCCESS:
+                    return true;
+                case UDC_EVENT_CONNECTION_TIMEOUT:
+                    return false;
+                default:
+                    break;
+            }
+        }
+    }
+
+    return false;
+}
+
+int main()
+{
+    UdcSignature sig = {{0x01, 0x02, 0x03, 0x04}};
+
+    std::vector<uint8_t> bufferA(2048);
+    std::vector<uint8_t> bufferB(2048);
+
+    UdcServer* nodeA = udcCreateServer(sig, bufferA.data(), bufferA.size(), "test_send_segments_logA.txt");
+    UdcServer* nodeB = udcCreateServer(sig, bufferB.data(), bufferB.size(), "test_send_segments_logB.txt");
+
+    auto deleteNodes = [&]()
+    {
+        udcDeleteServer(nodeA);
+        udcDeleteServer(nodeB);
+    };
+
+    if (nodeA == nullptr || nodeB == nullptr)
+    {
+        std::cout << "failed to create nodes\n";
+        deleteNodes();
+        return -1;
+    }
+
+    if (!udcTryBindIPv4(nodeA, 2345) || !udcTryBindIPv4(nodeB, 2346))
+    {
+        std::cout << "failed to bind nodes\n";
+        deleteNodes();
+        return -1;
+    }
+
+    UdcEndPointId id;
+
+    if (!connect(nodeA, nodeB, "2346", id))
+    {
+        std::cout << "failed to connect to B\n";
+        deleteNodes();
+        return -1;
+    }
+
+    // A header, an empty segment and a body, as a serializer might produce them
+    const std::string header = "header:";
+    const std::string body = "the body of the message";
+    const std::string expected = header + body;
+
+    UdcSegment segments[] = {
+        {reinterpret_cast<const uint8_t*>(header.data()), static_cast<uint32_t>(header.size())},
+        {nullptr, 0},
+        {reinterpret_cast<const uint8_t*>(body.data()), static_cast<uint32_t>(body.size())},
+    };
+
+    UdcSegment tooManySegments[UDC_MAX_MESSAGE_SEGMENTS + 1] = {};
+
+    if (udcSendMessageV(nodeA, id, tooManySegments, UDC_MAX_MESSAGE_SEGMENTS + 1, UDC_UNRELIABLE_MESSAGE) ||
+        udcSendMessageV(nodeA, id, tooManySegments, UDC_MAX_MESSAGE_SEGMENTS + 1, UDC_RELIABLE_MESSAGE))
+    {
+        std::cout << "accepted too many segments\n";
+        deleteNodes();
+        return -1;
+    }
+
+    UdcSegment tooLarge = {bufferA.data(), static_cast<uint32_t>(bufferA.size())};
+
+    if (udcSendMessageV(nodeA, id, &tooLarge, 1, UDC_RELIABLE_MESSAGE))
+    {
+        std::cout << "accepted a message larger than the buffer\n";
+        deleteNodes();
+        return -1;
+    }
+
+    // Each message type arrives whole
+    for (UdcMessageType reliability : {UDC_UNRELIABLE_MESSAGE, UDC_RELIABLE_MESSAGE})
+    {
+        if (!udcSendMessageV(nodeA, id, segments, 3, reliability))
+        {
+            std::cout << "failed to send segments\n";
+            deleteNodes();
+            return -1;
+        }
+
+        bool received = false;
+
+        auto t0 = std::chrono::system_clock::now();
+
+        while (!received)
+        {
+            if (std::chrono::system_clock::now() - t0 >= std::chrono::seconds(5))
+            {
+                std::cout << "took too long\n";
+                deleteNodes();
+                return -1;
+            }
+
+            while (udcProcessEvents(nodeA) != nullptr);
+
+            const UdcEvent* event;
+
+            while ((event = udcProcessEvents(nodeB)) != nullptr)
+            {
+                if (udcGetEventType(event) != UDC_EVENT_RECEIVE_MESSAGE_IPV4)
+                {
+                    continue;
+                }
+
+                UdcAddressIPv4 ip;
+                uint16_t port;
+                uint32_t index;
+                uint32_t size;
+
+                if (!udcGetResultMessageIPv4Event(event, ip, port, index, size))
+                {
+                    std::cout << "couldn't read external ipv4 event\n";
+                    deleteNodes();
+                    return -1;
+                }
+
+                if (size != expected.size() || memcmp(expected.data(), bufferB.data() + index, size) != 0)
+                {
+                    std::cout << "message wasn't the same\n";
+                    deleteNodes();
+                    return -1;
+                }
+
+                received = true;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    deleteNodes();
+    return 0;
+}
@@ -0,0 +1,200 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "udp_connect.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+constexpr uint32_t totalMessages = 1000;
+
+// Process events on every server until messages from A reach B and C, or something fails
+// returns 0 on success
+int exchange(UdcServer* nodeA, UdcServer* nodeB, UdcServer* nodeC, std::vector<uint8_t>& buffer)
+{
+    UdcEndPointId idB;
+    UdcEndPointId idC;
+
+    // B has shared memory, and C only has UDP
+    if (!udcTryConnect(nodeA, "127.0.0.1", "2346", 5000, idB) ||
+        !udcTryConnect(nodeA, "127.0.0.1", "2347", 5000, idC))
+    {
+        std::cout << "failed to initiate connections from A\n";
+        return -1;
+    }
+
+    uint32_t connected = 0;
+    uint32_t sentMessage = 0;
+    uint32_t expectedB = 0;
+    uint32_t expectedC = 0;
+    const UdcEvent* event;
+
+    auto t0 = std::chrono::system_clock::now();
+
+    while (expectedB != totalMessages || expectedC != totalMessages)
+    {
+        if (std::chrono::system_clock::now() - t0 >= std::chrono::seconds(10))
+        {
+            std::cout << "took too long, B received " << expectedB << " and C received " << expectedC << "\n";
+            return -1;
+        }
+
+        if (connected == 2 && sentMessage < totalMessages)
+        {
+            udcSendMessage(nodeA, idB, reinterpret_cast<uint8_t*>(&sentMessage), sizeof(sentMessage), UDC_RELIABLE_MESSAGE);
+            udcSendMessage(nodeA, idC, reinterpret_cast<uint8_t*>(&sentMessage), sizeof(sentMessage), UDC_RELIABLE_MESSAGE);
+            ++sentMessage;
+        }
+
+        while ((event = udcProcessEvents(nodeA)) != nullptr)
+        {
+            if (udcGetEventType(event) == UDC_EVENT_CONNECTION_SUCCESS)
+            {
+                ++connected;
+            }
+            else if (udcGetEventType(event) == UDC_EVENT_CONNECTION_TIMEOUT)
+            {
+                std::cout << "connection timed out\n";
+                return -1;
+            }
+        }
+
+        UdcServer* receivers[] = {nodeB, nodeC};
+        uint32_t* expected[] = {&expectedB, &expectedC};
+
+        for (uint32_t i = 0; i != 2; ++i)
+        {
+            while ((event = udcProcessEvents(receivers[i])) != nullptr)
+            {
+                if (udcGetEventType(event) != UDC_EVENT_RECEIVE_MESSAGE_IPV4)
+                {
+                    continue;
+                }
+
+                UdcAddressIPv4 ip;
+                uint16_t port;
+                uint32_t index;
+                uint32_t size;
+
+                if (!udcGetResultMessageIPv4Event(event, ip, port, index, size))
+                {
+                    std::cout << "couldn't read ipv4 event\n";
+                    return -1;
+                }
+
+                // Shared memory looks the same as the loopback interface
+                if (ip.octets[0] != 127 || ip.octets[3] != 1 || port != 2345)
+                {
+                    std::cout << "message came from the wrong address\n";
+                    return -1;
+                }
+
+                if (size != sizeof(uint32_t) || memcmp(expected[i], buffer.data() + index, size) != 0)
+                {
+                    std::cout << "message wasn't the same\n";
+                    return -1;
+                }
+
+                ++*expected[i];
+            }
+        }
+    }
+
+    return 0;
+}
+
+int main()
+{
+    UdcSignature sig = {{0x01, 0x02, 0x03, 0x04}};
+    std::vector<uint8_t> buffer(2048);
+
+    UdcServer* nodeA = udcCreateServer(sig, buffer.data(), buffer.size(), nullptr);
+    UdcServer* nodeB = udcCreateServer(sig, buffer.data(), buffer.size(), nullptr);
+    UdcServer* nodeC = udcCreateServer(sig, buffer.data(), buffer.size(), nullptr);
+
+    if (nodeA == nullptr || nodeB == nullptr || nodeC == nullptr)
+    {
+        std::cout << "failed to create nodes\n";
+        udcDeleteServer(nodeA);
+        udcDeleteServer(nodeB);
+        udcDeleteServer(nodeC);
+        return -1;
+    }
+
+    // The inbox is named after a bound port
+    if (udcEnableSharedMemory(nodeA))
+    {
+        std::cout << "shared memory was enabled before binding\n";
+        udcDeleteServer(nodeA);
+        udcDeleteServer(nodeB);
+        udcDeleteServer(nodeC);
+        return -1;
+    }
+
+    if (!udcTryBindIPv4(nodeA, 2345) || !udcTryBindIPv4(nodeB, 2346) || !udcTryBindIPv4(nodeC, 2347) ||
+        !udcEnableSharedMemory(nodeA) || !udcEnableSharedMemory(nodeB))
+    {
+        std::cout << "failed to set up nodes\n";
+        udcDeleteServer(nodeA);
+        udcDeleteServer(nodeB);
+        udcDeleteServer(nodeC);
+        return -1;
+    }
+
+    // An IPv6 socket can share A's port, and has an inbox of its own rather than reading from A's
+    UdcServer* nodeD = udcCreateServer(sig, buffer.data(), buffer.size(), nullptr);
+
+    if (nodeD == nullptr || !udcTryBindIPv6(nodeD, 2345) || !udcEnableSharedMemory(nodeD))
+    {
+        std::cout << "failed to set up IPv6 node on the same port\n";
+        udcDeleteServer(nodeA);
+        udcDeleteServer(nodeB);
+        udcDeleteServer(nodeC);
+        udcDeleteServer(nodeD);
+        return -1;
+    }
+
+    int result = exchange(nodeA, nodeB, nodeC, buffer);
+
+    uint64_t sentA, receivedA, sentB, receivedB, sentC, receivedC;
+    udcGetSharedMemoryCounters(nodeA, sentA, receivedA);
+    udcGetSharedMemoryCounters(nodeB, sentB, receivedB);
+    udcGetSharedMemoryCounters(nodeC, sentC, receivedC);
+
+    uint64_t sentD, receivedD;
+    udcGetSharedMemoryCounters(nodeD, sentD, receivedD);
+
+    udcDeleteServer(nodeA);
+    udcDeleteServer(nodeB);
+    udcDeleteServer(nodeC);
+    udcDeleteServer(nodeD);
+
+    if (result != 0)
+    {
+        return result;
+    }
+
+    // Messages between A and B went through shared memory, and the last acknowledgements may not have arrived
+    if (receivedB < totalMessages || receivedA == 0 || receivedA > sentB || receivedB > sentA)
+    {
+        std::cout << "A sent " << sentA << " and received " << receivedA
+            << ", B sent " << sentB << " and received " << receivedB << " through shared memory\n";
+        return -1;
+    }
+
+    if (sentC != 0 || receivedC != 0)
+    {
+        std::cout << "C used shared memory without enabling it\n";
+        return -1;
+    }
+
+    if (receivedD != 0)
+    {
+        std::cout << "D received from A's inbox\n";
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,236 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "udp_connect.h"
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+constexpr uint32_t totalMessages = 100;
+
+// Send reliable and unreliable messages from A to B until B has every reliable one
+// and A's queue is empty
+// returns 0 on success
+int exchange(UdcServer* nodeA, UdcServer* nodeB, UdcEndPointId& idB)
+{
+    if (!udcTryConnect(nodeA, "127.0.0.1", "2346", 5000, idB))
+    {
+        std::cout << "failed to initiate connection from A\n";
+        return -1;
+    }
+
+    bool connected = false;
+    uint32_t sentMessage = 0;
+    uint32_t receivedReliable = 0;
+    const UdcEvent* event;
+    UdcStats stats = {};
+
+    auto t0 = std::chrono::system_clock::now();
+
+    while (receivedReliable != totalMessages || stats.reliableQueued != 0)
+    {
+        if (std::chrono::system_clock::now() - t0 >= std::chrono::seconds(10))
+        {
+            std::cout << "took too long, B received " << receivedReliable << " reliable messages\n";
+            return -1;
+        }
+
+        // Reliable messages are larger, so B can tell them apart
+        if (connected && sentMessage < totalMessages)
+        {
+            uint64_t reliableMessage = sentMessage;
+            udcSendMessage(nodeA, idB, reinterpret_cast<uint8_t*>(&reliableMessage), sizeof(reliableMessage), UDC_RELIABLE_MESSAGE);
+            udcSendMessage(nodeA, idB, reinterpret_cast<uint8_t*>(&sentMessage), sizeof(sentMessage), UDC_UNRELIABLE_MESSAGE);
+            ++sentMessage;
+        }
+
+        while ((event = udcProcessEvents(nodeA)) != nullptr)
+        {
+            if (udcGetEventType(event) == UDC_EVENT_CONNECTION_SUCCESS)
+            {
+                connected = true;
+            }
+            else if (udcGetEventType(event) == UDC_EVENT_CONNECTION_TIMEOUT)
+            {
+                std::cout << "connection timed out\n";
+                return -1;
+            }
+        }
+
+        while ((event = udcProcessEvents(nodeB)) != nullptr)
+        {
+            if (udcGetEventType(event) == UDC_EVENT_RECEIVE_MESSAGE_IPV4 && event->msgSize == sizeof(uint64_t))
+            {
+                ++receivedReliable;
+            }
+        }
+
+        if (connected && !udcGetStats(nodeA, idB, stats))
+        {
+            std::cout << "couldn't get the stats of B\n";
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+// Check A's counters for B against the messages that were sent
+// returns 0 on success
+int checkSender(UdcServer* nodeA, UdcEndPointId idB)
+{
+    UdcStats endPoint;
+    UdcStats server;
+
+    if (!udcGetStats(nodeA, idB, endPoint) || !udcGetStats(nodeA, 0, server))
+    {
+        std::cout << "couldn't get the stats of A\n";
+        return -1;
+    }
+
+    if (endPoint.packetsSent[UDC_STATS_UNRELIABLE] != totalMessages ||
+        endPoint.packetsSent[UDC_STATS_RELIABLE] < totalMessages ||
+        endPoint.packetsSent[UDC_STATS_CONNECTION] == 0 ||
+        endPoint.packetsReceived[UDC_STATS_ACK] < totalMessages)
+    {
+        std::cout << "endpoint packet counts are wrong\n";
+        return -1;
+    }
+
+    // Every unreliable message is the same size, with the header included
+    uint64_t unreliableBytes = endPoint.bytesSent[UDC_STATS_UNRELIABLE];
+
+    if (unreliableBytes % totalMessages != 0 || unreliableBytes / totalMessages <= sizeof(uint32_t))
+    {
+        std::cout << "endpoint byte counts are wrong\n";
+        return -1;
+    }
+
+    // Resends are counted with the reliable packets, as are resets
+    if (endPoint.retransmissions > endPoint.packetsSent[UDC_STATS_RELIABLE] - totalMessages)
+    {
+        std::cout << "retransmissions don't match the reliable messages sent\n";
+        return -1;
+    }
+
+    // A only has the one endpoint, so the server sends the same packets
+    for (uint32_t i = 0; i != UDC_STATS_PACKET_COUNT; ++i)
+    {
+        if (server.packetsSent[i] != endPoint.packetsSent[i] || server.bytesSent[i] != endPoint.bytesSent[i])
+        {
+            std::cout << "server and endpoint sent counts differ for kind " << i << "\n";
+            return -1;
+        }
+
+        if (server.packetsReceived[i] < endPoint.packetsReceived[i])
+        {
+            std::cout << "server received less than its endpoint for kind " << i << "\n";
+            return -1;
+        }
+    }
+
+    if (server.retransmissions != endPoint.retransmissions || server.reliableQueued != 0)
+    {
+        std::cout << "server totals are wrong\n";
+        return -1;
+    }
+
+    return 0;
+}
+
+// Send B a packet with another signature, which it must count and drop
+// returns 0 on success
+int checkSignature(UdcServer* nodeB, UdcServer* nodeD)
+{
+    UdcEndPointId idB;
+
+    if (!udcTryConnect(nodeD, "127.0.0.1", "2346", 5000, idB))
+    {
+        std::cout << "failed to initiate connection from D\n";
+        return -1;
+    }
+
+    UdcStats stats = {};
+    auto t0 = std::chrono::system_clock::now();
+
+    while (stats.signatureMismatches == 0)
+    {
+        if (std::chrono::system_clock::now() - t0 >= std::chrono::seconds(5))
+        {
+            std::cout << "signature mismatch wasn't counted\n";
+            return -1;
+        }
+
+        while (udcProcessEvents(nodeD) != nullptr);
+        while (udcProcessEvents(nodeB) != nullptr);
+
+        if (!udcGetStats(nodeB, 0, stats))
+        {
+            std::cout << "couldn't get the stats of B\n";
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int main()
+{
+    UdcSignature sig = {{0x01, 0x02, 0x03, 0x04}};
+    UdcSignature otherSig = {{0x05, 0x06, 0x07, 0x08}};
+    std::vector<uint8_t> buffer(2048);
+
+    UdcServer* nodeA = udcCreateServer(sig, buffer.data(), buffer.size(), nullptr);
+    UdcServer* nodeB = udcCreateServer(sig, buffer.data(), buffer.size(), nullptr);
+    UdcServer* nodeD = udcCreateServer(otherSig, buffer.data(), buffer.size(), nullptr);
+
+    if (nodeA == nullptr || nodeB == nullptr || nodeD == nullptr)
+    {
+        std::cout << "failed to create nodes\n";
+        udcDeleteServer(nodeA);
+        udcDeleteServer(nodeB);
+        udcDeleteServer(nodeD);
+        return -1;
+    }
+
+    if (!udcTryBindIPv4(nodeA, 2345) || !udcTryBindIPv4(nodeB, 2346) || !udcTryBindIPv4(nodeD, 2347))
+    {
+        std::cout << "failed to bind nodes\n";
+        udcDeleteServer(nodeA);
+        udcDeleteServer(nodeB);
+        udcDeleteServer(nodeD);
+        return -1;
+    }
+
+    UdcEndPointId idB = 0;
+    UdcStats stats;
+    int result = 0;
+
+    if (udcGetStats(nodeA, 1000, stats))
+    {
+        std::cout << "got the stats of an endpoint that doesn't exist\n";
+        result = -1;
+    }
+
+    if (result == 0)
+    {
+        result = exchange(nodeA, nodeB, idB);
+    }
+
+    if (result == 0)
+    {
+        result = checkSender(nodeA, idB);
+    }
+
+    if (result == 0)
+    {
+        result = checkSignature(nodeB, nodeD);
+    }
+
+    udcDeleteServer(nodeA);
+    udcDeleteServer(nodeB);
+    udcDeleteServer(nodeD);
+
+    return result;
+}
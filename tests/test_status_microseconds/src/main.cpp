@@ -0,0 +1,111 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcSocketMux.h"
+
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+int main()
+{
+    UdcSignature sig = {{0x01, 0x02, 0x03, 0x04}};
+
+    std::vector<uint8_t> buffer(2048);
+
+    // Create nodeA
+    UdcServer* nodeA = udcCreateServer(sig, buffer.data(), buffer.size(), "test_status_microseconds_logA.txt");
+
+    if (nodeA == nullptr)
+    {
+        std::cout << "failed to create Node A\n";
+        return -1;
+    }
+
+    if (!udcTryBindIPv4(nodeA, 2345))
+    {
+        std::cout << "failed to bind Node A\n";
+        return -1;
+    }
+
+    // Create nodeB
+    UdcServer* nodeB = udcCreateServer(sig, buffer.data(), buffer.size(), "test_status_microseconds_logB.txt");
+
+    if (nodeB == nullptr)
+    {
+        std::cout << "failed to create Node B\n";
+        udcDeleteServer(nodeA);
+        return -1;
+    }
+
+    if (!udcTryBindIPv4(nodeB, 2346))
+    {
+        std::cout << "failed to bind Node B\n";
+        return -1;
+    }
+
+    // Connect nodeA to nodeB
+    UdcEndPointId id;
+    if (!udcTryConnect(nodeA, "127.0.0.1", "2346", 1000, id))
+    {
+        std::cout << "failed to initiate connection from A to B\n";
+        udcDeleteServer(nodeA);
+        udcDeleteServer(nodeB);
+        return -1;
+    }
+
+    uint32_t ping = 0;
+    uint32_t pingUs = 0;
+
+    // Process both nodes until a ping has been measured
+    // the loopback round trip is well under a millisecond
+    auto t0 = std::chrono::system_clock::now();
+
+    while (pingUs == 0)
+    {
+        auto t1 = std::chrono::system_clock::now();
+        auto dt = t1 - t0;
+
+        if (dt >= std::chrono::seconds(5))
+        {
+            udcDeleteServer(nodeA);
+            udcDeleteServer(nodeB);
+            std::cout << "failed to measure ping\n";
+            return -1;
+        }
+
+        const UdcEvent* event;
+
+        while ((event = udcProcessEvents(nodeA)) != nullptr)
+        {
+            if (udcGetEventType(event) == UDC_EVENT_CONNECTION_TIMEOUT)
+            {
+                udcDeleteServer(nodeA);
+                udcDeleteServer(nodeB);
+                std::cout << "connection timed out\n";
+                return -1;
+            }
+        }
+
+        while (udcProcessEvents(nodeB) != nullptr);
+
+        if (udcGetStatusMicroseconds(nodeA, id, pingUs) != udcGetStatus(nodeA, id, ping))
+        {
+            udcDeleteServer(nodeA);
+            udcDeleteServer(nodeB);
+            std::cout << "status functions disagree\n";
+            return -1;
+        }
+    }
+
+    udcDeleteServer(nodeA);
+    udcDeleteServer(nodeB);
+
+    if (ping != pingUs / 1000)
+    {
+        std::cout << "ping " << ping << " ms doesn't match " << pingUs << " us\n";
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,157 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcSocketMux.h"
+
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// nodeA's threads are pinned to the first processor, which every host has,
+// and it receives into a buffer allocated on that processor's node
+// its reserved endpoint table is moved to the I/O thread when the thread starts
+
+int main()
+{
+    constexpr uint32_t bufferSize = 2048;
+    constexpr uint64_t firstProcessor = 1;
+
+    UdcSignature sig = {{0x01, 0x02, 0x03, 0x04}};
+
+    uint8_t* bufferA = udcAllocateBuffer(bufferSize, 0, firstProcessor);
+    std::vector<uint8_t> bufferB(bufferSize);
+
+    if (bufferA == nullptr)
+    {
+        std::cout << "failed to allocate buffer\n";
+        return -1;
+    }
+
+    UdcServer* nodeA = udcCreateServer(sig, bufferA, bufferSize, "test_thread_affinity_logA.txt");
+    UdcServer* nodeB = udcCreateServer(sig, bufferB.data(), bufferB.size(), "test_thread_affinity_logB.txt");
+
+    auto deleteNodes = [&]()
+    {
+        udcDeleteServer(nodeA);
+        udcDeleteServer(nodeB);
+        udcFreeBuffer(bufferA);
+    };
+
+    if (nodeA == nullptr || nodeB == nullptr)
+    {
+        std::cout << "failed to create nodes\n";
+        deleteNodes();
+        return -1;
+    }
+
+    if (!udcTryBindIPv4(nodeA, 2345) || !udcTryBindIPv4(nodeB, 2346))
+    {
+        std::cout << "failed to bind nodes\n";
+        deleteNodes();
+        return -1;
+    }
+
+    if (udcReserveEndPoints(nodeA, (1u << 20) + 1) || !udcReserveEndPoints(nodeA, 64))
+    {
+        std::cout << "unexpected result reserving endpoints\n";
+        deleteNodes();
+        return -1;
+    }
+
+    if (udcSetThreadAffinity(nodeA, static_cast<UdcThreadRole>(2), 0, firstProcessor) ||
+        !udcSetThreadAffinity(nodeA, UDC_THREAD_MAINTENANCE, 0, firstProcessor) ||
+        !udcSetMaintenanceThreads(nodeA, 2) ||
+        !udcSetThreadAffinity(nodeA, UDC_THREAD_IO, 0, firstProcessor))
+    {
+        std::cout << "unexpected result setting affinity\n";
+        deleteNodes();
+        return -1;
+    }
+
+    if (!udcStartIoThread(nodeA, 128, 200))
+    {
+        std::cout << "failed to start I/O thread\n";
+        deleteNodes();
+        return -1;
+    }
+
+    if (udcSetThreadAffinity(nodeA, UDC_THREAD_IO, 0, 0))
+    {
+        std::cout << "changed the affinity of a running I/O thread\n";
+        deleteNodes();
+        return -1;
+    }
+
+    UdcEndPointId idB;
+
+    if (!udcTryConnect(nodeA, "127.0.0.1", "2346", 1000, idB))
+    {
+        std::cout << "failed to initiate connection\n";
+        deleteNodes();
+        return -1;
+    }
+
+    bool connected = false;
+    bool received = false;
+    bool sent = false;
+
+    auto t0 = std::chrono::system_clock::now();
+
+    while (!received)
+    {
+        if (std::chrono::system_clock::now() - t0 >= std::chrono::seconds(5))
+        {
+            std::cout << "took too long to receive the message\n";
+            deleteNodes();
+            return -1;
+        }
+
+        const UdcEvent* event;
+
+        while ((event = udcProcessEvents(nodeA)) != nullptr)
+        {
+            switch (udcGetEventType(event))
+            {
+                case UDC_EVENT_CONNECTION_SUCCESS:
+                    connected = true;
+                    break;
+                case UDC_EVENT_CONNECTION_TIMEOUT:
+                    std::cout << "connection timed out\n";
+                    deleteNodes();
+                    return -1;
+                default:
+                    break;
+            }
+        }
+
+        if (connected && !sent)
+        {
+            uint8_t msg = 'A';
+            sent = udcSendMessage(nodeA, idB, &msg, 1, UDC_RELIABLE_MESSAGE);
+        }
+
+        while ((event = udcProcessEvents(nodeB)) != nullptr)
+        {
+            if (udcGetEventType(event) == UDC_EVENT_RECEIVE_MESSAGE_IPV4)
+            {
+                received |= (event->msgSize == 1 && bufferB[event->msgIndex] == 'A');
+            }
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    udcStopIoThread(nodeA);
+
+    // The affinity can be changed again once the thread has stopped
+    if (!udcSetThreadAffinity(nodeA, UDC_THREAD_IO, 0, 0))
+    {
+        std::cout << "failed to clear affinity\n";
+        deleteNodes();
+        return -1;
+    }
+
+    deleteNodes();
+    return 0;
+}
@@ -0,0 +1,141 @@
+// udp-connect
+// Kyle J Burgess
+
+#include "UdcSocketMux.h"
+
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+// Both nodes only run when udcWaitEvents() says there's work, so every step of the
+// connection has to wake the node that it's sent to
+
+int main()
+{
+    UdcSignature sig = {{0x01, 0x02, 0x03, 0x04}};
+
+    std::vector<uint8_t> bufferA(2048);
+    std::vector<uint8_t> bufferB(2048);
+
+    UdcServer* nodeA = udcCreateServer(sig, bufferA.data(), bufferA.size(), "test_wait_events_logA.txt");
+    UdcServer* nodeB = udcCreateServer(sig, bufferB.data(), bufferB.size(), "test_wait_events_logB.txt");
+
+    auto deleteNodes = [&]()
+    {
+        udcDeleteServer(nodeA);
+        udcDeleteServer(nodeB);
+    };
+
+    if (nodeA == nullptr || nodeB == nullptr)
+    {
+        std::cout << "failed to create nodes\n";
+        deleteNodes();
+        return -1;
+    }
+
+    if (!udcTryBindIPv4(nodeA, 2345) || !udcTryBindIPv4(nodeB, 2346))
+    {
+        std::cout << "failed to bind nodes\n";
+        deleteNodes();
+        return -1;
+    }
+
+    if (udcGetEventHandle(nodeA) == nullptr || udcGetEventHandle(nodeB) == nullptr)
+    {
+        std::cout << "failed to get event handles\n";
+        deleteNodes();
+        return -1;
+    }
+
+    // Returns true if a node has a connection event
+    auto process = [](UdcServer* node, UdcEventType type)
+    {
+        bool found = false;
+        const UdcEvent* event;
+
+        while ((event = udcProcessEvents(node)) != nullptr)
+        {
+            found |= udcGetEventType(event) == type;
+        }
+
+        return found;
+    };
+
+    process(nodeA, UDC_EVENT_CONNECTION_SUCCESS);
+
+    // An idle node has nothing scheduled, and waits out the whole timeout
+    if (udcGetNextTimeout(nodeA) != UDC_NO_TIMEOUT || udcWaitEvents(nodeA, 20000))
+    {
+        std::cout << "idle node had work to do\n";
+        deleteNodes();
+        return -1;
+    }
+
+    UdcEndPointId idA;
+
+    if (!udcTryConnect(nodeB, "127.0.0.1", "2345", 5000, idA))
+    {
+        std::cout << "failed to initiate connection\n";
+        deleteNodes();
+        return -1;
+    }
+
+    // nodeB's connection request is due now
+    if (udcGetNextTimeout(nodeB) != 0)
+    {
+        std::cout << "connection request wasn't due\n";
+        deleteNodes();
+        return -1;
+    }
+
+    process(nodeB, UDC_EVENT_CONNECTION_SUCCESS);
+
+    // The next request or the timeout is scheduled
+    if (udcGetNextTimeout(nodeB) > 5000000)
+    {
+        std::cout << "connection timeout wasn't scheduled\n";
+        deleteNodes();
+        return -1;
+    }
+
+    // nodeA is woken by the request, and answers it
+    auto t0 = std::chrono::steady_clock::now();
+
+    if (!udcWaitEvents(nodeA, 1000000) || std::chrono::steady_clock::now() - t0 >= std::chrono::milliseconds(500))
+    {
+        std::cout << "nodeA wasn't woken by the connection request\n";
+        deleteNodes();
+        return -1;
+    }
+
+    process(nodeA, UDC_EVENT_CONNECTION_SUCCESS);
+
+    // nodeB is woken by the handshake
+    t0 = std::chrono::steady_clock::now();
+
+    while (true)
+    {
+        if (std::chrono::steady_clock::now() - t0 >= std::chrono::milliseconds(500))
+        {
+            std::cout << "nodeB wasn't woken by the handshake\n";
+            deleteNodes();
+            return -1;
+        }
+
+        if (udcWaitEvents(nodeB, 1000000) && process(nodeB, UDC_EVENT_CONNECTION_SUCCESS))
+        {
+            break;
+        }
+    }
+
+    // Pings are scheduled once connected
+    if (udcGetNextTimeout(nodeB) == UDC_NO_TIMEOUT)
+    {
+        std::cout << "pings weren't scheduled\n";
+        deleteNodes();
+        return -1;
+    }
+
+    deleteNodes();
+    return 0;
+}
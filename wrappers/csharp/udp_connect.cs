@@ -18,6 +18,9 @@ public class UdcServer : IDisposable
 
     public event Action<AddressIPv6, UInt16, ArraySegment<byte>> onReceivedMessageIPv6;
 
+    // A message from a connected endpoint, with the endpoint's context (see SetEndPointContext)
+    public event Action<UInt32, IntPtr, ArraySegment<byte>> onReceivedEndPointMessage;
+
     // Types of messages
     public enum MessageType : UInt32
     {
@@ -33,6 +36,25 @@ public class UdcServer : IDisposable
         UDC_RELIABLE_MESSAGE = 1u,
     };
 
+    // How the slots of a receive ring are reused
+    public enum RingMode : UInt32
+    {
+        // A message keeps its slot until the ring comes back around to it,
+        // so its payload stays valid for the next (slotCount - 1) received messages
+        UDC_RING_RECYCLE = 0u,
+
+        // A message keeps its slot until ReleaseMessage() is called
+        // while every slot is held, no messages are received
+        UDC_RING_MANUAL_RELEASE = 1u,
+    };
+
+    // Threads run by the server
+    public enum ThreadRole : UInt32
+    {
+        UDC_THREAD_IO = 0u,
+        UDC_THREAD_MAINTENANCE = 1u,
+    };
+
     // Message signature
     [StructLayout(LayoutKind.Sequential, Size = 4), Serializable]
     public struct Signature
@@ -60,6 +82,52 @@ public class UdcServer : IDisposable
         public UInt16[] segments;
     };
 
+    // Kinds of packet counted separately by GetStats()
+    public enum StatsPacket : UInt32
+    {
+        UDC_STATS_CONNECTION = 0u,
+        UDC_STATS_PING = 1u,
+        UDC_STATS_UNRELIABLE = 2u,
+        UDC_STATS_RELIABLE = 3u,
+        UDC_STATS_ACK = 4u,
+    };
+
+    public const int StatsPacketCount = 5;
+
+    // Counters of a server or one of its endpoints
+    // packets and bytes are indexed by StatsPacket
+    [StructLayout(LayoutKind.Sequential)]
+    public struct Stats
+    {
+        [MarshalAsAttribute(UnmanagedType.ByValArray, SizeConst = StatsPacketCount)]
+        public UInt64[] packetsSent;
+        [MarshalAsAttribute(UnmanagedType.ByValArray, SizeConst = StatsPacketCount)]
+        public UInt64[] bytesSent;
+        [MarshalAsAttribute(UnmanagedType.ByValArray, SizeConst = StatsPacketCount)]
+        public UInt64[] packetsReceived;
+        [MarshalAsAttribute(UnmanagedType.ByValArray, SizeConst = StatsPacketCount)]
+        public UInt64[] bytesReceived;
+        public UInt64 retransmissions;
+        public UInt64 duplicatesDropped;
+        public UInt64 signatureMismatches;
+        public UInt64 oversizedDrops;
+        public UInt64 malformedDrops;
+        public UInt32 reliableQueued;
+        public UInt32 sendQueueDepth;
+        public UInt32 eventQueueDepth;
+    };
+
+    // A segment of a message sent with SendMessage(endPointId, segments, reliability)
+    [StructLayout(LayoutKind.Sequential)]
+    protected struct Segment
+    {
+        public IntPtr data;
+        public UInt32 size;
+    };
+
+    // The maximum number of segments in a message
+    public const int MaxMessageSegments = 15;
+
     public UdcServer(Signature signature, uint bufferSize = 2048)
     {
         m_buffer = new byte[bufferSize + udcGetMinimumBufferSize()];
@@ -71,6 +139,23 @@ public class UdcServer : IDisposable
         }
     }
 
+    public UdcServer(Signature signature, uint slotCount, RingMode mode, uint slotSize = 2048)
+    {
+        m_buffer = new byte[(slotSize + udcGetMinimumBufferSize()) * slotCount];
+        m_server = udcCreateServerRing(signature, m_buffer, (UInt32)m_buffer.Length, slotCount, mode, null);
+
+        if (m_server == IntPtr.Zero)
+        {
+            throw new Exception("Failed to start server.");
+        }
+    }
+
+    // Release a received message, given the offset of its payload
+    public bool ReleaseMessage(ArraySegment<byte> message)
+    {
+        return udcReleaseMessage(m_server, (UInt32)message.Offset);
+    }
+
     public bool TryBindIPv4(UInt16 port)
     {
         return udcTryBindIPv4(m_server, port);
@@ -81,6 +166,16 @@ public class UdcServer : IDisposable
         return udcTryBindIPv6(m_server, port);
     }
 
+    public bool EnableSharedMemory()
+    {
+        return udcEnableSharedMemory(m_server);
+    }
+
+    public void GetSharedMemoryCounters(out UInt64 sent, out UInt64 received)
+    {
+        udcGetSharedMemoryCounters(m_server, out sent, out received);
+    }
+
     public static bool TryParseAddressIPv4(string nodeName, string serviceName, out AddressIPv4 address, out UInt16 port)
     {
         return udcTryParseAddressIPv4(nodeName, serviceName, out address, out port);
@@ -96,6 +191,16 @@ public class UdcServer : IDisposable
         return udcTryConnect(m_server, nodeName, serviceName, timeout, out endPointId);
     }
 
+    public bool TryConnectAsync(string nodeName, string serviceName, UInt32 timeout, out UInt32 endPointId)
+    {
+        return udcTryConnectAsync(m_server, nodeName, serviceName, timeout, out endPointId);
+    }
+
+    public void SetResolverCache(UInt32 positiveTtl, UInt32 negativeTtl)
+    {
+        udcSetResolverCache(m_server, positiveTtl, negativeTtl);
+    }
+
     public bool TryConnectIPv4(AddressIPv4 address, UInt16 port, UInt32 timeout, out UInt32 endPointId)
     {
         return udcTryConnectIPv4(m_server, address, port, timeout, out endPointId);
@@ -111,81 +216,238 @@ public class UdcServer : IDisposable
         return udcGetStatus(m_server, endPointId, out ping);
     }
 
+    public bool GetStatusMicroseconds(UInt32 endPointId, out UInt32 ping)
+    {
+        return udcGetStatusMicroseconds(m_server, endPointId, out ping);
+    }
+
     public void Disconnect(UInt32 endPointId)
     {
         udcDisconnect(m_server, endPointId);
     }
 
+    public bool SetEndPointContext(UInt32 endPointId, IntPtr context)
+    {
+        return udcSetEndPointContext(m_server, endPointId, context);
+    }
+
+    public bool GetReliableProgress(UInt32 endPointId, out UInt64 acknowledged, out UInt32 queued)
+    {
+        return udcGetReliableProgress(m_server, endPointId, out acknowledged, out queued);
+    }
+
+    public bool SetOrderedConnectionEvents(bool ordered)
+    {
+        return udcSetOrderedConnectionEvents(m_server, ordered);
+    }
+
+    public bool SetReliableStateLimits(UInt32 capacity, UInt32 idleTimeout)
+    {
+        return udcSetReliableStateLimits(m_server, capacity, idleTimeout);
+    }
+
+    public void GetReliableStateMetrics(out UInt32 size, out UInt64 evictions, out UInt64 expirations)
+    {
+        udcGetReliableStateMetrics(m_server, out size, out evictions, out expirations);
+    }
+
+    public bool GetStats(UInt32 endPointId, out Stats stats)
+    {
+        return udcGetStats(m_server, endPointId, out stats);
+    }
+
     public void SendMessage(UInt32 endPointId, byte[] data, MessageType reliability)
     {
         udcSendMessage(m_server, endPointId, data, (UInt32)data.Length, reliability);
     }
 
+    public bool SetMaintenanceThreads(UInt32 threadCount)
+    {
+        return udcSetMaintenanceThreads(m_server, threadCount);
+    }
+
+    public bool SetThreadAffinity(ThreadRole role, UInt16 processorGroup, UInt64 processorMask)
+    {
+        return udcSetThreadAffinity(m_server, role, processorGroup, processorMask);
+    }
+
+    public bool ReserveEndPoints(UInt32 count)
+    {
+        return udcReserveEndPoints(m_server, count);
+    }
+
+    // Period is in microseconds
+    public bool StartIoThread(UInt32 eventCapacity, UInt32 period)
+    {
+        return udcStartIoThread(m_server, eventCapacity, period);
+    }
+
+    public void StopIoThread()
+    {
+        udcStopIoThread(m_server);
+    }
+
+    public IntPtr GetEventHandle()
+    {
+        return udcGetEventHandle(m_server);
+    }
+
+    public UInt32 GetNextTimeout()
+    {
+        return udcGetNextTimeout(m_server);
+    }
+
+    public bool WaitEvents(UInt32 timeout)
+    {
+        return udcWaitEvents(m_server, timeout);
+    }
+
+    public bool SetIoBusyPoll(UInt32 spinPeriod)
+    {
+        return udcSetIoBusyPoll(m_server, spinPeriod);
+    }
+
+    public void GetIoWaitCounters(out UInt64 spins, out UInt64 sleeps, out UInt64 wakeups)
+    {
+        udcGetIoWaitCounters(m_server, out spins, out sleeps, out wakeups);
+    }
+
+    public bool CreateSendQueue(UInt32 capacity)
+    {
+        return udcCreateSendQueue(m_server, capacity);
+    }
+
+    // Can be called from any thread once the send queue has been created
+    public bool QueueMessage(UInt32 endPointId, byte[] data, MessageType reliability)
+    {
+        return udcQueueMessage(m_server, endPointId, data, (UInt32)data.Length, reliability);
+    }
+
+    public bool CreateGroup(out UInt32 groupId)
+    {
+        return udcCreateGroup(m_server, out groupId);
+    }
+
+    public bool DeleteGroup(UInt32 groupId)
+    {
+        return udcDeleteGroup(m_server, groupId);
+    }
+
+    public bool AddToGroup(UInt32 groupId, UInt32 endPointId)
+    {
+        return udcAddToGroup(m_server, groupId, endPointId);
+    }
+
+    public bool RemoveFromGroup(UInt32 groupId, UInt32 endPointId)
+    {
+        return udcRemoveFromGroup(m_server, groupId, endPointId);
+    }
+
+    public bool SendMessageGroup(UInt32 groupId, byte[] data, MessageType reliability)
+    {
+        return udcSendMessageGroup(m_server, groupId, data, (UInt32)data.Length, reliability);
+    }
+
+    public bool SendMessage(UInt32 endPointId, ArraySegment<byte>[] segments, MessageType reliability)
+    {
+        if (segments.Length > MaxMessageSegments)
+        {
+            return false;
+        }
+
+        // Pin the segments so they are sent without being copied into one array
+        var handles = new GCHandle[segments.Length];
+        var nativeSegments = new Segment[segments.Length];
+
+        try
+        {
+            for (int i = 0; i != segments.Length; ++i)
+            {
+                handles[i] = GCHandle.Alloc(segments[i].Array, GCHandleType.Pinned);
+                nativeSegments[i].data = handles[i].AddrOfPinnedObject() + segments[i].Offset;
+                nativeSegments[i].size = (UInt32)segments[i].Count;
+            }
+
+            return udcSendMessageV(m_server, endPointId, nativeSegments, (UInt32)nativeSegments.Length, reliability);
+        }
+        finally
+        {
+            foreach (var handle in handles)
+            {
+                if (handle.IsAllocated)
+                {
+                    handle.Free();
+                }
+            }
+        }
+    }
+
     public void ProcessEvents()
     {
         while (true)
         {
-            IntPtr evnt = udcProcessEvents(m_server);
+            // One call returns many events, which are read without calling back into the library
+            UInt32 count = udcProcessEventsBatch(m_server, m_events, (UInt32)m_events.Length);
 
-            if (evnt == IntPtr.Zero)
+            if (count == 0)
             {
                 return;
             }
 
-            switch(udcGetEventType(evnt))
+            for (UInt32 i = 0; i != count; ++i)
             {
-                case UdcEventType.UDC_EVENT_CONNECTION_SUCCESS:
-                {
-                    if (udcGetResultConnectionEvent(evnt, out UInt32 endPointId))
-                    {
-                        onConnectionSuccess?.Invoke(endPointId);
-                    }
-                    break;
-                }
-                case UdcEventType.UDC_EVENT_CONNECTION_TIMEOUT:
-                {
-                    if (udcGetResultConnectionEvent(evnt, out UInt32 endPointId))
-                    {
-                        onConnectionTimeout?.Invoke(endPointId);
-                    }
-                    break;
-                }
-                case UdcEventType.UDC_EVENT_CONNECTION_LOST:
-                {
-                    if (udcGetResultConnectionEvent(evnt, out UInt32 endPointId))
-                    {
-                        onConnectionLost?.Invoke(endPointId);
-                    }
-                    break;
-                }
-                case UdcEventType.UDC_EVENT_CONNECTION_REGAINED:
-                {
-                    if (udcGetResultConnectionEvent(evnt, out UInt32 endPointId))
-                    {
-                        onConnectionRegained?.Invoke(endPointId);
-                    }
-                    break;
-                }
-                case UdcEventType.UDC_EVENT_RECEIVE_MESSAGE_IPV4:
+                ref Event evnt = ref m_events[i];
+
+                switch(evnt.eventType)
                 {
-                    if (udcGetResultMessageIPv4Event(evnt, out AddressIPv4 address, out UInt16 port, out UInt32 index, out UInt32 size))
+                    case UdcEventType.UDC_EVENT_CONNECTION_SUCCESS:
+                        onConnectionSuccess?.Invoke(evnt.endPointId);
+                        break;
+                    case UdcEventType.UDC_EVENT_CONNECTION_TIMEOUT:
+                        onConnectionTimeout?.Invoke(evnt.endPointId);
+                        break;
+                    case UdcEventType.UDC_EVENT_CONNECTION_LOST:
+                        onConnectionLost?.Invoke(evnt.endPointId);
+                        break;
+                    case UdcEventType.UDC_EVENT_CONNECTION_REGAINED:
+                        onConnectionRegained?.Invoke(evnt.endPointId);
+                        break;
+                    case UdcEventType.UDC_EVENT_RECEIVE_MESSAGE_IPV4:
                     {
-                        onReceivedMessageIPv4(address, port, new ArraySegment<byte>(m_buffer, (int)index, (int)size));
+                        // The address is in memory order, since the bytes are copied with the host's byte order
+                        var address = new AddressIPv4 { bytes = BitConverter.GetBytes((UInt32)evnt.addressLow) };
+
+                        onReceivedMessageIPv4?.Invoke(address, evnt.port, new ArraySegment<byte>(m_buffer, (int)evnt.msgIndex, (int)evnt.msgSize));
+                        ReceivedEndPointMessage(ref evnt);
+                        break;
                     }
-                    break;
-                }
-                case UdcEventType.UDC_EVENT_RECEIVE_MESSAGE_IPV6:
-                {
-                    if (udcGetResultMessageIPv6Event(evnt, out AddressIPv6 address, out UInt16 port, out UInt32 index, out UInt32 size))
+                    case UdcEventType.UDC_EVENT_RECEIVE_MESSAGE_IPV6:
                     {
-                        onReceivedMessageIPv6(address, port, new ArraySegment<byte>(m_buffer, (int)index, (int)size));
+                        var address = new AddressIPv6 { segments = new UInt16[8] };
+
+                        for (int segment = 0; segment != 4; ++segment)
+                        {
+                            address.segments[segment] = (UInt16)(evnt.addressLow >> (16 * segment));
+                            address.segments[segment + 4] = (UInt16)(evnt.addressHigh >> (16 * segment));
+                        }
+
+                        onReceivedMessageIPv6?.Invoke(address, evnt.port, new ArraySegment<byte>(m_buffer, (int)evnt.msgIndex, (int)evnt.msgSize));
+                        ReceivedEndPointMessage(ref evnt);
+                        break;
                     }
-                    break;
                 }
             }
         }
     }
 
+    protected void ReceivedEndPointMessage(ref Event evnt)
+    {
+        if (evnt.endPointId != 0)
+        {
+            onReceivedEndPointMessage?.Invoke(evnt.endPointId, evnt.context, new ArraySegment<byte>(m_buffer, (int)evnt.msgIndex, (int)evnt.msgSize));
+        }
+    }
+
     public void Dispose()
     {
         TryDispose();
@@ -210,6 +472,8 @@ public class UdcServer : IDisposable
 
     protected byte[] m_buffer;
 
+    protected Event[] m_events = new Event[256];
+
     protected bool m_disposed = false;
 
     // -------------------------------------------
@@ -227,18 +491,58 @@ public class UdcServer : IDisposable
         UDC_EVENT_RECEIVE_MESSAGE_IPV6 = 5u,
     };
 
+    // An event, with the same layout as UdcEvent
+    // every field is blittable, so a batch is written straight into the pinned array without being copied
+    // the address is read as two halves in the host's byte order, which holds an IPv4 address
+    // in its first 4 bytes, or an IPv6 address
+    [StructLayout(LayoutKind.Sequential)]
+    protected struct Event
+    {
+        public UdcEventType eventType;
+        public UInt32 endPointId;
+        public UInt64 addressLow;
+        public UInt64 addressHigh;
+        public UInt16 port;
+        public UInt32 msgIndex;
+        public UInt32 msgSize;
+        public IntPtr context;
+    };
+
+    // Callbacks, with the same signatures as UdcConnectionCallback and UdcMessageIPv4/6Callback
+    // the wrapper dispatches batched events itself, these are for callers of the native API
+    [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+    protected delegate void ConnectionCallback(IntPtr context, UInt32 endPointId);
+
+    [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+    protected delegate void MessageIPv4Callback(IntPtr context, UInt32 endPointId, IntPtr endPointContext, ref AddressIPv4 address, UInt16 port, UInt32 msgIndex, UInt32 msgSize);
+
+    [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+    protected delegate void MessageIPv6Callback(IntPtr context, UInt32 endPointId, IntPtr endPointContext, ref AddressIPv6 address, UInt16 port, UInt32 msgIndex, UInt32 msgSize);
+
     [DllImport("libudpconnect", EntryPoint = "udcGetMinimumBufferSize", CallingConvention = CallingConvention.Cdecl)]
     protected static extern UInt32 udcGetMinimumBufferSize();
 
     [DllImport("libudpconnect", EntryPoint = "udcCreateServer", CallingConvention = CallingConvention.Cdecl)]
     protected static extern IntPtr udcCreateServer(Signature signature, byte[] buffer, UInt32 size, string logFileName);
 
+    [DllImport("libudpconnect", EntryPoint = "udcCreateServerRing", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern IntPtr udcCreateServerRing(Signature signature, byte[] buffer, UInt32 size, UInt32 slotCount, RingMode mode, string logFileName);
+
+    [DllImport("libudpconnect", EntryPoint = "udcReleaseMessage", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern bool udcReleaseMessage(IntPtr server, UInt32 msgIndex);
+
     [DllImport("libudpconnect", EntryPoint = "udcTryBindIPv4", CallingConvention = CallingConvention.Cdecl)]
     protected static extern bool udcTryBindIPv4(IntPtr server, UInt16 port);
 
     [DllImport("libudpconnect", EntryPoint = "udcTryBindIPv6", CallingConvention = CallingConvention.Cdecl)]
     protected static extern bool udcTryBindIPv6(IntPtr server, UInt16 port);
 
+    [DllImport("libudpconnect", EntryPoint = "udcEnableSharedMemory", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern bool udcEnableSharedMemory(IntPtr server);
+
+    [DllImport("libudpconnect", EntryPoint = "udcGetSharedMemoryCounters", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern void udcGetSharedMemoryCounters(IntPtr server, out UInt64 sent, out UInt64 received);
+
     [DllImport("libudpconnect", EntryPoint = "udcDeleteServer", CallingConvention = CallingConvention.Cdecl)]
     protected static extern void udcDeleteServer(IntPtr server);
 
@@ -251,6 +555,12 @@ public class UdcServer : IDisposable
     [DllImport("libudpconnect", EntryPoint = "udcTryConnect", CallingConvention = CallingConvention.Cdecl)]
     protected static extern bool udcTryConnect(IntPtr server, string nodeName, string serviceName, UInt32 timeout, out UInt32 endPointId);
 
+    [DllImport("libudpconnect", EntryPoint = "udcTryConnectAsync", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern bool udcTryConnectAsync(IntPtr server, string nodeName, string serviceName, UInt32 timeout, out UInt32 endPointId);
+
+    [DllImport("libudpconnect", EntryPoint = "udcSetResolverCache", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern void udcSetResolverCache(IntPtr server, UInt32 positiveTtl, UInt32 negativeTtl);
+
     [DllImport("libudpconnect", EntryPoint = "udcTryConnectIPv4", CallingConvention = CallingConvention.Cdecl)]
     protected static extern bool udcTryConnectIPv4(IntPtr server, AddressIPv4 address, UInt16 port, UInt32 timeout, out UInt32 endPointId);
 
@@ -260,15 +570,102 @@ public class UdcServer : IDisposable
     [DllImport("libudpconnect", EntryPoint = "udcGetStatus", CallingConvention = CallingConvention.Cdecl)]
     protected static extern bool udcGetStatus(IntPtr server, UInt32 endPointId, out UInt32 ping);
 
+    [DllImport("libudpconnect", EntryPoint = "udcGetStatusMicroseconds", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern bool udcGetStatusMicroseconds(IntPtr server, UInt32 endPointId, out UInt32 ping);
+
     [DllImport("libudpconnect", EntryPoint = "udcDisconnect", CallingConvention = CallingConvention.Cdecl)]
     protected static extern void udcDisconnect(IntPtr server, UInt32 endPointId);
 
+    [DllImport("libudpconnect", EntryPoint = "udcSetEndPointContext", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern bool udcSetEndPointContext(IntPtr server, UInt32 endPointId, IntPtr context);
+
+    [DllImport("libudpconnect", EntryPoint = "udcGetReliableProgress", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern bool udcGetReliableProgress(IntPtr server, UInt32 endPointId, out UInt64 acknowledged, out UInt32 queued);
+
+    [DllImport("libudpconnect", EntryPoint = "udcSetOrderedConnectionEvents", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern bool udcSetOrderedConnectionEvents(IntPtr server, bool ordered);
+
+    [DllImport("libudpconnect", EntryPoint = "udcSetReliableStateLimits", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern bool udcSetReliableStateLimits(IntPtr server, UInt32 capacity, UInt32 idleTimeout);
+
+    [DllImport("libudpconnect", EntryPoint = "udcGetReliableStateMetrics", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern void udcGetReliableStateMetrics(IntPtr server, out UInt32 size, out UInt64 evictions, out UInt64 expirations);
+
+    [DllImport("libudpconnect", EntryPoint = "udcGetStats", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern bool udcGetStats(IntPtr server, UInt32 endPointId, out Stats stats);
+
     [DllImport("libudpconnect", EntryPoint = "udcSendMessage", CallingConvention = CallingConvention.Cdecl)]
     protected static extern void udcSendMessage(IntPtr server, UInt32 endPointId, byte[] data, UInt32 size, MessageType reliability);
 
+    [DllImport("libudpconnect", EntryPoint = "udcSendMessageV", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern bool udcSendMessageV(IntPtr server, UInt32 endPointId, Segment[] segments, UInt32 segmentCount, MessageType reliability);
+
+    [DllImport("libudpconnect", EntryPoint = "udcSetMaintenanceThreads", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern bool udcSetMaintenanceThreads(IntPtr server, UInt32 threadCount);
+
+    [DllImport("libudpconnect", EntryPoint = "udcSetThreadAffinity", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern bool udcSetThreadAffinity(IntPtr server, ThreadRole role, UInt16 processorGroup, UInt64 processorMask);
+
+    [DllImport("libudpconnect", EntryPoint = "udcReserveEndPoints", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern bool udcReserveEndPoints(IntPtr server, UInt32 count);
+
+    [DllImport("libudpconnect", EntryPoint = "udcStartIoThread", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern bool udcStartIoThread(IntPtr server, UInt32 eventCapacity, UInt32 period);
+
+    [DllImport("libudpconnect", EntryPoint = "udcStopIoThread", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern void udcStopIoThread(IntPtr server);
+
+    [DllImport("libudpconnect", EntryPoint = "udcGetEventHandle", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern IntPtr udcGetEventHandle(IntPtr server);
+
+    [DllImport("libudpconnect", EntryPoint = "udcGetNextTimeout", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern UInt32 udcGetNextTimeout(IntPtr server);
+
+    [DllImport("libudpconnect", EntryPoint = "udcWaitEvents", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern bool udcWaitEvents(IntPtr server, UInt32 timeout);
+
+    [DllImport("libudpconnect", EntryPoint = "udcSetIoBusyPoll", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern bool udcSetIoBusyPoll(IntPtr server, UInt32 spinPeriod);
+
+    [DllImport("libudpconnect", EntryPoint = "udcGetIoWaitCounters", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern void udcGetIoWaitCounters(IntPtr server, out UInt64 spins, out UInt64 sleeps, out UInt64 wakeups);
+
+    [DllImport("libudpconnect", EntryPoint = "udcCreateSendQueue", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern bool udcCreateSendQueue(IntPtr server, UInt32 capacity);
+
+    [DllImport("libudpconnect", EntryPoint = "udcQueueMessage", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern bool udcQueueMessage(IntPtr server, UInt32 endPointId, byte[] data, UInt32 size, MessageType reliability);
+
+    [DllImport("libudpconnect", EntryPoint = "udcCreateGroup", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern bool udcCreateGroup(IntPtr server, out UInt32 groupId);
+
+    [DllImport("libudpconnect", EntryPoint = "udcDeleteGroup", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern bool udcDeleteGroup(IntPtr server, UInt32 groupId);
+
+    [DllImport("libudpconnect", EntryPoint = "udcAddToGroup", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern bool udcAddToGroup(IntPtr server, UInt32 groupId, UInt32 endPointId);
+
+    [DllImport("libudpconnect", EntryPoint = "udcRemoveFromGroup", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern bool udcRemoveFromGroup(IntPtr server, UInt32 groupId, UInt32 endPointId);
+
+    [DllImport("libudpconnect", EntryPoint = "udcSendMessageGroup", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern bool udcSendMessageGroup(IntPtr server, UInt32 groupId, byte[] data, UInt32 size, MessageType reliability);
+
+    [DllImport("libudpconnect", EntryPoint = "udcSetConnectionCallback", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern bool udcSetConnectionCallback(IntPtr server, UdcEventType eventType, ConnectionCallback callback, IntPtr context);
+
+    [DllImport("libudpconnect", EntryPoint = "udcSetMessageIPv4Callback", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern void udcSetMessageIPv4Callback(IntPtr server, MessageIPv4Callback callback, IntPtr context);
+
+    [DllImport("libudpconnect", EntryPoint = "udcSetMessageIPv6Callback", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern void udcSetMessageIPv6Callback(IntPtr server, MessageIPv6Callback callback, IntPtr context);
+
     [DllImport("libudpconnect", EntryPoint = "udcProcessEvents", CallingConvention = CallingConvention.Cdecl)]
     protected static extern IntPtr udcProcessEvents(IntPtr server);
 
+    [DllImport("libudpconnect", EntryPoint = "udcProcessEventsBatch", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern UInt32 udcProcessEventsBatch(IntPtr server, [Out] Event[] events, UInt32 capacity);
+
     [DllImport("libudpconnect", EntryPoint = "udcGetEventType", CallingConvention = CallingConvention.Cdecl)]
     protected static extern UdcEventType udcGetEventType(IntPtr evnt);
 
@@ -280,4 +677,7 @@ public class UdcServer : IDisposable
 
     [DllImport("libudpconnect", EntryPoint = "udcGetResultMessageIPv6Event", CallingConvention = CallingConvention.Cdecl)]
     protected static extern bool udcGetResultMessageIPv6Event(IntPtr evnt, out AddressIPv6 address, out UInt16 port, out UInt32 msgIndex, out UInt32 msgSize);
+
+    [DllImport("libudpconnect", EntryPoint = "udcGetResultMessageEndPoint", CallingConvention = CallingConvention.Cdecl)]
+    protected static extern bool udcGetResultMessageEndPoint(IntPtr evnt, out UInt32 endPointId, out IntPtr context);
 }